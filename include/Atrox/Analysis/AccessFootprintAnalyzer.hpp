@@ -0,0 +1,79 @@
+//
+//
+//
+
+#pragma once
+
+#include "Atrox/Config.hpp"
+
+#include "Atrox/Support/MemAccInst.hpp"
+
+#include "Atrox/Support/IR/ArgSpec.hpp"
+
+#include "llvm/ADT/ArrayRef.h"
+// using llvm::ArrayRef
+
+#include "llvm/ADT/SmallVector.h"
+// using llvm::SmallVector
+
+#include "llvm/ADT/Optional.h"
+// using llvm::Optional
+
+#include <utility>
+// using std::pair
+
+#include <cstdint>
+// using uint64_t
+
+namespace llvm {
+class Value;
+class Loop;
+class SCEV;
+class ScalarEvolution;
+class DataLayout;
+} // namespace llvm
+
+namespace atrox {
+
+class LoopBoundsAnalyzer;
+
+struct AccessFootprint {
+  const llvm::SCEV *Base;
+  const llvm::SCEV *MinOffset;
+  const llvm::SCEV *MaxOffset;
+  uint64_t ElementSize;
+  llvm::SmallVector<std::pair<const llvm::Loop *, const llvm::SCEV *>, 4>
+      Strides;
+};
+
+/// Computes the bytes of a pointer argument touched by a single invocation of
+/// the payload of a loop.
+///
+/// Add recurrences of loops nested in the payload loop are expanded to their
+/// extreme values using their backedge-taken counts, while the ones of the
+/// payload loop and its outer loops are kept symbolic.
+class AccessFootprintAnalyzer {
+  llvm::ScalarEvolution *SE;
+  const llvm::DataLayout *DL;
+  LoopBoundsAnalyzer *LBA;
+
+  const llvm::SCEV *getMaxBackedgeTakenCount(const llvm::Loop *L) const;
+  const llvm::SCEV *getExtreme(const llvm::SCEV *S, const llvm::Loop &L,
+                               bool Max) const;
+
+public:
+  AccessFootprintAnalyzer(llvm::ScalarEvolution &SE,
+                          const llvm::DataLayout &DL,
+                          LoopBoundsAnalyzer *LBA = nullptr)
+      : SE(&SE), DL(&DL), LBA(LBA) {}
+
+  llvm::Optional<AccessFootprint> analyze(llvm::Loop &L, llvm::Value *Ptr,
+                                          llvm::ArrayRef<MemAccInst> Accesses);
+
+  llvm::Optional<AccessFootprintSpec>
+  getSpec(llvm::Loop &L, llvm::Value *Ptr,
+          llvm::ArrayRef<MemAccInst> Accesses);
+};
+
+} // namespace atrox
+
@@ -0,0 +1,61 @@
+//
+//
+//
+
+#pragma once
+
+#include "Atrox/Config.hpp"
+
+#include "Atrox/Support/MemAccInst.hpp"
+
+#include "Atrox/Support/IR/AccessPattern.hpp"
+
+#include "llvm/ADT/ArrayRef.h"
+// using llvm::ArrayRef
+
+#include "llvm/ADT/Optional.h"
+// using llvm::Optional
+
+#include <cstdint>
+// using uint64_t
+
+namespace llvm {
+class Value;
+class Loop;
+class SCEV;
+class ScalarEvolution;
+class DataLayout;
+} // namespace llvm
+
+namespace atrox {
+
+/// Classifies how a pointer argument is accessed across the iterations of a
+/// payload loop and the loops nested in it.
+///
+/// The classification is based on the add recurrences of the access offsets
+/// and on whether the offsets depend on values loaded inside the loop. When
+/// the accesses to an argument fall into different classes, the least regular
+/// one is reported with a lowered confidence.
+class AccessPatternAnalyzer {
+  llvm::ScalarEvolution *SE;
+  const llvm::DataLayout *DL;
+
+  AccessPatternSpec classifyOffset(const llvm::SCEV *Offset, uint64_t Size,
+                                   const llvm::Loop &L) const;
+
+public:
+  AccessPatternAnalyzer(llvm::ScalarEvolution &SE, const llvm::DataLayout &DL)
+      : SE(&SE), DL(&DL) {}
+
+  llvm::Optional<AccessPatternSpec>
+  classify(llvm::Loop &L, llvm::Value *Ptr,
+           llvm::ArrayRef<MemAccInst> Accesses) const;
+
+  // classify a single access by its whole address, so that an address based
+  // on a value loaded in the loop is reported as indirect
+  AccessPatternSpec classifyAccess(const llvm::Loop &L,
+                                   MemAccInst Access) const;
+};
+
+} // namespace atrox
+
@@ -0,0 +1,59 @@
+//
+//
+//
+
+#pragma once
+
+#include "Atrox/Config.hpp"
+
+#include "Atrox/Support/MemAccInst.hpp"
+
+#include "Atrox/Support/IR/ArrayShapeSpec.hpp"
+
+#include "llvm/ADT/ArrayRef.h"
+// using llvm::ArrayRef
+
+#include "llvm/ADT/SmallVector.h"
+// using llvm::SmallVector
+
+#include <vector>
+// using std::vector
+
+namespace llvm {
+class Value;
+class Instruction;
+class SCEV;
+class ScalarEvolution;
+class LoopInfo;
+} // namespace llvm
+
+namespace atrox {
+
+struct DelinearizedAccess {
+  llvm::Value *Base = nullptr;
+  const llvm::SCEV *ElementSize = nullptr;
+  // outermost dimension first and in elements
+  llvm::SmallVector<const llvm::SCEV *, 4> Subscripts;
+  // the sizes of all dimensions except the outermost one
+  llvm::SmallVector<const llvm::SCEV *, 4> Sizes;
+
+  /// The offset in elements of the innermost row that the access falls in.
+  const llvm::SCEV *getRowOffset(llvm::ScalarEvolution &SE) const;
+};
+
+/// Recover the subscripts and the symbolic dimension sizes of a load or store
+/// to a linearized multi-dimensional array, such as a variable length array
+/// or a buffer indexed as a[i * n + j].
+///
+/// This succeeds only for accesses with at least two dimensions whose
+/// subscripts add up to the original offset.
+bool DelinearizeAccess(llvm::ScalarEvolution &SE, llvm::LoopInfo &LI,
+                       llvm::Instruction &Access, DelinearizedAccess &Result);
+
+/// Collect the shapes of the multi-dimensional arrays that the given accesses
+/// refer to, either from their array types or by delinearization.
+void GetArrayShapes(llvm::ScalarEvolution &SE, llvm::LoopInfo &LI,
+                    llvm::ArrayRef<MemAccInst> Accesses,
+                    std::vector<ArrayShapeSpec> &Shapes);
+
+} // namespace atrox
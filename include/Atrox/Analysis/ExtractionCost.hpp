@@ -0,0 +1,69 @@
+//
+//
+//
+
+#pragma once
+
+#include "Atrox/Config.hpp"
+
+#include "Atrox/Analysis/PayloadWeights.hpp"
+
+#include "llvm/ADT/ArrayRef.h"
+// using llvm::ArrayRef
+
+#include <cstdint>
+// using uint64_t
+
+namespace llvm {
+class BasicBlock;
+class Loop;
+class LoopInfo;
+class TargetTransformInfo;
+} // namespace llvm
+
+namespace atrox {
+
+class LoopBoundsAnalyzer;
+
+enum class ExtractionMode : unsigned { Clone, Replace };
+
+inline const char *toString(ExtractionMode EM) {
+  return EM == ExtractionMode::Replace ? "replace" : "clone";
+}
+
+/// Static estimate of the cost of calling an extracted payload in place of
+/// its blocks, in payload weight units.
+///
+/// The overhead of each invocation is the weight of a call plus the weight of
+/// an instruction for each live-in that is passed. The payload weight counts
+/// the blocks of loops nested in the payload as many times as the trip count
+/// bound of these loops, if known. Both are given by the same cost model.
+struct ExtractionCost {
+  uint64_t PayloadWeight = 0;
+  uint64_t CallOverhead = 0;
+  unsigned LiveIns = 0;
+  // trip count bound of the payload loop or 0 if it is not known
+  unsigned TripCount = 0;
+  bool IsExact = true;
+  PayloadCostModel Model = PayloadCostModel::Table;
+
+  /// A call is profitable if its overhead is within the given percentage of
+  /// the payload weight. Loops with fewer iterations than the given ones are
+  /// left to be unrolled in place.
+  bool isProfitable(unsigned MaxOverheadPercent, unsigned MinTripCount) const {
+    if (TripCount && TripCount < MinTripCount) {
+      return false;
+    }
+
+    return CallOverhead * 100 <= PayloadWeight * MaxOverheadPercent;
+  }
+};
+
+ExtractionCost
+CalculateExtractionCost(llvm::ArrayRef<llvm::BasicBlock *> Blocks,
+                        unsigned LiveIns, const llvm::Loop &L,
+                        const llvm::LoopInfo &LI,
+                        const LoopBoundsAnalyzer *LBA = nullptr,
+                        const llvm::TargetTransformInfo *TTI = nullptr);
+
+} // namespace atrox
@@ -0,0 +1,43 @@
+//
+//
+//
+
+#pragma once
+
+#include "Atrox/Config.hpp"
+
+#include "Atrox/Support/IR/FieldDensitySpec.hpp"
+
+#include "llvm/ADT/SmallVector.h"
+// using llvm::SmallVector
+
+#include <vector>
+// using std::vector
+
+namespace llvm {
+class Argument;
+class Function;
+class StructType;
+class GetElementPtrInst;
+} // namespace llvm
+
+namespace atrox {
+
+struct StructArgAccesses {
+  llvm::StructType *Ty = nullptr;
+  // the field addresses of the argument elements that all accesses go through
+  llvm::SmallVector<llvm::GetElementPtrInst *, 8> GEPs;
+  bool IsConvertible = true;
+};
+
+/// Collect the field addresses that are computed from a pointer argument to
+/// an array of structs. The result is not convertible if the argument or the
+/// field addresses are used in any other way than for loads and stores.
+bool GetStructArgAccesses(llvm::Argument &A, StructArgAccesses &Result);
+
+/// Report which fields of the elements of each struct pointer argument are
+/// accessed by a payload and how much of each element that covers.
+void AnalyzeFieldDensity(llvm::Function &Payload,
+                         std::vector<FieldDensitySpec> &Specs);
+
+} // namespace atrox
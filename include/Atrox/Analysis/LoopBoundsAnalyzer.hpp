@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include "Atrox/Support/IR/LoopBoundsSpec.hpp"
+
 #include "llvm/Analysis/LoopInfo.h"
 // using llvm::LoopInfo
 // using llvm::Loop
@@ -32,7 +34,10 @@ namespace atrox {
 struct LoopIterationSpaceInfo {
   llvm::PHINode *InductionVariable = nullptr;
   llvm::SCEV *Start = nullptr;
+  // value of the induction variable at the last iteration
   llvm::SCEV *End = nullptr;
+  llvm::SCEV *BackedgeTakenCount = nullptr;
+  // constant upper bound of the trip count or 0 if it cannot be proven
   unsigned TripCount = 0u;
 };
 
@@ -101,6 +106,8 @@ public:
 
   llvm::Optional<LoopIterationSpaceInfo> getInfo(llvm::Value *IndVar) const;
 
+  llvm::Optional<LoopBoundsSpec> getSpec(llvm::Loop *L) const;
+
   void print(llvm::raw_ostream &OS) const;
 };
 
@@ -0,0 +1,64 @@
+//
+//
+//
+
+#pragma once
+
+#include "Atrox/Config.hpp"
+
+#include "Atrox/Support/MemAccInst.hpp"
+
+#include "llvm/IR/Instructions.h"
+// using llvm::ICmpInst
+
+#include "llvm/ADT/ArrayRef.h"
+// using llvm::ArrayRef
+
+#include "llvm/ADT/Optional.h"
+// using llvm::Optional
+
+namespace llvm {
+class Value;
+class BasicBlock;
+class PHINode;
+class BinaryOperator;
+class Loop;
+class DependenceInfo;
+} // namespace llvm
+
+namespace atrox {
+
+// a loop that counts up by one from a start to an end
+struct CountedLoopShape {
+  llvm::PHINode *IndVar;
+  llvm::BinaryOperator *Inc;
+  llvm::BasicBlock *Preheader;
+  llvm::ICmpInst *Cmp;
+  unsigned EndIndex;
+  // the condition of staying in the loop with the counter on the left
+  llvm::ICmpInst::Predicate Pred;
+  bool IsSigned;
+  // whether the loop tests its bound at the latch and so enters its body at
+  // least once
+  bool IsRotated;
+
+  llvm::Value *getStart() const;
+  llvm::Value *getEnd() const { return Cmp->getOperand(EndIndex); }
+};
+
+/// Match a loop with a single induction variable that is incremented by one
+/// and compared against an end, whose start and end do not change in the
+/// given enclosing loop.
+llvm::Optional<CountedLoopShape> MatchCountedLoop(llvm::Loop &L,
+                                                  const llvm::Loop &Scope);
+
+/// Check that a loop only contains the given loop and instructions without
+/// side effects, so that they can be executed any number of times.
+bool IsPerfectLoopNest(const llvm::Loop &Outer, const llvm::Loop &Inner);
+
+/// Check that the dependences between the given accesses allow to execute
+/// the iterations of a nest with its two loops interchanged.
+bool IsInterchangeLegal(llvm::DependenceInfo *DI, llvm::Loop &Outer,
+                        llvm::Loop &Inner, llvm::ArrayRef<MemAccInst> Accesses);
+
+} // namespace atrox
@@ -12,6 +12,9 @@
 #include "llvm/ADT/ArrayRef.h"
 // using llvm::ArrayRef
 
+#include "llvm/Analysis/AliasAnalysis.h"
+// using llvm::ModRefInfo
+
 #include <cassert>
 // using assert
 
@@ -29,6 +32,10 @@ class MemoryAccessInfo {
   llvm::SmallVector<llvm::BasicBlock *, 16> Blocks;
   llvm::AAResults *AA;
 
+  // mod/ref of a memory object that is not defined in the region, against
+  // all the accesses of the region
+  llvm::ModRefInfo getRegionModRef(llvm::Value *V);
+
 public:
   explicit MemoryAccessInfo(llvm::ArrayRef<llvm::BasicBlock *> TargetBlocks,
                             llvm::AAResults *AA)
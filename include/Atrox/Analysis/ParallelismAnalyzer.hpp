@@ -0,0 +1,82 @@
+//
+//
+//
+
+#pragma once
+
+#include "Atrox/Config.hpp"
+
+#include "Atrox/Support/MemAccInst.hpp"
+
+#include "llvm/ADT/ArrayRef.h"
+// using llvm::ArrayRef
+
+#include "llvm/ADT/SmallVector.h"
+// using llvm::SmallVectorImpl
+
+namespace llvm {
+class Loop;
+class PHINode;
+class Instruction;
+class DependenceInfo;
+} // namespace llvm
+
+namespace iteratorrecognition {
+class IteratorInfo;
+} // namespace iteratorrecognition
+
+namespace atrox {
+
+enum class PayloadParallelism : unsigned { DOALL, Reduction, Serial };
+
+inline const char *toString(PayloadParallelism P) {
+  switch (P) {
+  case PayloadParallelism::DOALL:
+    return "doall";
+  case PayloadParallelism::Reduction:
+    return "reduction";
+  case PayloadParallelism::Serial:
+    return "serial";
+  }
+
+  return "";
+}
+
+/// Classifies whether separate iterations of a payload may run concurrently.
+///
+/// Memory accesses are checked with dependence analysis for dependences
+/// carried by the loop of the payload. Pairs of accesses that belong to the
+/// iterator are not considered, since the iterator is executed serially
+/// anyway. Values that are carried from one payload iteration to the next
+/// through the loop header are only allowed if they form reductions.
+class ParallelismAnalyzer {
+  llvm::DependenceInfo *DI;
+  const iteratorrecognition::IteratorInfo *Info;
+
+  bool isIterator(const llvm::Instruction *I) const;
+
+public:
+  explicit ParallelismAnalyzer(
+      llvm::DependenceInfo &DI,
+      const iteratorrecognition::IteratorInfo *Info = nullptr)
+      : DI(&DI), Info(Info) {}
+
+  bool hasCarriedMemoryDependence(llvm::Loop &L,
+                                  llvm::ArrayRef<MemAccInst> Accesses) const;
+
+  PayloadParallelism
+  classify(llvm::Loop &L, llvm::ArrayRef<MemAccInst> Accesses,
+           llvm::ArrayRef<llvm::PHINode *> CarriedValues) const;
+
+  /// Collect the accesses that belong to the payload.
+  void getPayloadAccesses(
+      llvm::ArrayRef<MemAccInst> Accesses,
+      llvm::SmallVectorImpl<llvm::Instruction *> &PayloadAccesses) const;
+};
+
+/// Mark the given accesses as free of dependences carried by the loop.
+void AnnotateParallelAccesses(llvm::Loop &L,
+                              llvm::ArrayRef<llvm::Instruction *> Accesses);
+
+} // namespace atrox
+
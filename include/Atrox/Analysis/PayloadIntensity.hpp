@@ -0,0 +1,77 @@
+//
+//
+//
+
+#pragma once
+
+#include "Atrox/Config.hpp"
+
+#include "Atrox/Support/MemAccInst.hpp"
+
+#include "llvm/ADT/ArrayRef.h"
+// using llvm::ArrayRef
+
+#include <cstdint>
+// using uint64_t
+
+namespace llvm {
+class BasicBlock;
+class Loop;
+class LoopInfo;
+class DataLayout;
+} // namespace llvm
+
+namespace atrox {
+
+class LoopBoundsAnalyzer;
+
+/// Static estimate of the work and memory traffic of a single payload
+/// invocation.
+///
+/// Vector operations are counted once each in the vector class and also per
+/// lane in their integer or floating-point class.
+struct PayloadIntensity {
+  uint64_t IntOps = 0;
+  uint64_t FPOps = 0;
+  uint64_t VectorOps = 0;
+  uint64_t BytesLoaded = 0;
+  uint64_t BytesStored = 0;
+  // false if the trip count of a loop nested in the payload was not known and
+  // its body was counted once
+  bool IsExact = true;
+
+  uint64_t getOps() const { return IntOps + FPOps; }
+  uint64_t getBytes() const { return BytesLoaded + BytesStored; }
+
+  double getArithmeticIntensity() const {
+    return getBytes() ? static_cast<double>(getOps()) / getBytes() : 0.0;
+  }
+};
+
+enum class RooflineBound : unsigned { Compute, Memory };
+
+inline const char *toString(RooflineBound RB) {
+  return RB == RooflineBound::Compute ? "compute" : "memory";
+}
+
+/// Number of times a block executes per payload invocation of a loop, given
+/// the trip count bounds of the loops nested in it. Loops with unknown bounds
+/// are counted once and the result is marked as inexact.
+uint64_t GetBlockMultiplier(const llvm::BasicBlock *BB, const llvm::Loop &L,
+                            const llvm::LoopInfo &LI,
+                            const LoopBoundsAnalyzer *LBA, bool &IsExact);
+
+PayloadIntensity
+CalculatePayloadIntensity(llvm::ArrayRef<llvm::BasicBlock *> Blocks,
+                          llvm::ArrayRef<MemAccInst> Accesses,
+                          const llvm::Loop &L, const llvm::LoopInfo &LI,
+                          const llvm::DataLayout &DL,
+                          const LoopBoundsAnalyzer *LBA = nullptr);
+
+/// Compare the arithmetic intensity against the machine balance, given the
+/// peak compute rate in Gop/s and the peak memory bandwidth in GB/s.
+RooflineBound ClassifyRoofline(const PayloadIntensity &PI, double PeakGOPS,
+                               double PeakBandwidth);
+
+} // namespace atrox
+
@@ -9,6 +9,9 @@
 #include "llvm/ADT/SmallVector.h"
 // using llvm::SmallVector
 
+#include "llvm/ADT/StringRef.h"
+// using llvm::StringRef
+
 #include <map>
 // using std::map
 
@@ -19,6 +22,9 @@
 namespace llvm {
 class BasicBlock;
 class Loop;
+class BlockFrequencyInfo;
+class LLVMContext;
+class TargetTransformInfo;
 } // namespace llvm
 
 namespace atrox {
@@ -37,8 +43,65 @@ enum class WeightedPayloadType : PayloadWeightTy {
   Maximum = std::numeric_limits<PayloadWeightTy>::max()
 };
 
+/// The weights of the table above, which can be replaced by the ones measured
+/// on the deployment host with atrox-calibrate.
+struct PayloadWeightTable {
+  PayloadWeightTy Cast =
+      static_cast<PayloadWeightTy>(WeightedPayloadType::Cast);
+  PayloadWeightTy DebugIntrinsic =
+      static_cast<PayloadWeightTy>(WeightedPayloadType::DebugIntrinsic);
+  PayloadWeightTy Instruction =
+      static_cast<PayloadWeightTy>(WeightedPayloadType::Instruction);
+  PayloadWeightTy Memory =
+      static_cast<PayloadWeightTy>(WeightedPayloadType::Memory);
+  PayloadWeightTy Call =
+      static_cast<PayloadWeightTy>(WeightedPayloadType::Call);
+  PayloadWeightTy CallArgument =
+      static_cast<PayloadWeightTy>(WeightedPayloadType::Instruction);
+};
+
+const PayloadWeightTable &GetPayloadWeightTable();
+
+void SetPayloadWeightTable(const PayloadWeightTable &Table);
+
+/// Read a weight table from a JSON file. Categories missing from the file keep
+/// their weight in the given table.
+bool ReadPayloadWeightTable(llvm::StringRef Filename,
+                            PayloadWeightTable &Table);
+
+bool WritePayloadWeightTable(llvm::StringRef Filename,
+                             const PayloadWeightTable &Table);
+
+enum class PayloadCostModel : unsigned { Table, TTI };
+
+inline const char *toString(PayloadCostModel PCM) {
+  return PCM == PayloadCostModel::TTI ? "tti" : "table";
+}
+
+/// Calculate the weight of each block, either from the weight table above or
+/// from the reciprocal throughput of its instructions on the target, when
+/// TTI is given. Instructions that the target has no cost for are weighted by
+/// the table, scaled so that a table instruction counts as a basic TTI cost.
 BlockPayloadMapTy
-CalculatePayloadWeight(const llvm::SmallVectorImpl<llvm::BasicBlock *> &Blocks);
+CalculatePayloadWeight(const llvm::SmallVectorImpl<llvm::BasicBlock *> &Blocks,
+                       const llvm::TargetTransformInfo *TTI = nullptr);
+
+/// Calculate the weight of calling a function with the given number of
+/// arguments, in the same units as the payload weight. When TTI is given,
+/// the table weights are scaled to TTI units like for the payload weight.
+PayloadWeightTy
+CalculateCallWeight(unsigned NumArgs, llvm::LLVMContext &Ctx,
+                    const llvm::TargetTransformInfo *TTI = nullptr);
+
+/// Scale the weights of blocks by how often they execute for each execution
+/// of a reference block, so that they reflect the dynamic payload weight.
+///
+/// Profile counts are used when the function has them, and the block
+/// frequencies estimated from branch probabilities, which take branch weight
+/// metadata into account, otherwise.
+void ScalePayloadWeights(BlockPayloadMapTy &Weights,
+                         const llvm::BlockFrequencyInfo &BFI,
+                         const llvm::BasicBlock &Reference);
 
 } // namespace atrox
 
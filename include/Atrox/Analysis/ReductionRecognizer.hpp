@@ -0,0 +1,36 @@
+//
+//
+//
+
+#pragma once
+
+#include "Atrox/Config.hpp"
+
+#include "Atrox/Support/IR/ReductionSpec.hpp"
+
+#include "llvm/ADT/Optional.h"
+// using llvm::Optional
+
+namespace llvm {
+class Loop;
+class PHINode;
+class Constant;
+} // namespace llvm
+
+namespace atrox {
+
+struct ReductionInfo {
+  llvm::PHINode *Phi;
+  ReductionOp Op;
+  llvm::Constant *Identity;
+};
+
+/// Recognize a loop header PHI node as an associative reduction.
+///
+/// Floating-point reductions are only accepted when their operations permit
+/// reassociation.
+llvm::Optional<ReductionInfo> RecognizeReduction(llvm::PHINode &Phi,
+                                                 llvm::Loop &L);
+
+} // namespace atrox
+
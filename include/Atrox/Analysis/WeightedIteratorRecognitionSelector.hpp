@@ -17,6 +17,8 @@ class BasicBlock;
 class LoopInfo;
 class Loop;
 class MemoryDependenceResults;
+class BlockFrequencyInfo;
+class TargetTransformInfo;
 } // namespace llvm
 
 namespace iteratorrecognition {
@@ -28,13 +30,19 @@ namespace atrox {
 class WeightedIteratorRecognitionSelector {
   llvm::LoopInfo *CurLI;
   iteratorrecognition::IteratorRecognitionInfo &Info;
+  llvm::BlockFrequencyInfo *BFI;
+  const llvm::TargetTransformInfo *TTI;
 
   void calculate(llvm::Loop &L,
                  llvm::SmallVectorImpl<llvm::BasicBlock *> &Blocks);
 
 public:
+  // the payload weights are scaled by block frequency when BFI is given and
+  // come from the target cost model when TTI is given
   explicit WeightedIteratorRecognitionSelector(
-      iteratorrecognition::IteratorRecognitionInfo &ITRInfo);
+      iteratorrecognition::IteratorRecognitionInfo &ITRInfo,
+      llvm::BlockFrequencyInfo *BFI = nullptr,
+      const llvm::TargetTransformInfo *TTI = nullptr);
 
   void getBlocks(llvm::Loop &L,
                  llvm::SmallVectorImpl<llvm::BasicBlock *> &Blocks) {
@@ -8,22 +8,84 @@
 
 #include "Atrox/Support/IR/ArgSpec.hpp"
 
+#include "Atrox/Support/IR/AggregateLayout.hpp"
+
+#include "Atrox/Support/IR/ReductionSpec.hpp"
+
+#include "Atrox/Support/IR/LoopBoundsSpec.hpp"
+
+#include "Atrox/Support/IR/PrefetchSpec.hpp"
+
+#include "Atrox/Support/IR/PipelineSpec.hpp"
+
+#include "Atrox/Support/IR/FissionSpec.hpp"
+
+#include "Atrox/Support/IR/InterleavingSpec.hpp"
+
+#include "Atrox/Support/IR/SpecializationSpec.hpp"
+
+#include "Atrox/Support/IR/ArrayShapeSpec.hpp"
+
+#include "Atrox/Support/IR/TilingSpec.hpp"
+
+#include "Atrox/Support/IR/InterchangeSpec.hpp"
+
+#include "Atrox/Support/IR/FieldDensitySpec.hpp"
+
+#include "Atrox/Analysis/ParallelismAnalyzer.hpp"
+
+#include "Atrox/Analysis/PayloadIntensity.hpp"
+
+#include "Atrox/Analysis/ExtractionCost.hpp"
+
 #include "llvm/Analysis/LoopInfo.h"
 // using llvm::Loop
 
+#include "llvm/ADT/Optional.h"
+// using llvm::Optional
+
 #include <vector>
 // using std::vector
 
+#include <string>
+// using std::string
+
 namespace llvm {
 class Function;
 } // namespace llvm
 
 namespace atrox {
 
+// a rewrite of the original loop with the payload that was not applied, in
+// which case the payload is left as a plain clone
+struct SkippedRewriteSpec {
+  std::string Kind;
+  std::string Reason;
+};
+
 struct FunctionArgSpec {
   llvm::Function *Func;
   llvm::Loop *CurLoop;
   std::vector<ArgSpec> Args;
+  llvm::Optional<AggregateLayoutSpec> AggregateLayout;
+  llvm::Optional<PayloadParallelism> Parallelism;
+  std::vector<ReductionSpec> Reductions;
+  llvm::Optional<PayloadIntensity> Intensity;
+  llvm::Optional<RooflineBound> Bound;
+  std::vector<LoopBoundsSpec> LoopBounds;
+  std::vector<PrefetchSpec> Prefetches;
+  llvm::Optional<PipelineSpec> Pipeline;
+  llvm::Optional<FissionSpec> Fission;
+  llvm::Optional<InterleavingSpec> Interleaving;
+  llvm::Optional<SpecializationSpec> Specialization;
+  llvm::Optional<ExtractionCost> Extraction;
+  ExtractionMode Mode = ExtractionMode::Clone;
+  std::vector<ArrayShapeSpec> ArrayShapes;
+  std::vector<TilingSpec> Tilings;
+  std::vector<InterchangeSpec> Interchanges;
+  std::vector<FieldDensitySpec> FieldDensities;
+  llvm::Optional<SoALayoutSpec> SoALayout;
+  llvm::Optional<SkippedRewriteSpec> SkippedRewrite;
 };
 
 } // namespace atrox
@@ -30,8 +30,42 @@ void WriteJSONToFile(const llvm::json::Value &V,
 namespace llvm {
 namespace json {
 
+Value toJSON(const atrox::AccessFootprintSpec &Footprint);
+
 Value toJSON(ArrayRef<atrox::ArgSpec> ArgSpecs);
 
+Value toJSON(const atrox::AggregateLayoutSpec &Layout);
+
+Value toJSON(ArrayRef<atrox::ReductionSpec> Reductions);
+
+Value toJSON(const atrox::PayloadIntensity &Intensity);
+
+Value toJSON(ArrayRef<atrox::LoopBoundsSpec> LoopBounds);
+
+Value toJSON(ArrayRef<atrox::PrefetchSpec> Prefetches);
+
+Value toJSON(const atrox::PipelineSpec &Pipeline);
+
+Value toJSON(const atrox::FissionSpec &Fission);
+
+Value toJSON(const atrox::InterleavingSpec &Interleaving);
+
+Value toJSON(const atrox::SpecializationSpec &Specialization);
+
+Value toJSON(const atrox::ExtractionCost &Extraction);
+
+Value toJSON(ArrayRef<atrox::ArrayShapeSpec> Shapes);
+
+Value toJSON(ArrayRef<atrox::TilingSpec> Tilings);
+
+Value toJSON(ArrayRef<atrox::InterchangeSpec> Interchanges);
+
+Value toJSON(ArrayRef<atrox::FieldDensitySpec> Densities);
+
+Value toJSON(const atrox::SoALayoutSpec &Layout);
+
+Value toJSON(const atrox::SkippedRewriteSpec &Skipped);
+
 Value toJSON(const atrox::FunctionArgSpec &FAS);
 
 } // namespace json
@@ -0,0 +1,19 @@
+//
+//
+//
+
+#pragma once
+
+#include "Atrox/Config.hpp"
+
+#include <cstdint>
+// using uint64_t
+
+namespace atrox {
+
+/// Return the size in bytes of the data or unified cache at the given level
+/// of the first processor, as reported under /sys/devices/system/cpu, or 0 if
+/// it is not known.
+uint64_t GetDataCacheSize(unsigned Level);
+
+} // namespace atrox
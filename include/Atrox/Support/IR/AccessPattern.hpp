@@ -0,0 +1,61 @@
+//
+//
+//
+
+#pragma once
+
+#include "Atrox/Config.hpp"
+
+namespace atrox {
+
+// ordered from the most to the least regular
+enum class AccessPattern : unsigned {
+  Invariant,
+  UnitStride,
+  Strided,
+  MultiDimAffine,
+  Indirect,
+  Irregular,
+};
+
+enum class AccessConfidence : unsigned { Low, Medium, High };
+
+inline const char *toString(AccessPattern AP) {
+  switch (AP) {
+  case AccessPattern::Invariant:
+    return "invariant";
+  case AccessPattern::UnitStride:
+    return "unit stride";
+  case AccessPattern::Strided:
+    return "strided";
+  case AccessPattern::MultiDimAffine:
+    return "multi-dimensional affine";
+  case AccessPattern::Indirect:
+    return "indirect";
+  case AccessPattern::Irregular:
+    return "irregular";
+  }
+
+  return "";
+}
+
+inline const char *toString(AccessConfidence AC) {
+  switch (AC) {
+  case AccessConfidence::Low:
+    return "low";
+  case AccessConfidence::Medium:
+    return "medium";
+  case AccessConfidence::High:
+    return "high";
+  }
+
+  return "";
+}
+
+struct AccessPatternSpec {
+  AccessPattern Pattern;
+  AccessConfidence Confidence;
+};
+
+} // namespace atrox
+
@@ -0,0 +1,79 @@
+//
+//
+//
+
+#pragma once
+
+#include "Atrox/Config.hpp"
+
+#include "llvm/ADT/ArrayRef.h"
+// using llvm::ArrayRef
+
+#include "llvm/ADT/SmallVector.h"
+// using llvm::SmallVectorImpl
+
+#include <vector>
+// using std::vector
+
+#include <string>
+// using std::string
+
+#include <cstdint>
+// using uint64_t
+
+namespace llvm {
+class Type;
+class StructType;
+class DataLayout;
+class LLVMContext;
+} // namespace llvm
+
+namespace atrox {
+
+enum class AggregateLayoutKind : unsigned { Discovery, CacheAware };
+
+struct AggregateField {
+  llvm::Type *Ty;
+  std::string Name;
+  bool Writable;
+};
+
+struct AggregateFieldSpec {
+  std::string Name;
+  unsigned Block;
+  unsigned Index;
+  uint64_t Offset;
+  uint64_t Size;
+  bool Writable;
+};
+
+struct AggregateLayoutSpec {
+  AggregateLayoutKind Kind = AggregateLayoutKind::Discovery;
+  bool PrivateOutputs = false;
+  unsigned Alignment = 0;
+  std::vector<uint64_t> BlockSizes;
+  // in the same order as the fields the layout was computed for
+  std::vector<AggregateFieldSpec> Fields;
+};
+
+/// Compute the struct types that hold the aggregated arguments.
+///
+/// In discovery mode all fields are placed in a single block in the order
+/// given. In cache-aware mode read-only and writable fields are grouped
+/// separately and sorted by decreasing size and alignment, while the writable
+/// group starts and ends on a cache line boundary. If private outputs are
+/// requested, the writable group is placed in a block of its own, so that each
+/// thread can be handed a separate copy of it.
+void ComputeAggregateLayout(llvm::ArrayRef<AggregateField> Fields,
+                            AggregateLayoutKind Kind, bool PrivateOutputs,
+                            unsigned CacheLineSize, const llvm::DataLayout &DL,
+                            llvm::LLVMContext &Ctx,
+                            llvm::SmallVectorImpl<llvm::StructType *> &Blocks,
+                            AggregateLayoutSpec &Spec);
+
+inline const char *toString(AggregateLayoutKind Kind) {
+  return Kind == AggregateLayoutKind::CacheAware ? "cache-aware" : "discovery";
+}
+
+} // namespace atrox
+
@@ -8,15 +8,71 @@
 
 #include "Atrox/Support/IR/ArgDirection.hpp"
 
+#include "Atrox/Support/IR/AccessPattern.hpp"
+
+#include "llvm/ADT/Optional.h"
+// using llvm::Optional
+
 #include <string>
 // using std::string
 
+#include <vector>
+// using std::vector
+
+#include <cstdint>
+// using uint8_t
+// using uint64_t
+
 namespace atrox {
 
+enum class ArgPassing : uint8_t {
+  Value,
+  Pointer,
+  Return,
+  ValueAndReturn,
+  Aggregate,
+};
+
+inline const char *toString(ArgPassing AP) {
+  switch (AP) {
+  case ArgPassing::Value:
+    return "value";
+  case ArgPassing::Pointer:
+    return "pointer";
+  case ArgPassing::Return:
+    return "return";
+  case ArgPassing::ValueAndReturn:
+    return "value and return";
+  case ArgPassing::Aggregate:
+    return "aggregate";
+  }
+
+  return "";
+}
+
+struct AccessStrideSpec {
+  std::string Loop;
+  std::string Stride;
+};
+
+// offsets are in bytes from the base and describe the range touched by a
+// single payload invocation
+struct AccessFootprintSpec {
+  std::string Base;
+  std::string MinOffset;
+  std::string MaxOffset;
+  uint64_t ElementSize;
+  std::vector<AccessStrideSpec> Strides;
+};
+
 struct ArgSpec {
   std::string Name;
   ArgDirection Direction;
   bool IteratorDependent;
+  ArgPassing Passing = ArgPassing::Value;
+  int ReturnIndex = -1;
+  llvm::Optional<AccessFootprintSpec> Footprint;
+  llvm::Optional<AccessPatternSpec> Pattern;
 };
 
 } // namespace atrox
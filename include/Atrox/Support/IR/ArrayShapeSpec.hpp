@@ -0,0 +1,31 @@
+//
+//
+//
+
+#pragma once
+
+#include "Atrox/Config.hpp"
+
+#include <vector>
+// using std::vector
+
+#include <string>
+// using std::string
+
+#include <cstdint>
+// using uint64_t
+
+namespace atrox {
+
+struct ArrayShapeSpec {
+  std::string Array;
+  // whether the sizes are given by the array type instead of being recovered
+  // from the linearized accesses
+  bool IsStatic;
+  // outermost dimension first and empty where the size is not known
+  std::vector<std::string> Sizes;
+  uint64_t ElementSize;
+  unsigned Accesses;
+};
+
+} // namespace atrox
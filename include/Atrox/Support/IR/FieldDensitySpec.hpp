@@ -0,0 +1,53 @@
+//
+//
+//
+
+#pragma once
+
+#include "Atrox/Config.hpp"
+
+#include <vector>
+// using std::vector
+
+#include <string>
+// using std::string
+
+#include <cstdint>
+// using uint64_t
+
+namespace atrox {
+
+struct FieldAccessSpec {
+  unsigned Index;
+  uint64_t Offset;
+  uint64_t Size;
+  unsigned Reads;
+  unsigned Writes;
+};
+
+struct FieldDensitySpec {
+  std::string Arg;
+  std::string Type;
+  uint64_t Size;
+  unsigned NumFields;
+  // the fields that are accessed, in field order
+  std::vector<FieldAccessSpec> Fields;
+  uint64_t UsedBytes;
+  // whether all uses of the argument are accesses to fields of its elements
+  bool IsConvertible;
+};
+
+struct SoAParamSpec {
+  std::string Name;
+  std::string Arg;
+  // the field of the argument elements that the parameter points to, or -1
+  // if it is the argument itself
+  int Field;
+};
+
+struct SoALayoutSpec {
+  std::string Function;
+  std::vector<SoAParamSpec> Params;
+};
+
+} // namespace atrox
@@ -0,0 +1,33 @@
+//
+//
+//
+
+#pragma once
+
+#include "Atrox/Config.hpp"
+
+#include <vector>
+// using std::vector
+
+#include <string>
+// using std::string
+
+#include <cstdint>
+// using uint64_t
+
+namespace atrox {
+
+struct FissionSpec {
+  // initial capacity of the buffer in records
+  uint64_t Capacity;
+  // whether the capacity is the proven trip count bound of the loop, so that
+  // the buffer never grows
+  bool Bounded = false;
+  uint64_t RecordSize;
+  // the inputs gathered for each iteration
+  std::vector<std::string> RecordFields;
+  // the inputs that are invariant in the loop
+  std::vector<std::string> InvariantFields;
+};
+
+} // namespace atrox
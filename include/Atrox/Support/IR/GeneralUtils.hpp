@@ -12,10 +12,14 @@
 #include "llvm/ADT/SmallVector.h"
 // using llvm::SmallVector
 
+#include "llvm/ADT/ArrayRef.h"
+// using llvm::ArrayRef
+
 namespace llvm {
 class Value;
 class IntrinsicInst;
 class CallInst;
+class Function;
 class Module;
 } // namespace llvm
 
@@ -23,6 +27,12 @@ namespace atrox {
 
 inline bool IsIgnoredIntrinsic(const llvm::Value *V);
 
+/// Switch a payload function to internal linkage and the fast calling
+/// convention, updating the given calls accordingly. This happens only if the
+/// given calls are the only uses of the function.
+bool InternalizePayload(llvm::Function &F,
+                        llvm::ArrayRef<llvm::CallInst *> Calls);
+
 //
 
 class InstructionEraser : public llvm::InstVisitor<InstructionEraser> {
@@ -0,0 +1,47 @@
+//
+//
+//
+
+#pragma once
+
+#include "Atrox/Config.hpp"
+
+#include <string>
+// using std::string
+
+namespace atrox {
+
+enum class InterchangeStatus : unsigned {
+  Applied,
+  NonAffine,
+  UnsupportedShape,
+  Dependence
+};
+
+inline const char *toString(InterchangeStatus IS) {
+  switch (IS) {
+  case InterchangeStatus::Applied:
+    return "applied";
+  case InterchangeStatus::NonAffine:
+    return "non-affine access";
+  case InterchangeStatus::UnsupportedShape:
+    return "unsupported shape";
+  case InterchangeStatus::Dependence:
+    return "dependence";
+  }
+
+  return "";
+}
+
+struct InterchangeSpec {
+  // the headers of the nest loops in the original function
+  std::string Loop;
+  std::string OuterLoop;
+  InterchangeStatus Status;
+  // the accesses with a smaller or larger stride in the inner loop after the
+  // interchange
+  unsigned ImprovedAccesses;
+  unsigned WorsenedAccesses;
+};
+
+} // namespace atrox
@@ -0,0 +1,23 @@
+//
+//
+//
+
+#pragma once
+
+#include "Atrox/Config.hpp"
+
+#include <string>
+// using std::string
+
+namespace atrox {
+
+struct InterleavingSpec {
+  // the payload coroutine
+  std::string Coroutine;
+  // the number of payload invocations in flight
+  unsigned GroupSize;
+  // the number of loads that are prefetched before suspending
+  unsigned SuspendPoints;
+};
+
+} // namespace atrox
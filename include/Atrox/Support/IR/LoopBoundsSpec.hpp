@@ -0,0 +1,26 @@
+//
+//
+//
+
+#pragma once
+
+#include "Atrox/Config.hpp"
+
+#include <string>
+// using std::string
+
+#include <cstdint>
+// using uint64_t
+
+namespace atrox {
+
+struct LoopBoundsSpec {
+  std::string Header;
+  std::string InductionVariable;
+  std::string Start;
+  std::string End;
+  std::string BackedgeTakenCount;
+  uint64_t MaxTripCount;
+};
+
+} // namespace atrox
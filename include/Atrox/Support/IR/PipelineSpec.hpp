@@ -0,0 +1,30 @@
+//
+//
+//
+
+#pragma once
+
+#include "Atrox/Config.hpp"
+
+#include <vector>
+// using std::vector
+
+#include <string>
+// using std::string
+
+#include <cstdint>
+// using uint64_t
+
+namespace atrox {
+
+struct PipelineSpec {
+  unsigned Workers;
+  unsigned Capacity;
+  uint64_t RecordSize;
+  // the inputs pushed for each iteration
+  std::vector<std::string> RecordFields;
+  // the inputs that are invariant in the loop
+  std::vector<std::string> ContextFields;
+};
+
+} // namespace atrox
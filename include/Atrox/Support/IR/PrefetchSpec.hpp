@@ -0,0 +1,37 @@
+//
+//
+//
+
+#pragma once
+
+#include "Atrox/Config.hpp"
+
+#include <string>
+// using std::string
+
+#include <cstdint>
+// using int64_t
+
+namespace atrox {
+
+enum class PrefetchKind : unsigned { Strided, Indirect };
+
+inline const char *toString(PrefetchKind Kind) {
+  return Kind == PrefetchKind::Indirect ? "indirect" : "strided";
+}
+
+struct PrefetchSpec {
+  PrefetchKind Kind;
+  std::string Base;
+  // the index array of indirect prefetches
+  std::string Index;
+  std::string Loop;
+  // in bytes per iteration of the loop for the prefetched array or the index
+  // array of indirect prefetches
+  int64_t Stride;
+  // in iterations of the loop
+  unsigned Distance;
+  bool Write;
+};
+
+} // namespace atrox
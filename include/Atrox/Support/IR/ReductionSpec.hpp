@@ -0,0 +1,71 @@
+//
+//
+//
+
+#pragma once
+
+#include "Atrox/Config.hpp"
+
+#include <string>
+// using std::string
+
+namespace atrox {
+
+enum class ReductionOp : unsigned {
+  Add,
+  Mul,
+  And,
+  Or,
+  Xor,
+  SMin,
+  SMax,
+  UMin,
+  UMax,
+  FAdd,
+  FMul,
+  FMin,
+  FMax,
+};
+
+inline const char *toString(ReductionOp Op) {
+  switch (Op) {
+  case ReductionOp::Add:
+    return "add";
+  case ReductionOp::Mul:
+    return "mul";
+  case ReductionOp::And:
+    return "and";
+  case ReductionOp::Or:
+    return "or";
+  case ReductionOp::Xor:
+    return "xor";
+  case ReductionOp::SMin:
+    return "smin";
+  case ReductionOp::SMax:
+    return "smax";
+  case ReductionOp::UMin:
+    return "umin";
+  case ReductionOp::UMax:
+    return "umax";
+  case ReductionOp::FAdd:
+    return "fadd";
+  case ReductionOp::FMul:
+    return "fmul";
+  case ReductionOp::FMin:
+    return "fmin";
+  case ReductionOp::FMax:
+    return "fmax";
+  }
+
+  return "";
+}
+
+struct ReductionSpec {
+  std::string Name;
+  ReductionOp Op;
+  std::string Identity;
+  bool Private;
+};
+
+} // namespace atrox
+
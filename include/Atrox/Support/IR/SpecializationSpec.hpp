@@ -0,0 +1,46 @@
+//
+//
+//
+
+#pragma once
+
+#include "Atrox/Config.hpp"
+
+#include <vector>
+// using std::vector
+
+#include <string>
+// using std::string
+
+#include <cstdint>
+// using int64_t
+
+namespace atrox {
+
+enum class SpecializationSource : unsigned { Constant, MaxTripCount };
+
+inline const char *toString(SpecializationSource SS) {
+  switch (SS) {
+  case SpecializationSource::Constant:
+    return "constant";
+  case SpecializationSource::MaxTripCount:
+    return "max trip count";
+  }
+
+  return "";
+}
+
+struct SpecializedArgSpec {
+  std::string Name;
+  int64_t Value;
+  SpecializationSource Source;
+};
+
+struct SpecializationSpec {
+  // the variant that is called when all arguments match their values
+  std::string Specialized;
+  std::string Generic;
+  std::vector<SpecializedArgSpec> Args;
+};
+
+} // namespace atrox
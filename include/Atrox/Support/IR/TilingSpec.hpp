@@ -0,0 +1,28 @@
+//
+//
+//
+
+#pragma once
+
+#include "Atrox/Config.hpp"
+
+#include <string>
+// using std::string
+
+#include <cstdint>
+// using uint64_t
+
+namespace atrox {
+
+struct TilingSpec {
+  // the header of the strip-mined inner loop in the original function
+  std::string Loop;
+  // the header of the loop that the tile loop is placed around
+  std::string OuterLoop;
+  unsigned TileSize;
+  // bytes brought in per inner loop iteration
+  uint64_t Footprint;
+  uint64_t CacheSize;
+};
+
+} // namespace atrox
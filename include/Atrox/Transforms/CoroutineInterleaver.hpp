@@ -0,0 +1,50 @@
+//
+//
+//
+
+#pragma once
+
+#include "Atrox/Config.hpp"
+
+#include "Atrox/Support/IR/InterleavingSpec.hpp"
+
+#include "llvm/ADT/ArrayRef.h"
+// using llvm::ArrayRef
+
+namespace llvm {
+class Value;
+class BasicBlock;
+class Function;
+class LoadInst;
+class Loop;
+} // namespace llvm
+
+namespace atrox {
+
+/// Create a coroutine from a payload that prefetches the address of each of
+/// the given loads of the payload and suspends before the load.
+///
+/// The coroutine takes the parameters of the payload, runs until its first
+/// suspend point and returns its handle. It suspends finally when the payload
+/// is done, so it has to be destroyed by the caller. The coroutine intrinsics
+/// are lowered by the LLVM coroutine passes, which have to run afterwards and
+/// are scheduled along with the pass when it is loaded in clang.
+llvm::Function *CreatePayloadCoroutine(llvm::Function &Payload,
+                                       llvm::ArrayRef<llvm::LoadInst *> Loads);
+
+/// Replace the payload blocks of a loop with starting a coroutine of the
+/// extracted payload, so that a group of payload invocations is in flight.
+/// The payload region must be separable from the loop iterator and the
+/// payload invocations must be independent.
+///
+/// Each iteration resumes the invocations in flight round-robin until one of
+/// them finishes and starts the new one in its place. The invocations still
+/// in flight are finished at the loop exit. The inputs must be in the order
+/// of the payload parameters.
+bool CreateInterleavedExecution(
+    llvm::Loop &L, llvm::ArrayRef<llvm::BasicBlock *> PayloadBlocks,
+    llvm::Function &Payload, llvm::ArrayRef<llvm::Value *> Inputs,
+    llvm::ArrayRef<llvm::LoadInst *> Loads, unsigned GroupSize,
+    InterleavingSpec *Spec = nullptr);
+
+} // namespace atrox
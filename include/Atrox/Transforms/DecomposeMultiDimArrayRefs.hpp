@@ -10,8 +10,15 @@
 
 #include "llvm/ADT/SmallVector.h"
 
+#include "llvm/ADT/ArrayRef.h"
+
 namespace llvm {
 class GetElementPtrInst;
+class DominatorTree;
+class LoopInfo;
+class AAResults;
+class Instruction;
+class ScalarEvolution;
 } // namespace llvm
 
 namespace atrox {
@@ -23,9 +30,41 @@ llvm::Type *GetDecomposedMultiDimArrayType(
 void GetDecomposedArraySizes(const llvm::PointerType *PtrTy,
                              llvm::SmallVectorImpl<uint64_t> &Sizes);
 
-bool FlattenMultiDimArrayIndices(llvm::GetElementPtrInst *GEP);
+/// Replace multi-dimensional array accesses with accesses through a pointer to
+/// their basic type.
+///
+/// The offset of the row that an access falls in is computed once for all
+/// accesses that share it, at the earliest point where its indices are
+/// available, while keeping the inbounds and no-wrap guarantees of the
+/// original accesses. Accesses in innermost loops that are indexed by an
+/// induction variable within a loop invariant row use a pointer that is bumped
+/// along with the induction variable instead.
+bool FlattenMultiDimArrayIndices(llvm::ArrayRef<llvm::GetElementPtrInst *> GEPs,
+                                 llvm::DominatorTree &DT, llvm::LoopInfo &LI);
+
+/// Replace the pointers of loads and stores to linearized multi-dimensional
+/// arrays, such as variable length arrays, with a row pointer and an index
+/// within the row, based on the subscripts and the dimension sizes recovered
+/// by delinearization.
+///
+/// The row pointers are shared and hoisted like those of statically sized
+/// arrays, while innermost loop accesses use a bumped pointer.
+bool FlattenDelinearizedAccesses(llvm::ArrayRef<llvm::Instruction *> Accesses,
+                                 llvm::ScalarEvolution &SE,
+                                 llvm::DominatorTree &DT, llvm::LoopInfo &LI);
 
 bool DecomposeMultiDimArrayRefs(llvm::GetElementPtrInst *GEP);
 
+/// Decompose multi-dimensional array accesses into row pointer loads.
+///
+/// The loads of a row are shared between the accesses that use the same
+/// prefix of indices, unless a write to the row might execute in between, and
+/// are placed in the preheader of the outermost loop that they are invariant
+/// in and that does not write to them. The loads of rows that are stored in a
+/// constant global are also marked as invariant.
+bool DecomposeMultiDimArrayRefs(llvm::ArrayRef<llvm::GetElementPtrInst *> GEPs,
+                                llvm::DominatorTree &DT, llvm::LoopInfo &LI,
+                                llvm::AAResults *AA = nullptr);
+
 } // namespace atrox
 
@@ -0,0 +1,39 @@
+//
+//
+//
+
+#pragma once
+
+#include "Atrox/Config.hpp"
+
+#include "Atrox/Support/IR/PipelineSpec.hpp"
+
+#include "llvm/ADT/ArrayRef.h"
+// using llvm::ArrayRef
+
+namespace llvm {
+class Value;
+class BasicBlock;
+class Function;
+class Loop;
+} // namespace llvm
+
+namespace atrox {
+
+/// Replace the payload blocks of a loop with pushing the inputs of the
+/// extracted payload to a decoupled software pipeline of the runtime. The
+/// payload region must be separable from the loop iterator.
+///
+/// The pipeline is created in the loop preheader and finished in the loop
+/// exit. The inputs that are invariant in the loop are stored once in a
+/// context, while the rest are stored in a record that is pushed in every
+/// iteration. A trampoline that unpacks both and calls the payload is
+/// generated. The inputs must be in the order of the payload parameters.
+bool CreateDecoupledPipeline(llvm::Loop &L,
+                             llvm::ArrayRef<llvm::BasicBlock *> PayloadBlocks,
+                             llvm::Function &Payload,
+                             llvm::ArrayRef<llvm::Value *> Inputs,
+                             unsigned Workers, unsigned Capacity,
+                             PipelineSpec *Spec = nullptr);
+
+} // namespace atrox
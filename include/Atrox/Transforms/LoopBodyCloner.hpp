@@ -12,10 +12,46 @@
 
 #include "Atrox/Support/IR/GeneralUtils.hpp"
 
+#include "Atrox/Support/CacheInfo.hpp"
+
 #include "Atrox/Analysis/LoopBoundsAnalyzer.hpp"
 
 #include "Atrox/Analysis/MemoryAccessInfo.hpp"
 
+#include "Atrox/Analysis/ParallelismAnalyzer.hpp"
+
+#include "Atrox/Analysis/ReductionRecognizer.hpp"
+
+#include "Atrox/Analysis/AccessFootprintAnalyzer.hpp"
+
+#include "Atrox/Analysis/AccessPatternAnalyzer.hpp"
+
+#include "Atrox/Analysis/PayloadIntensity.hpp"
+
+#include "Atrox/Analysis/ExtractionCost.hpp"
+
+#include "Atrox/Analysis/ArrayDelinearizer.hpp"
+
+#include "Atrox/Analysis/FieldDensityAnalyzer.hpp"
+
+#include "Atrox/Transforms/PayloadPrefetcher.hpp"
+
+#include "Atrox/Transforms/PayloadTiler.hpp"
+
+#include "Atrox/Transforms/PayloadInterchanger.hpp"
+
+#include "Atrox/Transforms/SoAPayload.hpp"
+
+#include "Atrox/Transforms/PayloadRegion.hpp"
+
+#include "Atrox/Transforms/DecoupledPipeline.hpp"
+
+#include "Atrox/Transforms/LoopFission.hpp"
+
+#include "Atrox/Transforms/CoroutineInterleaver.hpp"
+
+#include "Atrox/Transforms/PayloadSpecializer.hpp"
+
 #include "Atrox/Exchange/Info.hpp"
 
 #include "IteratorRecognition/Analysis/IteratorRecognition.hpp"
@@ -46,21 +82,43 @@
 #include "llvm/Analysis/AliasAnalysis.h"
 // using llvm::AAResults
 
+#include "llvm/Analysis/DependenceAnalysis.h"
+// using llvm::DependenceInfo
+
+#include "llvm/Analysis/BlockFrequencyInfo.h"
+// using llvm::BlockFrequencyInfo
+
+#include "llvm/Analysis/TargetTransformInfo.h"
+// using llvm::TargetTransformInfo
+
 #include "llvm/ADT/SmallVector.h"
 // using llvm::SmallVector
 
 #include "llvm/ADT/SetVector.h"
 // using llvm::SetVector
 
+#include "llvm/ADT/SmallPtrSet.h"
+// using llvm::SmallPtrSet
+
+#include "llvm/ADT/DenseMap.h"
+// using llvm::DenseMap
+
 #include "llvm/ADT/Optional.h"
 // uaing llvm::Optional
 
+#include "llvm/ADT/StringRef.h"
+// using llvm::StringRef
+
+#include "llvm/Support/raw_ostream.h"
+// using llvm::raw_string_ostream
+
 #include "llvm/Support/Debug.h"
 // using DEBUG macro
 // using llvm::dbgs
 
 #include <algorithm>
 // using std::count_if
+// using std::any_of
 
 #include <cassert>
 // using assert
@@ -70,9 +128,150 @@
 namespace atrox {
 
 class LoopBodyCloner {
+  enum class RewriteKind { Call, Pipeline, Fission, Interleave };
+
+  static const char *getName(RewriteKind RK) {
+    switch (RK) {
+    case RewriteKind::Call:
+      return "call";
+    case RewriteKind::Pipeline:
+      return "pipeline";
+    case RewriteKind::Fission:
+      return "fission";
+    case RewriteKind::Interleave:
+      return "interleave";
+    }
+
+    return "unknown";
+  }
+
+  // payloads to replace with a call, with a decoupled software pipeline, to
+  // split off their loop or to interleave after all loops of a function have
+  // been processed, since that changes the loop structure
+  struct PendingRewrite {
+    RewriteKind Kind;
+    llvm::Loop *L;
+    llvm::SmallVector<llvm::BasicBlock *, 32> Blocks;
+    llvm::Function *Payload;
+    llvm::SmallVector<llvm::Value *, 16> Inputs;
+    llvm::SmallVector<bool, 16> IteratorDependent;
+    // payload loads to suspend at when interleaving
+    llvm::SmallVector<llvm::LoadInst *, 4> Loads;
+    // initial fission buffer capacity and whether it bounds the trip count
+    uint64_t Capacity;
+    bool Bounded;
+    int InfoIndex;
+  };
+
   llvm::Module *TargetModule;
   bool StoreSuccessInfo, StoreFailInfo;
   llvm::SmallVector<FunctionArgSpec, 32> StoreInfo;
+  llvm::SmallVector<PendingRewrite, 4> PendingRewrites;
+
+  bool applyPendingRewrite(PendingRewrite &E) {
+    if (E.Kind == RewriteKind::Call) {
+      if (!ReplacePayloadRegionWithCall(E.Blocks, *E.Payload, E.Inputs)) {
+        return false;
+      }
+
+      if (E.InfoIndex >= 0) {
+        StoreInfo[E.InfoIndex].Mode = ExtractionMode::Replace;
+      }
+
+      return true;
+    }
+
+    if (E.Kind == RewriteKind::Fission) {
+      FissionSpec spec;
+      if (!CreateIteratorFission(*E.L, E.Blocks, *E.Payload, E.Inputs,
+                                 E.IteratorDependent, E.Capacity, &spec)) {
+        return false;
+      }
+
+      spec.Bounded = E.Bounded;
+
+      if (E.InfoIndex >= 0) {
+        StoreInfo[E.InfoIndex].Fission = spec;
+      }
+
+      return true;
+    }
+
+    if (E.Kind == RewriteKind::Interleave) {
+      InterleavingSpec spec;
+      if (!CreateInterleavedExecution(*E.L, E.Blocks, *E.Payload, E.Inputs,
+                                      E.Loads, AtroxInterleaveGroup, &spec)) {
+        return false;
+      }
+
+      if (E.InfoIndex >= 0) {
+        StoreInfo[E.InfoIndex].Interleaving = spec;
+      }
+
+      return true;
+    }
+
+    PipelineSpec spec;
+    if (!CreateDecoupledPipeline(*E.L, E.Blocks, *E.Payload, E.Inputs,
+                                 AtroxDSWPWorkers, AtroxDSWPCapacity, &spec)) {
+      return false;
+    }
+
+    if (E.InfoIndex >= 0) {
+      StoreInfo[E.InfoIndex].Pipeline = spec;
+    }
+
+    return true;
+  }
+
+  // the payload stays in the module as a plain clone, so its info has to
+  // tell that the original loop does not use it
+  void skipPendingRewrite(PendingRewrite &E, llvm::StringRef Reason) {
+    LLVM_DEBUG(llvm::dbgs() << "skipping rewrite for payload: "
+                            << E.Payload->getName() << " (" << Reason
+                            << ")\n";);
+
+    if (E.InfoIndex >= 0) {
+      StoreInfo[E.InfoIndex].SkippedRewrite =
+          SkippedRewriteSpec{getName(E.Kind), Reason.str()};
+    }
+  }
+
+  bool createPendingRewrites() {
+    bool hasChanged = false;
+    llvm::SmallPtrSet<llvm::BasicBlock *, 32> removed;
+    llvm::SmallVector<llvm::Loop *, 4> rewritten;
+
+    for (auto &e : PendingRewrites) {
+      auto isNested = [&e](llvm::Loop *O) {
+        return O->contains(e.L) || e.L->contains(O);
+      };
+
+      if (std::any_of(rewritten.begin(), rewritten.end(), isNested)) {
+        skipPendingRewrite(e, "nested in a rewritten loop");
+        continue;
+      }
+
+      if (std::any_of(e.Blocks.begin(), e.Blocks.end(),
+                      [&removed](auto *bb) { return removed.count(bb); })) {
+        skipPendingRewrite(e, "overlaps a rewritten payload");
+        continue;
+      }
+
+      if (!applyPendingRewrite(e)) {
+        skipPendingRewrite(e, "rewrite failed");
+        continue;
+      }
+
+      hasChanged = true;
+      rewritten.push_back(e.L);
+      removed.insert(e.Blocks.begin(), e.Blocks.end());
+    }
+
+    PendingRewrites.clear();
+
+    return hasChanged;
+  }
 
 public:
   explicit LoopBodyCloner(llvm::Module &CurM, bool _StoreSuccessInfo = false,
@@ -87,7 +286,10 @@ public:
       llvm::Loop &L, llvm::LoopInfo &LI, T &Selector,
       llvm::Optional<iteratorrecognition::IteratorRecognitionInfo *> ITRInfo,
       llvm::Optional<iteratorrecognition::DispositionTracker> IDT,
-      LoopBoundsAnalyzer &LBA, llvm::AAResults *AA = nullptr) {
+      LoopBoundsAnalyzer &LBA, llvm::AAResults *AA = nullptr,
+      llvm::DependenceInfo *DI = nullptr, llvm::ScalarEvolution *SE = nullptr,
+      llvm::BlockFrequencyInfo *BFI = nullptr,
+      const llvm::TargetTransformInfo *TTI = nullptr) {
     llvm::SmallVector<llvm::BasicBlock *, 32> blocks;
     Selector.getBlocks(L, blocks);
 
@@ -133,7 +335,7 @@ public:
       info = *infoOrError;
     }
 
-    atrox::CodeExtractor ce{blocks, L, &info, &LBA};
+    atrox::CodeExtractor ce{blocks, L, &info, &LBA, nullptr, false, BFI};
     ce.prepare();
 
     if (info) {
@@ -178,16 +380,221 @@ public:
     });
 #endif // !defined(NDEBUG)
 
+    llvm::SmallVector<llvm::PHINode *, 4> carried;
+    llvm::DenseMap<llvm::Value *, ReductionInfo> reductions;
+
+    for (auto *e : ce.getOutputs()) {
+      if (auto *in = ce.getBidirectionalInput(e)) {
+        auto *phi = llvm::dyn_cast<llvm::PHINode>(in);
+        carried.push_back(phi);
+
+        if (phi) {
+          if (auto red = RecognizeReduction(*phi, L)) {
+            reductions.insert({e, *red});
+          }
+        }
+      }
+    }
+
+    if (AtroxPrivatizeReductions) {
+      llvm::DenseMap<llvm::Value *, llvm::Constant *> privates;
+
+      for (auto &e : reductions) {
+        privates.insert({e.second.Phi, e.second.Identity});
+      }
+
+      ce.setPrivateReductions(privates);
+    }
+
+    llvm::Optional<PayloadParallelism> parallelism;
+    llvm::SmallVector<llvm::Instruction *, 16> payloadAccesses;
+
+    if (DI) {
+      ParallelismAnalyzer pa{*DI, info ? &info : nullptr};
+      parallelism = pa.classify(L, accesses.Accesses, carried);
+      pa.getPayloadAccesses(accesses.Accesses, payloadAccesses);
+
+      LLVM_DEBUG(llvm::dbgs() << "payload parallelism: "
+                              << toString(*parallelism) << '\n';);
+    }
+
+    llvm::DenseMap<llvm::Value *, AccessFootprintSpec> footprints;
+
+    if (SE) {
+      AccessFootprintAnalyzer afa{*SE, TargetModule->getDataLayout(), &LBA};
+
+      for (auto *e : ce.getPureInputs()) {
+        if (e->getType()->isPointerTy()) {
+          if (auto fp = afa.getSpec(L, e, accesses.Accesses)) {
+            footprints.insert({e, *fp});
+          }
+        }
+      }
+    }
+
+    auto intensity =
+        CalculatePayloadIntensity(blocks, accesses.Accesses, L, LI,
+                                  TargetModule->getDataLayout(), &LBA);
+
+    auto extraction =
+        CalculateExtractionCost(blocks, ce.getPureInputs().size(), L, LI, &LBA,
+                                TTI);
+    bool isReplacing = AtroxExtractionMode == ExtractionMode::Replace;
+
+    // a loop that is not worth a call is left as it is without a clone
+    if (isReplacing) {
+      if (!ce.getOutputs().empty() || ce.hasStackAllocas()) {
+        LLVM_DEBUG(llvm::dbgs() << "skipping loop because its payload cannot "
+                                   "be replaced with a call.\n");
+        return false;
+      }
+
+      if (!extraction.isProfitable(AtroxReplaceMaxOverhead,
+                                   AtroxReplaceMinTripCount)) {
+        LLVM_DEBUG(llvm::dbgs() << "skipping loop because a payload call is "
+                                   "not profitable.\n");
+        return false;
+      }
+    }
+
     ce.setAccesses(&accesses);
+
+    llvm::DenseMap<llvm::Value *, AccessPatternSpec> patterns;
+    llvm::SmallVector<llvm::LoadInst *, 4> missingLoads;
+
+    if (SE) {
+      AccessPatternAnalyzer apa{*SE, TargetModule->getDataLayout()};
+
+      for (auto *e : ce.getPureInputs()) {
+        if (auto ap = apa.classify(L, e, ce.getAccesses()->Accesses)) {
+          patterns.insert({e, *ap});
+        }
+      }
+
+      // loads through addresses that depend on values loaded in the loop or
+      // that are not recurrences are likely to miss in the cache
+      if (AtroxInterleave) {
+        for (auto e : accesses.Accesses) {
+          auto *load = llvm::dyn_cast<llvm::LoadInst>(e.get());
+
+          if (load && load->isSimple() &&
+              apa.classifyAccess(L, e).Pattern >= AccessPattern::Indirect) {
+            missingLoads.push_back(load);
+          }
+        }
+      }
+    }
+
+    llvm::Optional<PayloadInterchanger> interchanger;
+    llvm::SmallVector<llvm::Loop *, 4> interchanged;
+
+    if (AtroxInterchange && SE) {
+      interchanger.emplace(*SE, DI);
+      interchanger->analyze(L, accesses.Accesses);
+      interchanger->getInterchangeable(interchanged);
+    }
+
+    llvm::Optional<PayloadTiler> tiler;
+
+    if (AtroxTile && SE) {
+      uint64_t cacheSize = AtroxTileCacheSize;
+
+      if (!cacheSize) {
+        cacheSize = GetDataCacheSize(AtroxTileCacheLevel);
+      }
+
+      // fall back to a common second level cache size
+      if (!cacheSize) {
+        cacheSize = 256 * 1024;
+      }
+
+      tiler.emplace(*SE, TargetModule->getDataLayout(), cacheSize,
+                    AtroxCacheLineSize, &LBA, DI);
+      tiler->analyze(L, accesses.Accesses, interchanged);
+    }
+
+    // the strides of the restructured nests do not hold in the extracted
+    // function, so they are not prefetched
+    llvm::Optional<PayloadPrefetcher> prefetcher;
+
+    if (AtroxPrefetch && SE) {
+      llvm::SmallVector<llvm::Loop *, 4> restructured(interchanged.begin(),
+                                                     interchanged.end());
+
+      if (tiler) {
+        tiler->getTiled(restructured);
+      }
+
+      prefetcher.emplace(*SE, LI, TargetModule->getDataLayout(),
+                         AtroxCacheLineSize, AtroxPrefetchLatency, &LBA);
+      prefetcher->analyze(L, blocks, accesses.Accesses, AtroxPrefetchDistance,
+                          AtroxPrefetchIndirect, restructured);
+    }
+
+    llvm::Optional<PayloadSpecializer> specializer;
+
+    if (AtroxSpecialize && SE) {
+      specializer.emplace(*SE, &LBA, AtroxSpecializeMaxTripCount);
+      specializer->analyze(L, {ce.getPureInputs().begin(),
+                               ce.getPureInputs().end()});
+    }
+
     auto *extractedFunc = ce.cloneCodeRegion();
     llvm::SmallVector<ArgDirection, 16> argDirs;
 
+    if (extractedFunc && isReplacing &&
+        (ce.getAggregateLayout() ||
+         !IsPayloadRegionReplaceable(L, ce.getBlocks()))) {
+      LLVM_DEBUG(llvm::dbgs() << "discarding payload: "
+                              << extractedFunc->getName()
+                              << " because its region cannot be replaced.\n");
+      extractedFunc->eraseFromParent();
+      extractedFunc = nullptr;
+    }
+
     if (extractedFunc) {
       hasChanged = true;
       llvm::SmallVector<bool, 16> argIteratorVariance;
 
+      if (AtroxAnnotateParallelLoops && parallelism &&
+          *parallelism != PayloadParallelism::Serial) {
+        AnnotateParallelAccesses(L, payloadAccesses);
+      }
+
+      if (prefetcher) {
+        auto n = prefetcher->insert(
+            [&ce](llvm::Value *V) { return ce.getClonedValue(V); });
+
+        LLVM_DEBUG(llvm::dbgs() << "inserted " << n << " prefetches\n";);
+      }
+
+      if (interchanger) {
+        auto n = interchanger->insert(
+            [&ce](llvm::Value *V) { return ce.getClonedValue(V); });
+
+        LLVM_DEBUG(llvm::dbgs() << "interchanged " << n << " loop nests\n";);
+      }
+
+      if (tiler) {
+        auto n = tiler->insert(
+            [&ce](llvm::Value *V) { return ce.getClonedValue(V); });
+
+        LLVM_DEBUG(llvm::dbgs() << "tiled " << n << " loop nests\n";);
+      }
+
       GenerateArgDirection(ce.getPureInputs(), ce.getOutputs(), argDirs, &mai);
 
+      // privatized reductions do not read the incoming value
+      if (AtroxPrivatizeReductions) {
+        size_t i = ce.getPureInputs().size();
+        for (auto *e : ce.getOutputs()) {
+          if (reductions.count(e)) {
+            argDirs[i] = AD_Outbound;
+          }
+          ++i;
+        }
+      }
+
       if (!IDT) {
         argIteratorVariance.resize(argDirs.size(), false);
       } else {
@@ -196,19 +603,198 @@ public:
       }
 
       if (StoreSuccessInfo) {
-        assert(extractedFunc->arg_size() == argDirs.size() &&
+        assert(ce.getPureInputs().size() + ce.getOutputs().size() ==
+                   argDirs.size() &&
                "Arguments and their specs must be the same number!");
 
+        // specs are named after the values they carry since the arguments of
+        // the extracted function might be aggregated
         std::vector<ArgSpec> specs;
 
-        auto argIt = extractedFunc->arg_begin();
-        for (size_t i = 0; i < argDirs.size(); ++i) {
-          specs.push_back(
-              {argIt->getName(), argDirs[i], argIteratorVariance[i]});
-          ++argIt;
+        size_t i = 0;
+        for (auto *e : ce.getPureInputs()) {
+          specs.push_back({e->getName(), argDirs[i], argIteratorVariance[i]});
+
+          if (ce.getAggregateLayout()) {
+            specs.back().Passing = ArgPassing::Aggregate;
+          }
+
+          auto found = footprints.find(e);
+          if (found != footprints.end()) {
+            specs.back().Footprint = found->second;
+          }
+
+          auto foundPattern = patterns.find(e);
+          if (foundPattern != patterns.end()) {
+            specs.back().Pattern = foundPattern->second;
+          }
+
+          ++i;
+        }
+
+        size_t k = 0;
+        for (auto *e : ce.getOutputs()) {
+          specs.push_back({(e->getName() + ".out").str(), argDirs[i],
+                           argIteratorVariance[i]});
+          specs.back().Passing = ce.getOutputPassing(k);
+          specs.back().ReturnIndex = ce.getOutputReturnIndex(k);
+          ++i;
+          ++k;
         }
 
         StoreInfo.push_back({extractedFunc, &L, specs});
+
+        if (auto *layout = ce.getAggregateLayout()) {
+          StoreInfo.back().AggregateLayout = *layout;
+        }
+
+        StoreInfo.back().Parallelism = parallelism;
+        StoreInfo.back().Intensity = intensity;
+        StoreInfo.back().Bound =
+            ClassifyRoofline(intensity, AtroxPeakGOPS, AtroxPeakBandwidth);
+        StoreInfo.back().Extraction = extraction;
+
+        for (auto *e : ce.getOutputs()) {
+          auto found = reductions.find(e);
+          if (found == reductions.end()) {
+            continue;
+          }
+
+          std::string identity;
+          llvm::raw_string_ostream os{identity};
+          found->second.Identity->printAsOperand(os, false);
+
+          StoreInfo.back().Reductions.push_back(
+              {(e->getName() + ".out").str(), found->second.Op, os.str(),
+               AtroxPrivatizeReductions});
+        }
+
+        if (prefetcher) {
+          prefetcher->getSpecs(StoreInfo.back().Prefetches);
+        }
+
+        for (auto *e : L.getLoopsInPreorder()) {
+          if (auto spec = LBA.getSpec(e)) {
+            StoreInfo.back().LoopBounds.push_back(*spec);
+          }
+        }
+
+        if (SE) {
+          GetArrayShapes(*SE, LI, accesses.Accesses,
+                         StoreInfo.back().ArrayShapes);
+        }
+
+        if (tiler) {
+          tiler->getSpecs(StoreInfo.back().Tilings);
+        }
+
+        if (interchanger) {
+          interchanger->getSpecs(StoreInfo.back().Interchanges);
+        }
+
+        if (!ce.getAggregateLayout()) {
+          AnalyzeFieldDensity(*extractedFunc, StoreInfo.back().FieldDensities);
+        }
+      }
+
+      // the variant is cloned before the payload is rewritten to dispatch
+      if (AtroxSoA && !ce.getAggregateLayout()) {
+        SoALayoutSpec layout;
+
+        if (CreateSoAPayload(*extractedFunc, &layout) && StoreSuccessInfo) {
+          StoreInfo.back().SoALayout = layout;
+        }
+      }
+
+      bool isSeparable = AA && !isReplacing && ce.getOutputs().empty() &&
+                         !ce.getAggregateLayout() && !ce.hasStackAllocas() &&
+                         (AtroxFission || AtroxInterleave || AtroxDSWP) &&
+                         IsPayloadRegionSeparable(L, ce.getBlocks(), *AA);
+      int infoIndex =
+          StoreSuccessInfo ? static_cast<int>(StoreInfo.size()) - 1 : -1;
+
+      if (isReplacing) {
+        PendingRewrites.push_back(
+            {RewriteKind::Call,
+             &L,
+             {ce.getBlocks().begin(), ce.getBlocks().end()},
+             extractedFunc,
+             {ce.getPureInputs().begin(), ce.getPureInputs().end()},
+             {},
+             {},
+             0,
+             false,
+             infoIndex});
+      } else if (isSeparable && AtroxFission) {
+        // the payload invocations keep their order when split off the loop
+        auto lbi = LBA.getInfo(&L);
+        uint64_t tripCount = lbi ? lbi->TripCount : 0;
+
+        PendingRewrites.push_back(
+            {RewriteKind::Fission,
+             &L,
+             {ce.getBlocks().begin(), ce.getBlocks().end()},
+             extractedFunc,
+             {ce.getPureInputs().begin(), ce.getPureInputs().end()},
+             {argIteratorVariance.begin(), argIteratorVariance.end()},
+             {},
+             tripCount ? tripCount : AtroxFissionCapacity,
+             tripCount != 0,
+             infoIndex});
+      } else if (isSeparable && AtroxInterleave && !missingLoads.empty() &&
+                 parallelism && *parallelism == PayloadParallelism::DOALL) {
+        llvm::SmallVector<llvm::LoadInst *, 4> loads;
+
+        for (auto *e : missingLoads) {
+          auto *clone = ce.getClonedValue(e);
+
+          if (auto *load = llvm::dyn_cast_or_null<llvm::LoadInst>(clone)) {
+            loads.push_back(load);
+          }
+        }
+
+        PendingRewrites.push_back(
+            {RewriteKind::Interleave,
+             &L,
+             {ce.getBlocks().begin(), ce.getBlocks().end()},
+             extractedFunc,
+             {ce.getPureInputs().begin(), ce.getPureInputs().end()},
+             {},
+             loads,
+             0,
+             false,
+             infoIndex});
+      } else if (isSeparable && AtroxDSWP &&
+                 (AtroxDSWPWorkers <= 1 ||
+                  (parallelism &&
+                   *parallelism == PayloadParallelism::DOALL))) {
+        PendingRewrites.push_back(
+            {RewriteKind::Pipeline,
+             &L,
+             {ce.getBlocks().begin(), ce.getBlocks().end()},
+             extractedFunc,
+             {ce.getPureInputs().begin(), ce.getPureInputs().end()},
+             {},
+             {},
+             0,
+             false,
+             infoIndex});
+      }
+
+      // the coroutine of an interleaved payload is cloned from its body
+      bool isInterleaved = !PendingRewrites.empty() &&
+                           PendingRewrites.back().Payload == extractedFunc &&
+                           PendingRewrites.back().Kind ==
+                               RewriteKind::Interleave;
+
+      if (specializer && !specializer->empty() && !ce.getAggregateLayout() &&
+          !isInterleaved) {
+        SpecializationSpec spec;
+
+        if (specializer->specialize(*extractedFunc, &spec) &&
+            StoreSuccessInfo) {
+          StoreInfo.back().Specialization = spec;
+        }
       }
     }
 
@@ -220,7 +806,10 @@ public:
                   llvm::Optional<iteratorrecognition::IteratorRecognitionInfo *>
                       ITRInfoOrEmpty,
                   llvm::ScalarEvolution *SE = nullptr,
-                  llvm::AAResults *AA = nullptr) {
+                  llvm::AAResults *AA = nullptr,
+                  llvm::DependenceInfo *DI = nullptr,
+                  llvm::BlockFrequencyInfo *BFI = nullptr,
+                  const llvm::TargetTransformInfo *TTI = nullptr) {
     bool hasChanged = false;
 
     auto loops = LI.getLoopsInPreorder();
@@ -238,7 +827,7 @@ public:
                               << curLoop->getHeader()->getName() << '\n';);
 
       if (cloneLoop(*curLoop, LI, Selector, ITRInfoOrEmpty, idtOrEmpty, lba,
-                    AA)) {
+                    AA, DI, SE, BFI, TTI)) {
         hasChanged = true;
       } else {
         if (StoreFailInfo) {
@@ -247,6 +836,8 @@ public:
       }
     }
 
+    hasChanged |= createPendingRewrites();
+
     return hasChanged;
   }
 };
@@ -0,0 +1,44 @@
+//
+//
+//
+
+#pragma once
+
+#include "Atrox/Config.hpp"
+
+#include "Atrox/Support/IR/FissionSpec.hpp"
+
+#include "llvm/ADT/ArrayRef.h"
+// using llvm::ArrayRef
+
+#include <cstdint>
+// using uint64_t
+
+namespace llvm {
+class Value;
+class BasicBlock;
+class Function;
+class Loop;
+} // namespace llvm
+
+namespace atrox {
+
+/// Split a loop into a phase that runs only its iterator and a phase that
+/// runs the extracted payload over the inputs gathered by the first one. The
+/// payload region must be separable from the loop iterator.
+///
+/// The payload blocks are replaced with appending the inputs that are
+/// iterator dependent or vary in the loop as a record to a runtime buffer,
+/// which is created in the loop preheader with the given capacity and grows
+/// as needed. At the loop exit, a counted loop calls the payload for each
+/// record with the rest of the inputs passed directly. The inputs must be in
+/// the order of the payload parameters and the flags, if given, must be at
+/// least as many.
+bool CreateIteratorFission(llvm::Loop &L,
+                           llvm::ArrayRef<llvm::BasicBlock *> PayloadBlocks,
+                           llvm::Function &Payload,
+                           llvm::ArrayRef<llvm::Value *> Inputs,
+                           llvm::ArrayRef<bool> IteratorDependent,
+                           uint64_t Capacity, FissionSpec *Spec = nullptr);
+
+} // namespace atrox
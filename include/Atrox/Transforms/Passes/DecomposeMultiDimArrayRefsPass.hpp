@@ -20,6 +20,10 @@
 
 namespace llvm {
 class Function;
+class DominatorTree;
+class LoopInfo;
+class AAResults;
+class ScalarEvolution;
 } // namespace llvm
 
 #define ATROX_DECOMPOSEARRAYREFS_PASS_NAME "atrox-decompose-array-refs-pass"
@@ -32,7 +36,9 @@ class DecomposeMultiDimArrayRefsPass
 public:
   DecomposeMultiDimArrayRefsPass();
 
-  bool perform(llvm::Function &F);
+  bool perform(llvm::Function &F, llvm::DominatorTree &DT, llvm::LoopInfo &LI,
+               llvm::AAResults *AA = nullptr,
+               llvm::ScalarEvolution *SE = nullptr);
 
   llvm::PreservedAnalyses run(llvm::Function &F,
                               llvm::FunctionAnalysisManager &FAM);
@@ -18,6 +18,12 @@
 #include "llvm/Analysis/AliasAnalysis.h"
 // using llvm::AAResults
 
+#include "llvm/Analysis/DependenceAnalysis.h"
+// using llvm::DependenceInfo
+
+#include "llvm/Analysis/TargetTransformInfo.h"
+// using llvm::TargetTransformInfo
+
 #include "llvm/IR/PassManager.h"
 // using llvm::ModuleAnalysisManager
 // using llvm::PassInfoMixin
@@ -42,7 +48,9 @@ public:
       llvm::Module &M,
       std::function<llvm::ScalarEvolution &(llvm::Function &)> &GetSE,
       std::function<llvm::MemoryDependenceResults &(llvm::Function &)> &GetMDR,
-      std::function<llvm::AAResults &(llvm::Function &)> &GetAA);
+      std::function<llvm::AAResults &(llvm::Function &)> &GetAA,
+      std::function<llvm::DependenceInfo &(llvm::Function &)> &GetDI,
+      std::function<llvm::TargetTransformInfo &(llvm::Function &)> &GetTTI);
 
   llvm::PreservedAnalyses run(llvm::Module &M,
                               llvm::ModuleAnalysisManager &MAM);
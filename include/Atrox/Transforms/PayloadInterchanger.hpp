@@ -0,0 +1,79 @@
+//
+//
+//
+
+#pragma once
+
+#include "Atrox/Config.hpp"
+
+#include "Atrox/Support/MemAccInst.hpp"
+
+#include "Atrox/Support/IR/InterchangeSpec.hpp"
+
+#include "llvm/ADT/ArrayRef.h"
+// using llvm::ArrayRef
+
+#include "llvm/ADT/SmallVector.h"
+// using llvm::SmallVector
+// using llvm::SmallVectorImpl
+
+#include "llvm/ADT/STLExtras.h"
+// using llvm::function_ref
+
+#include <vector>
+// using std::vector
+
+namespace llvm {
+class Value;
+class Loop;
+class ScalarEvolution;
+class DependenceInfo;
+} // namespace llvm
+
+namespace atrox {
+
+/// Interchanges the two innermost loops of the loop nests in a payload whose
+/// inner loop walks arrays along a larger stride than its outer loop, as
+/// when a row-major array is traversed column by column.
+///
+/// Only perfect nests of counted loops with bounds that do not depend on each
+/// other are interchanged, which is done by swapping the iteration spaces of
+/// their induction variables. Every nest with a stride mismatch is reported,
+/// along with the reason that it has not been interchanged.
+class PayloadInterchanger {
+  struct Candidate {
+    llvm::Loop *Outer;
+    llvm::Loop *Inner;
+    InterchangeStatus Status;
+    unsigned Improved;
+    unsigned Worsened;
+  };
+
+  using GetCloneFuncTy = llvm::function_ref<llvm::Value *(llvm::Value *)>;
+
+  llvm::ScalarEvolution *SE;
+  llvm::DependenceInfo *DI;
+  llvm::SmallVector<Candidate, 4> Candidates;
+
+  bool insertInterchange(const Candidate &C, GetCloneFuncTy GetClone);
+
+public:
+  PayloadInterchanger(llvm::ScalarEvolution &SE,
+                      llvm::DependenceInfo *DI = nullptr)
+      : SE(&SE), DI(DI) {}
+
+  /// Find the nests of the original loop to interchange.
+  void analyze(llvm::Loop &L, llvm::ArrayRef<MemAccInst> Accesses);
+
+  /// The outer loops of the nests that are going to be interchanged.
+  void getInterchangeable(llvm::SmallVectorImpl<llvm::Loop *> &Loops) const;
+
+  /// Interchange the nests in the extracted function, given the mapping from
+  /// the original values to the values that stand for them in it. Returns the
+  /// number of interchanged nests.
+  unsigned insert(GetCloneFuncTy GetClone);
+
+  void getSpecs(std::vector<InterchangeSpec> &Specs) const;
+};
+
+} // namespace atrox
@@ -0,0 +1,137 @@
+//
+//
+//
+
+#pragma once
+
+#include "Atrox/Config.hpp"
+
+#include "Atrox/Support/MemAccInst.hpp"
+
+#include "Atrox/Support/IR/PrefetchSpec.hpp"
+
+#include "llvm/ADT/ArrayRef.h"
+// using llvm::ArrayRef
+
+#include "llvm/ADT/SmallVector.h"
+// using llvm::SmallVector
+
+#include "llvm/ADT/STLExtras.h"
+// using llvm::function_ref
+
+#include <vector>
+// using std::vector
+
+#include <string>
+// using std::string
+
+#include <cstdint>
+// using int64_t
+
+namespace llvm {
+class Value;
+class Instruction;
+class LoadInst;
+class PHINode;
+class BasicBlock;
+class Loop;
+class LoopInfo;
+class SCEV;
+class ScalarEvolution;
+class DataLayout;
+} // namespace llvm
+
+namespace atrox {
+
+class LoopBoundsAnalyzer;
+
+/// Inserts software prefetches for the strided and indirect accesses of a
+/// payload.
+///
+/// The strided candidates are the loads and stores of the original loop whose
+/// address is an affine add recurrence with a constant step in the innermost
+/// loop that contains them. Accesses that fall in the same cache line of a
+/// stream are prefetched once.
+///
+/// The indirect candidates are accesses of the form x[idx[i]], where idx[i]
+/// is a strided load of the same loop. The index array is prefetched twice the
+/// distance ahead, while the index at the prefetch distance is loaded under a
+/// guard against the end of the iteration space, as reported by the loop
+/// bounds analyzer, and used to prefetch the indirect access. That end is the
+/// last executed value of the induction variable only for loops that test
+/// their bound at the latch; otherwise it is the exit value and is excluded.
+///
+/// The prefetches are inserted in the extracted function ahead of the
+/// corresponding cloned accesses.
+class PayloadPrefetcher {
+  struct Candidate {
+    llvm::Instruction *Access;
+    llvm::Loop *L;
+    int64_t Stride;
+    unsigned Distance;
+    std::string Base;
+  };
+
+  struct IndirectCandidate {
+    llvm::Instruction *Access;
+    llvm::LoadInst *Index;
+    llvm::Loop *L;
+    int64_t IndexStride;
+    unsigned Distance;
+    llvm::PHINode *IndVar;
+    int64_t IndVarStep;
+    const llvm::SCEV *End;
+    bool IsEndInclusive;
+    std::string Base;
+    std::string IndexBase;
+  };
+
+  using GetCloneFuncTy = llvm::function_ref<llvm::Value *(llvm::Value *)>;
+
+  llvm::ScalarEvolution *SE;
+  llvm::LoopInfo *LI;
+  const llvm::DataLayout *DL;
+  LoopBoundsAnalyzer *LBA;
+  unsigned CacheLineSize;
+  unsigned Latency;
+  llvm::SmallVector<Candidate, 8> Candidates;
+  llvm::SmallVector<Candidate, 8> Inserted;
+  llvm::SmallVector<IndirectCandidate, 4> IndirectCandidates;
+  llvm::SmallVector<IndirectCandidate, 4> InsertedIndirect;
+
+  unsigned getDistance(llvm::Loop &L,
+                       llvm::ArrayRef<llvm::BasicBlock *> Blocks) const;
+
+  void analyzeIndirect(llvm::Instruction &I, llvm::Loop &CurL,
+                       unsigned Distance);
+
+  bool insertIndirect(const IndirectCandidate &C, GetCloneFuncTy GetClone);
+
+public:
+  PayloadPrefetcher(llvm::ScalarEvolution &SE, llvm::LoopInfo &LI,
+                    const llvm::DataLayout &DL, unsigned CacheLineSize,
+                    unsigned Latency, LoopBoundsAnalyzer *LBA = nullptr)
+      : SE(&SE), LI(&LI), DL(&DL), LBA(LBA), CacheLineSize(CacheLineSize),
+        Latency(Latency) {}
+
+  /// Find the accesses to prefetch. A distance of 0 derives the prefetch
+  /// distance of each loop from the latency, which is expressed in payload
+  /// weight units, and the payload weight of the loop. Indirect accesses are
+  /// only considered when requested and loop bounds are available.
+  ///
+  /// Accesses in the given loops are skipped, since their strides do not hold
+  /// for nests that are restructured in the extracted function.
+  void analyze(llvm::Loop &L, llvm::ArrayRef<llvm::BasicBlock *> Blocks,
+               llvm::ArrayRef<MemAccInst> Accesses, unsigned Distance = 0,
+               bool IncludeIndirect = false,
+               llvm::ArrayRef<llvm::Loop *> Excluded = {});
+
+  /// Insert the prefetches in the extracted function, given the mapping from
+  /// the original values to the values that stand for them in it. Returns the
+  /// number of prefetched accesses.
+  unsigned insert(GetCloneFuncTy GetClone);
+
+  void getSpecs(std::vector<PrefetchSpec> &Specs) const;
+};
+
+} // namespace atrox
@@ -0,0 +1,62 @@
+//
+//
+//
+
+#pragma once
+
+#include "Atrox/Config.hpp"
+
+#include "llvm/ADT/ArrayRef.h"
+// using llvm::ArrayRef
+
+#include "llvm/ADT/StringRef.h"
+// using llvm::StringRef
+
+namespace llvm {
+class Value;
+class BasicBlock;
+class CallInst;
+class Function;
+class FunctionType;
+class Module;
+class Loop;
+class AAResults;
+} // namespace llvm
+
+namespace atrox {
+
+/// Check that the payload blocks of a loop form a single-entry single-exit
+/// region inside the loop that excludes its header and does not produce
+/// values, so that the region can be replaced.
+bool IsPayloadRegionReplaceable(
+    llvm::Loop &L, llvm::ArrayRef<llvm::BasicBlock *> PayloadBlocks);
+
+/// Check that the payload blocks of a loop can be run apart from the rest of
+/// the loop, which is its iterator. This requires that the payload region is
+/// replaceable and that it does not access memory that the iterator accesses,
+/// unless both of them only read it.
+bool IsPayloadRegionSeparable(llvm::Loop &L,
+                              llvm::ArrayRef<llvm::BasicBlock *> PayloadBlocks,
+                              llvm::AAResults &AA);
+
+/// Replace the payload blocks of a loop with a single empty block that
+/// branches to the region exit and return it, or nullptr if the blocks do not
+/// form a single-entry single-exit region.
+llvm::BasicBlock *
+ReplacePayloadRegion(llvm::ArrayRef<llvm::BasicBlock *> PayloadBlocks,
+                     llvm::StringRef Name);
+
+/// Replace the payload blocks of a loop with a call to the extracted payload
+/// and return it, or nullptr if that is not possible. The inputs must be in
+/// the order of the payload parameters.
+llvm::CallInst *
+ReplacePayloadRegionWithCall(llvm::ArrayRef<llvm::BasicBlock *> PayloadBlocks,
+                             llvm::Function &Payload,
+                             llvm::ArrayRef<llvm::Value *> Inputs);
+
+/// Get the declaration of a runtime function, adding it to the module if
+/// needed.
+llvm::Function *GetRuntimeFunction(llvm::Module &M, llvm::StringRef Name,
+                                   llvm::FunctionType *Ty);
+
+} // namespace atrox
@@ -0,0 +1,76 @@
+//
+//
+//
+
+#pragma once
+
+#include "Atrox/Config.hpp"
+
+#include "Atrox/Support/IR/SpecializationSpec.hpp"
+
+#include "llvm/ADT/ArrayRef.h"
+// using llvm::ArrayRef
+
+#include "llvm/ADT/SmallVector.h"
+// using llvm::SmallVector
+
+#include "llvm/ADT/APInt.h"
+// using llvm::APInt
+
+namespace llvm {
+class Value;
+class Function;
+class Loop;
+class ScalarEvolution;
+} // namespace llvm
+
+namespace atrox {
+
+class LoopBoundsAnalyzer;
+
+/// Specializes an extracted payload for the values that its integer inputs
+/// are known or expected to have at the original loop.
+///
+/// An input is a candidate if its value in the loop is a constant, as far as
+/// scalar evolution can tell, or if it determines the backedge-taken count of
+/// a loop nested in the payload loop whose trip count has a small constant
+/// bound, as reported by the loop bounds analyzer. In the latter case, the
+/// input is expected to take the value for which the bound is reached.
+///
+/// The body of the payload is moved to a generic variant and a variant
+/// with the candidates replaced by their values is cloned from it. The payload
+/// becomes a stub that dispatches to the specialized variant when all of the
+/// candidate arguments are equal to their values, and to the generic one
+/// otherwise, so that its interface is preserved.
+class PayloadSpecializer {
+  struct Candidate {
+    unsigned ArgNo;
+    llvm::APInt Value;
+    SpecializationSource Source;
+  };
+
+  llvm::ScalarEvolution *SE;
+  LoopBoundsAnalyzer *LBA;
+  unsigned MaxTripCount;
+  llvm::SmallVector<Candidate, 4> Candidates;
+
+  void addCandidate(unsigned ArgNo, const llvm::APInt &Value,
+                    SpecializationSource Source);
+
+public:
+  PayloadSpecializer(llvm::ScalarEvolution &SE, LoopBoundsAnalyzer *LBA,
+                     unsigned MaxTripCount)
+      : SE(&SE), LBA(LBA), MaxTripCount(MaxTripCount) {}
+
+  /// Find the candidates among the inputs of the payload of a loop, which
+  /// must be in the order of the payload parameters.
+  void analyze(llvm::Loop &L, llvm::ArrayRef<llvm::Value *> Inputs);
+
+  bool empty() const { return Candidates.empty(); }
+
+  /// Turn the payload into a dispatch stub for its specialized and generic
+  /// variants. Returns false if there are no candidates.
+  bool specialize(llvm::Function &Payload, SpecializationSpec *Spec = nullptr);
+};
+
+} // namespace atrox
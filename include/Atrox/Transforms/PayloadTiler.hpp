@@ -0,0 +1,99 @@
+//
+//
+//
+
+#pragma once
+
+#include "Atrox/Config.hpp"
+
+#include "Atrox/Support/MemAccInst.hpp"
+
+#include "Atrox/Support/IR/TilingSpec.hpp"
+
+#include "llvm/ADT/ArrayRef.h"
+// using llvm::ArrayRef
+
+#include "llvm/ADT/SmallVector.h"
+// using llvm::SmallVector
+
+#include "llvm/ADT/STLExtras.h"
+// using llvm::function_ref
+
+#include <vector>
+// using std::vector
+
+#include <cstdint>
+// using uint64_t
+
+namespace llvm {
+class Value;
+class Loop;
+class ScalarEvolution;
+class DependenceInfo;
+class DataLayout;
+} // namespace llvm
+
+namespace atrox {
+
+class LoopBoundsAnalyzer;
+
+/// Tiles the two innermost loops of the loop nests in a payload.
+///
+/// A nest is a candidate when its inner loop walks an array with a stride of
+/// at least a cache line, while the outer loop walks the same array with a
+/// smaller stride, so that the lines brought in by the inner loop would be
+/// reused by the next outer iteration if they were still in the cache. The
+/// tile size is the largest power of two for which the lines touched by a
+/// tile fit in half of the given cache size.
+///
+/// The inner loop is strip-mined and its tile loop is placed around the outer
+/// loop, which requires that the dependences of the nest allow the two loops
+/// to be interchanged.
+class PayloadTiler {
+  struct Candidate {
+    llvm::Loop *Outer;
+    llvm::Loop *Inner;
+    unsigned TileSize;
+    uint64_t Footprint;
+  };
+
+  using GetCloneFuncTy = llvm::function_ref<llvm::Value *(llvm::Value *)>;
+
+  llvm::ScalarEvolution *SE;
+  const llvm::DataLayout *DL;
+  LoopBoundsAnalyzer *LBA;
+  llvm::DependenceInfo *DI;
+  uint64_t CacheSize;
+  unsigned CacheLineSize;
+  llvm::SmallVector<Candidate, 4> Candidates;
+  llvm::SmallVector<Candidate, 4> Inserted;
+
+  bool insertTile(const Candidate &C, GetCloneFuncTy GetClone);
+
+public:
+  PayloadTiler(llvm::ScalarEvolution &SE, const llvm::DataLayout &DL,
+               uint64_t CacheSize, unsigned CacheLineSize,
+               LoopBoundsAnalyzer *LBA = nullptr,
+               llvm::DependenceInfo *DI = nullptr)
+      : SE(&SE), DL(&DL), LBA(LBA), DI(DI), CacheSize(CacheSize),
+        CacheLineSize(CacheLineSize) {}
+
+  /// Find the nests of the original loop to tile, except for the ones with
+  /// the given outer loops.
+  void analyze(llvm::Loop &L, llvm::ArrayRef<MemAccInst> Accesses,
+               llvm::ArrayRef<llvm::Loop *> Excluded = {});
+
+  bool empty() const { return Candidates.empty(); }
+
+  /// The outer loops of the nests that are going to be tiled.
+  void getTiled(llvm::SmallVectorImpl<llvm::Loop *> &Loops) const;
+
+  /// Tile the nests in the extracted function, given the mapping from the
+  /// original values to the values that stand for them in it. Returns the
+  /// number of tiled nests.
+  unsigned insert(GetCloneFuncTy GetClone);
+
+  void getSpecs(std::vector<TilingSpec> &Specs) const;
+};
+
+} // namespace atrox
@@ -0,0 +1,29 @@
+//
+//
+//
+
+#pragma once
+
+#include "Atrox/Config.hpp"
+
+#include "Atrox/Support/IR/FieldDensitySpec.hpp"
+
+namespace llvm {
+class Function;
+} // namespace llvm
+
+namespace atrox {
+
+/// Create a variant of a payload that takes its sparsely accessed arrays of
+/// structs as separate arrays for each accessed field.
+///
+/// A struct pointer argument is converted if all of its uses go through the
+/// address of a field of one of its elements and not all of its fields are
+/// accessed. The variant takes one pointer for each of those fields instead,
+/// whose elements are indexed like the original array, and is named after the
+/// payload with a ".soa" suffix. The payload itself is left untouched, since
+/// the variant expects its caller to lay out the fields accordingly.
+llvm::Function *CreateSoAPayload(llvm::Function &Payload,
+                                 SoALayoutSpec *Spec = nullptr);
+
+} // namespace atrox
@@ -21,8 +21,12 @@
 
 #include "Atrox/Support/IR/ArgDirection.hpp"
 
+#include "Atrox/Support/IR/ArgSpec.hpp"
+
 #include "Atrox/Support/IR/ArgUtils.hpp"
 
+#include "Atrox/Support/IR/AggregateLayout.hpp"
+
 #include "IteratorRecognition/Analysis/IteratorRecognition.hpp"
 
 #include "llvm/ADT/ArrayRef.h"
@@ -38,6 +42,7 @@ class BasicBlock;
 class BlockFrequency;
 class BlockFrequencyInfo;
 class BranchProbabilityInfo;
+class Constant;
 class DominatorTree;
 class Function;
 class Instruction;
@@ -92,6 +97,8 @@ private:
   ValueSet StackAllocas;
   llvm::SmallVector<llvm::Value *, 8> StackAllocaInits;
   ValueSet PureInputs;
+  DenseMap<Value *, Constant *> PrivateReductions;
+  DenseMap<Value *, Value *> InputReplacements;
 
   // Bits of intermediate state computed at various phases of extraction.
   SetVector<BasicBlock *> Blocks;
@@ -99,6 +106,9 @@ private:
   SmallVector<BasicBlock *, 32> CloneBlocks;
   unsigned NumExitBlocks = std::numeric_limits<unsigned>::max();
   Type *RetTy;
+  AggregateLayoutSpec ArgLayout;
+  SmallVector<ArgPassing, 8> OutputPassing;
+  SmallVector<int, 8> OutputReturnIndex;
 
   bool isBidirectional(const llvm::Value *V) {
     return IsBidirectional(V, OutputToInputMap);
@@ -163,8 +173,22 @@ public:
     }
   }
 
+  ArrayRef<BasicBlock *> getBlocks() const { return Blocks.getArrayRef(); }
+
+  bool hasStackAllocas() const { return !StackAllocas.empty(); }
+
   void setAccesses(MemAccInstVisitor *Accesses) { this->Accesses = Accesses; }
 
+  MemAccInstVisitor *getAccesses() const { return Accesses; }
+
+  /// Set the bidirectional inputs that are reductions to privatize in the
+  /// extracted function, along with their identity values. Such a reduction
+  /// starts from its identity value and the extracted function only produces
+  /// the partial result.
+  void setPrivateReductions(const DenseMap<Value *, Constant *> &Reductions) {
+    PrivateReductions = Reductions;
+  }
+
   const ValueSet &getPureInputs() {
     PureInputs.clear();
 
@@ -179,6 +203,37 @@ public:
 
   const ValueSet &getOutputs() const { return Outputs; }
 
+  /// Return the input that carries the value of a bidirectional output into
+  /// the region or null if the output is not bidirectional.
+  Value *getBidirectionalInput(Value *Output) const {
+    auto found = OutputToInputMap.find(Output);
+    return found != OutputToInputMap.end() ? found->second : nullptr;
+  }
+
+  /// Return the value that stands for a value of the region in the last
+  /// extracted function, which is either its clone or what replaced an input,
+  /// or null if there is none.
+  Value *getClonedValue(Value *V) const {
+    if (Value *clone = VMap.lookup(V))
+      return clone;
+
+    return InputReplacements.lookup(V);
+  }
+
+  /// Return the layout of the aggregated arguments of the last extracted
+  /// function or null if arguments are not aggregated.
+  const AggregateLayoutSpec *getAggregateLayout() const {
+    return AggregateArgs ? &ArgLayout : nullptr;
+  }
+
+  /// Return how the output at the given position is passed to and from the
+  /// last extracted function.
+  ArgPassing getOutputPassing(size_t Idx) const { return OutputPassing[Idx]; }
+
+  /// Return the position of the output in the struct returned by the last
+  /// extracted function or -1 if it is not returned.
+  int getOutputReturnIndex(size_t Idx) const { return OutputReturnIndex[Idx]; }
+
   /// Compute the set of input values and output values for the code.
   ///
   /// These can be used either when performing the extraction or to evaluate
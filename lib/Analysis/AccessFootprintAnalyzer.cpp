@@ -0,0 +1,278 @@
+//
+//
+//
+
+#include "Atrox/Analysis/AccessFootprintAnalyzer.hpp"
+
+#include "Atrox/Analysis/LoopBoundsAnalyzer.hpp"
+
+#include "llvm/Analysis/ScalarEvolution.h"
+// using llvm::ScalarEvolution
+// using llvm::SCEV
+
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
+// using llvm::SCEVAddRecExpr
+// using llvm::SCEVAddExpr
+// using llvm::SCEVMulExpr
+// using llvm::SCEVConstant
+// using llvm::SCEVCouldNotCompute
+// using llvm::SCEVExprContains
+
+#include "llvm/Analysis/LoopInfo.h"
+// using llvm::Loop
+
+#include "llvm/IR/DataLayout.h"
+// using llvm::DataLayout
+
+#include "llvm/IR/Instructions.h"
+// using llvm::LoadInst
+// using llvm::StoreInst
+
+#include "llvm/ADT/APInt.h"
+// using llvm::APInt
+
+#include "llvm/Support/raw_ostream.h"
+// using llvm::raw_string_ostream
+
+#include "llvm/Support/Debug.h"
+// using LLVM_DEBUG macro
+// using llvm::dbgs
+
+#include <algorithm>
+// using std::max
+// using std::find
+
+#include <string>
+// using std::string
+
+#define DEBUG_TYPE "atrox-footprint"
+
+namespace {
+
+// whether the expression involves add recurrences of loops nested in the
+// given loop
+bool InvolvesInnerLoops(const llvm::SCEV *S, const llvm::Loop &L) {
+  return llvm::SCEVExprContains(S, [&L](const llvm::SCEV *E) {
+    if (auto *ar = llvm::dyn_cast<llvm::SCEVAddRecExpr>(E)) {
+      return ar->getLoop() != &L && L.contains(ar->getLoop());
+    }
+
+    return false;
+  });
+}
+
+void CollectStrides(
+    const llvm::SCEV *S,
+    llvm::SmallVectorImpl<std::pair<const llvm::Loop *, const llvm::SCEV *>>
+        &Strides,
+    llvm::ScalarEvolution &SE) {
+  if (auto *ar = llvm::dyn_cast<llvm::SCEVAddRecExpr>(S)) {
+    auto stride = std::make_pair(ar->getLoop(), ar->getStepRecurrence(SE));
+
+    if (Strides.end() == std::find(Strides.begin(), Strides.end(), stride)) {
+      Strides.push_back(stride);
+    }
+
+    CollectStrides(ar->getStart(), Strides, SE);
+  } else if (auto *add = llvm::dyn_cast<llvm::SCEVAddExpr>(S)) {
+    for (auto *op : add->operands()) {
+      CollectStrides(op, Strides, SE);
+    }
+  }
+}
+
+std::string Render(const llvm::SCEV *S) {
+  std::string str;
+  llvm::raw_string_ostream os{str};
+  S->print(os);
+
+  return os.str();
+}
+
+} // namespace
+
+namespace atrox {
+
+const llvm::SCEV *
+AccessFootprintAnalyzer::getMaxBackedgeTakenCount(const llvm::Loop *L) const {
+  auto *btc = SE->getBackedgeTakenCount(L);
+  if (!llvm::isa<llvm::SCEVCouldNotCompute>(btc)) {
+    return btc;
+  }
+
+  btc = SE->getMaxBackedgeTakenCount(L);
+  if (!llvm::isa<llvm::SCEVCouldNotCompute>(btc)) {
+    return btc;
+  }
+
+  if (LBA) {
+    auto info = LBA->getInfo(const_cast<llvm::Loop *>(L));
+
+    if (info && info->TripCount) {
+      return SE->getConstant(llvm::APInt{64, info->TripCount - 1});
+    }
+  }
+
+  return nullptr;
+}
+
+const llvm::SCEV *AccessFootprintAnalyzer::getExtreme(const llvm::SCEV *S,
+                                                      const llvm::Loop &L,
+                                                      bool Max) const {
+  if (!InvolvesInnerLoops(S, L)) {
+    return S;
+  }
+
+  if (auto *ar = llvm::dyn_cast<llvm::SCEVAddRecExpr>(S)) {
+    if (ar->getLoop() == &L || !L.contains(ar->getLoop()) || !ar->isAffine()) {
+      return nullptr;
+    }
+
+    auto *step = ar->getStepRecurrence(*SE);
+    if (InvolvesInnerLoops(step, L)) {
+      return nullptr;
+    }
+
+    bool isIncreasing = SE->isKnownNonNegative(step);
+    if (!isIncreasing && !SE->isKnownNonPositive(step)) {
+      return nullptr;
+    }
+
+    auto *start = getExtreme(ar->getStart(), L, Max);
+    if (!start || Max != isIncreasing) {
+      return start;
+    }
+
+    auto *btc = getMaxBackedgeTakenCount(ar->getLoop());
+    // the trip count of an inner loop might depend on its outer loops
+    btc = btc ? getExtreme(btc, L, true) : nullptr;
+
+    if (!btc) {
+      return nullptr;
+    }
+
+    btc = SE->getTruncateOrZeroExtend(btc, step->getType());
+
+    return SE->getAddExpr(start, SE->getMulExpr(step, btc));
+  }
+
+  if (auto *add = llvm::dyn_cast<llvm::SCEVAddExpr>(S)) {
+    llvm::SmallVector<const llvm::SCEV *, 4> ops;
+
+    for (auto *op : add->operands()) {
+      auto *e = getExtreme(op, L, Max);
+      if (!e) {
+        return nullptr;
+      }
+
+      ops.push_back(e);
+    }
+
+    return SE->getAddExpr(ops);
+  }
+
+  if (auto *mul = llvm::dyn_cast<llvm::SCEVMulExpr>(S)) {
+    auto *c = llvm::dyn_cast<llvm::SCEVConstant>(mul->getOperand(0));
+
+    if (c && mul->getNumOperands() == 2) {
+      bool isNegative = c->getAPInt().isNegative();
+      auto *e = getExtreme(mul->getOperand(1), L, isNegative ? !Max : Max);
+
+      return e ? SE->getMulExpr(c, e) : nullptr;
+    }
+  }
+
+  if (auto *sext = llvm::dyn_cast<llvm::SCEVSignExtendExpr>(S)) {
+    auto *e = getExtreme(sext->getOperand(), L, Max);
+
+    return e ? SE->getSignExtendExpr(e, S->getType()) : nullptr;
+  }
+
+  if (auto *zext = llvm::dyn_cast<llvm::SCEVZeroExtendExpr>(S)) {
+    auto *e = getExtreme(zext->getOperand(), L, Max);
+
+    return e ? SE->getZeroExtendExpr(e, S->getType()) : nullptr;
+  }
+
+  return nullptr;
+}
+
+llvm::Optional<AccessFootprint>
+AccessFootprintAnalyzer::analyze(llvm::Loop &L, llvm::Value *Ptr,
+                                 llvm::ArrayRef<MemAccInst> Accesses) {
+  if (!Ptr->getType()->isPointerTy()) {
+    return llvm::None;
+  }
+
+  auto *base = SE->getPointerBase(SE->getSCEV(Ptr));
+  llvm::Optional<AccessFootprint> fp;
+
+  for (auto e : Accesses) {
+    bool isLoad = llvm::isa<llvm::LoadInst>(e.get());
+
+    if (!isLoad && !llvm::isa<llvm::StoreInst>(e.get())) {
+      // the extent of other accesses to the same object is not known
+      for (auto &op : e.get()->operands()) {
+        if (op->getType()->isPointerTy() &&
+            SE->getPointerBase(SE->getSCEV(op)) == base) {
+          LLVM_DEBUG(llvm::dbgs() << "unknown extent of access: " << *e.get()
+                                  << '\n';);
+          return llvm::None;
+        }
+      }
+
+      continue;
+    }
+
+    auto *ptr = SE->getSCEV(e.getPointerOperand());
+    if (SE->getPointerBase(ptr) != base) {
+      continue;
+    }
+
+    auto *offset = SE->getMinusSCEV(ptr, base);
+    auto *minOffset = getExtreme(offset, L, false);
+    auto *maxOffset = getExtreme(offset, L, true);
+
+    if (!minOffset || !maxOffset) {
+      LLVM_DEBUG(llvm::dbgs() << "cannot bound offset: " << *offset << '\n';);
+      return llvm::None;
+    }
+
+    auto *ty = isLoad ? e.get()->getType() : e.getValueOperand()->getType();
+    uint64_t size = DL->getTypeStoreSize(ty);
+
+    if (!fp) {
+      fp = AccessFootprint{base, minOffset, maxOffset, size, {}};
+    } else {
+      fp->MinOffset = SE->getSMinExpr(fp->MinOffset, minOffset);
+      fp->MaxOffset = SE->getSMaxExpr(fp->MaxOffset, maxOffset);
+      fp->ElementSize = std::max(fp->ElementSize, size);
+    }
+
+    CollectStrides(offset, fp->Strides, *SE);
+  }
+
+  return fp;
+}
+
+llvm::Optional<AccessFootprintSpec>
+AccessFootprintAnalyzer::getSpec(llvm::Loop &L, llvm::Value *Ptr,
+                                 llvm::ArrayRef<MemAccInst> Accesses) {
+  auto fp = analyze(L, Ptr, Accesses);
+
+  if (!fp) {
+    return llvm::None;
+  }
+
+  AccessFootprintSpec spec{Render(fp->Base), Render(fp->MinOffset),
+                           Render(fp->MaxOffset), fp->ElementSize, {}};
+
+  for (const auto &e : fp->Strides) {
+    spec.Strides.push_back(
+        {e.first->getHeader()->getName().str(), Render(e.second)});
+  }
+
+  return spec;
+}
+
+} // namespace atrox
@@ -0,0 +1,202 @@
+//
+//
+//
+
+#include "Atrox/Analysis/AccessPatternAnalyzer.hpp"
+
+#include "llvm/Analysis/ScalarEvolution.h"
+// using llvm::ScalarEvolution
+// using llvm::SCEV
+
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
+// using llvm::SCEVAddRecExpr
+// using llvm::SCEVConstant
+// using llvm::SCEVUnknown
+// using llvm::visitAll
+
+#include "llvm/Analysis/LoopInfo.h"
+// using llvm::Loop
+
+#include "llvm/IR/DataLayout.h"
+// using llvm::DataLayout
+
+#include "llvm/IR/Instructions.h"
+// using llvm::LoadInst
+// using llvm::StoreInst
+
+#include "llvm/ADT/SmallPtrSet.h"
+// using llvm::SmallPtrSet
+
+#include "llvm/ADT/SmallVector.h"
+// using llvm::SmallVector
+
+#include "llvm/Support/Debug.h"
+// using LLVM_DEBUG macro
+// using llvm::dbgs
+
+#include <algorithm>
+// using std::min
+// using std::max
+
+#include <cassert>
+// using assert
+
+#define DEBUG_TYPE "atrox-access-pattern"
+
+namespace {
+
+// collects the parts of an expression that vary in a loop
+struct VaryingTermsCollector {
+  const llvm::Loop &L;
+  llvm::SmallVector<const llvm::SCEVAddRecExpr *, 4> Recurrences;
+  bool HasLoadedValues = false;
+  bool HasOtherValues = false;
+
+  explicit VaryingTermsCollector(const llvm::Loop &L) : L(L) {}
+
+  bool follow(const llvm::SCEV *S) {
+    if (auto *ar = llvm::dyn_cast<llvm::SCEVAddRecExpr>(S)) {
+      if (L.contains(ar->getLoop())) {
+        Recurrences.push_back(ar);
+      }
+    } else if (auto *u = llvm::dyn_cast<llvm::SCEVUnknown>(S)) {
+      auto *i = llvm::dyn_cast<llvm::Instruction>(u->getValue());
+
+      if (i && L.contains(i)) {
+        (llvm::isa<llvm::LoadInst>(i) ? HasLoadedValues : HasOtherValues) =
+            true;
+      }
+    }
+
+    return true;
+  }
+
+  bool isDone() const { return false; }
+};
+
+atrox::AccessPatternSpec Merge(const atrox::AccessPatternSpec &S1,
+                               const atrox::AccessPatternSpec &S2) {
+  auto pattern = std::max(S1.Pattern, S2.Pattern);
+  auto confidence = std::min(S1.Confidence, S2.Confidence);
+
+  if (S1.Pattern != S2.Pattern) {
+    confidence = std::min(confidence, atrox::AccessConfidence::Medium);
+  }
+
+  return {pattern, confidence};
+}
+
+} // namespace
+
+namespace atrox {
+
+AccessPatternSpec
+AccessPatternAnalyzer::classifyOffset(const llvm::SCEV *Offset, uint64_t Size,
+                                      const llvm::Loop &L) const {
+  if (SE->isLoopInvariant(Offset, &L)) {
+    return {AccessPattern::Invariant, AccessConfidence::High};
+  }
+
+  VaryingTermsCollector vtc{L};
+  llvm::visitAll(Offset, vtc);
+
+  if (vtc.HasLoadedValues) {
+    return {AccessPattern::Indirect, vtc.HasOtherValues
+                                         ? AccessConfidence::Medium
+                                         : AccessConfidence::High};
+  }
+
+  if (vtc.HasOtherValues || vtc.Recurrences.empty()) {
+    return {AccessPattern::Irregular, AccessConfidence::Low};
+  }
+
+  llvm::SmallPtrSet<const llvm::Loop *, 4> loops;
+  bool hasConstantSteps = true;
+
+  for (auto *e : vtc.Recurrences) {
+    if (!e->isAffine()) {
+      return {AccessPattern::Irregular, AccessConfidence::Medium};
+    }
+
+    loops.insert(e->getLoop());
+    hasConstantSteps &=
+        llvm::isa<llvm::SCEVConstant>(e->getStepRecurrence(*SE));
+  }
+
+  auto confidence =
+      hasConstantSteps ? AccessConfidence::High : AccessConfidence::Medium;
+
+  if (loops.size() > 1) {
+    return {AccessPattern::MultiDimAffine, confidence};
+  }
+
+  auto *step = llvm::dyn_cast<llvm::SCEVConstant>(
+      vtc.Recurrences.front()->getStepRecurrence(*SE));
+
+  if (step && step->getAPInt().abs() == Size) {
+    return {AccessPattern::UnitStride, confidence};
+  }
+
+  return {AccessPattern::Strided, confidence};
+}
+
+llvm::Optional<AccessPatternSpec>
+AccessPatternAnalyzer::classify(llvm::Loop &L, llvm::Value *Ptr,
+                                llvm::ArrayRef<MemAccInst> Accesses) const {
+  if (!Ptr->getType()->isPointerTy()) {
+    return llvm::None;
+  }
+
+  auto *base = SE->getPointerBase(SE->getSCEV(Ptr));
+  llvm::Optional<AccessPatternSpec> result;
+
+  auto update = [&result](const AccessPatternSpec &Spec) {
+    result = result ? Merge(*result, Spec) : Spec;
+  };
+
+  for (auto e : Accesses) {
+    bool isLoad = llvm::isa<llvm::LoadInst>(e.get());
+
+    if (!isLoad && !llvm::isa<llvm::StoreInst>(e.get())) {
+      for (auto &op : e.get()->operands()) {
+        if (op->getType()->isPointerTy() &&
+            SE->getPointerBase(SE->getSCEV(op)) == base) {
+          update({AccessPattern::Irregular, AccessConfidence::Low});
+          break;
+        }
+      }
+
+      continue;
+    }
+
+    auto *ptr = SE->getSCEV(e.getPointerOperand());
+    if (SE->getPointerBase(ptr) != base) {
+      continue;
+    }
+
+    auto *ty = isLoad ? e.get()->getType() : e.getValueOperand()->getType();
+    auto spec = classifyOffset(SE->getMinusSCEV(ptr, base),
+                               DL->getTypeStoreSize(ty), L);
+
+    LLVM_DEBUG(llvm::dbgs() << "access pattern " << toString(spec.Pattern)
+                            << " for: " << *e.get() << '\n';);
+
+    update(spec);
+  }
+
+  return result;
+}
+
+AccessPatternSpec
+AccessPatternAnalyzer::classifyAccess(const llvm::Loop &L,
+                                      MemAccInst Access) const {
+  assert((llvm::isa<llvm::LoadInst>(Access.get()) ||
+          llvm::isa<llvm::StoreInst>(Access.get())) &&
+         "Access must be a load or a store!");
+
+  return classifyOffset(
+      SE->getSCEV(Access.getPointerOperand()),
+      DL->getTypeStoreSize(Access.getValueOperand()->getType()), L);
+}
+
+} // namespace atrox
@@ -0,0 +1,215 @@
+//
+//
+//
+
+#include "Atrox/Analysis/ArrayDelinearizer.hpp"
+
+#include "Atrox/Transforms/DecomposeMultiDimArrayRefs.hpp"
+
+#include "llvm/Config/llvm-config.h"
+// using LLVM_VERSION_MAJOR
+
+#include "llvm/Analysis/ScalarEvolution.h"
+// using llvm::ScalarEvolution
+// using llvm::SCEV
+
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
+// using llvm::SCEVUnknown
+// using llvm::SCEVConstant
+
+#if LLVM_VERSION_MAJOR >= 13
+#include "llvm/Analysis/Delinearization.h"
+// using llvm::delinearize
+#endif
+
+#include "llvm/Analysis/LoopInfo.h"
+// using llvm::LoopInfo
+
+#include "llvm/IR/Instructions.h"
+// using llvm::LoadInst
+// using llvm::StoreInst
+
+#include "llvm/IR/Operator.h"
+// using llvm::GEPOperator
+
+#include "llvm/IR/Module.h"
+// using llvm::Module
+
+#include "llvm/IR/DataLayout.h"
+// using llvm::DataLayout
+
+#include "llvm/Support/raw_ostream.h"
+// using llvm::raw_string_ostream
+
+#include "llvm/Support/Debug.h"
+// using LLVM_DEBUG macro
+// using llvm::dbgs
+
+#include "llvm/ADT/DenseMap.h"
+// using llvm::DenseMap
+
+#include <iterator>
+// using std::prev
+
+#include <string>
+// using std::string
+// using std::to_string
+
+#define DEBUG_TYPE "atrox-array-delinearizer"
+
+namespace atrox {
+
+const llvm::SCEV *
+DelinearizedAccess::getRowOffset(llvm::ScalarEvolution &SE) const {
+  const llvm::SCEV *offset = SE.getZero(Subscripts.back()->getType());
+  const llvm::SCEV *stride = SE.getOne(Subscripts.back()->getType());
+
+  for (auto i = Subscripts.size() - 1; i > 0; --i) {
+    stride = SE.getMulExpr(stride, Sizes[i - 1]);
+    offset = SE.getAddExpr(offset, SE.getMulExpr(Subscripts[i - 1], stride));
+  }
+
+  return offset;
+}
+
+bool DelinearizeAccess(llvm::ScalarEvolution &SE, llvm::LoopInfo &LI,
+                       llvm::Instruction &Access, DelinearizedAccess &Result) {
+  if (!llvm::isa<llvm::LoadInst>(Access) &&
+      !llvm::isa<llvm::StoreInst>(Access)) {
+    return false;
+  }
+
+  auto *ptr = MemAccInst::cast(Access).getPointerOperand();
+  auto *fn = SE.getSCEVAtScope(ptr, LI.getLoopFor(Access.getParent()));
+  auto *base = llvm::dyn_cast<llvm::SCEVUnknown>(SE.getPointerBase(fn));
+
+  if (!base) {
+    return false;
+  }
+
+  fn = SE.getMinusSCEV(fn, base);
+  auto *elementSize = SE.getElementSize(&Access);
+
+  llvm::SmallVector<const llvm::SCEV *, 4> subscripts, sizes;
+
+#if LLVM_VERSION_MAJOR >= 13
+  llvm::delinearize(SE, fn, subscripts, sizes, elementSize);
+#else
+  SE.delinearize(fn, subscripts, sizes, elementSize);
+#endif
+
+  if (subscripts.size() < 2 || sizes.size() != subscripts.size()) {
+    return false;
+  }
+
+  Result.Base = base->getValue();
+  Result.ElementSize = elementSize;
+  Result.Subscripts.assign(subscripts.begin(), subscripts.end());
+  Result.Sizes.assign(sizes.begin(), std::prev(sizes.end()));
+
+  // the division by the dimension sizes might leave a remainder
+  auto *linear = SE.getAddExpr(Result.getRowOffset(SE), subscripts.back());
+  auto *bytes = SE.getMulExpr(
+      linear, SE.getTruncateOrZeroExtend(elementSize, linear->getType()));
+
+  if (bytes != SE.getTruncateOrSignExtend(fn, bytes->getType())) {
+    LLVM_DEBUG(llvm::dbgs() << "delinearized subscripts do not match: " << *fn
+                            << '\n';);
+    return false;
+  }
+
+  LLVM_DEBUG({
+    llvm::dbgs() << "delinearized: " << Access << "\nsubscripts:";
+    for (auto *e : Result.Subscripts) {
+      llvm::dbgs() << ' ' << *e;
+    }
+    llvm::dbgs() << "\nsizes:";
+    for (auto *e : Result.Sizes) {
+      llvm::dbgs() << ' ' << *e;
+    }
+    llvm::dbgs() << '\n';
+  });
+
+  return true;
+}
+
+void GetArrayShapes(llvm::ScalarEvolution &SE, llvm::LoopInfo &LI,
+                    llvm::ArrayRef<MemAccInst> Accesses,
+                    std::vector<ArrayShapeSpec> &Shapes) {
+  auto toString = [](const llvm::Value *V, const llvm::SCEV *S) {
+    std::string str;
+    llvm::raw_string_ostream os(str);
+
+    if (S) {
+      S->print(os);
+    } else if (V) {
+      V->printAsOperand(os, false);
+    }
+
+    return os.str();
+  };
+
+  llvm::DenseMap<const llvm::Value *, size_t> shapeIndices;
+
+  auto addShape = [&](const llvm::Value *Array, ArrayShapeSpec Shape) {
+    auto found = shapeIndices.find(Array);
+
+    if (found != shapeIndices.end()) {
+      ++Shapes[found->second].Accesses;
+      return;
+    }
+
+    shapeIndices.insert({Array, Shapes.size()});
+    Shapes.push_back(std::move(Shape));
+  };
+
+  for (auto e : Accesses) {
+    auto *ptr = e.getPointerOperand();
+
+    if (!ptr) {
+      continue;
+    }
+
+    llvm::SmallVector<uint64_t, 8> sizes;
+    auto *gep = llvm::dyn_cast<llvm::GEPOperator>(ptr);
+    auto *arrayTy = gep ? llvm::dyn_cast<llvm::PointerType>(
+                              gep->getPointerOperandType())
+                        : nullptr;
+
+    GetDecomposedArraySizes(arrayTy, sizes);
+
+    if (sizes.size() > 1) {
+      auto &DL = e->getModule()->getDataLayout();
+      auto *elementTy = GetDecomposedMultiDimArrayType(arrayTy);
+      ArrayShapeSpec shape{toString(gep->getPointerOperand(), nullptr), true,
+                           {}, DL.getTypeAllocSize(elementTy), 1};
+
+      for (auto s : sizes) {
+        shape.Sizes.push_back(std::to_string(s));
+      }
+
+      addShape(gep->getPointerOperand(), std::move(shape));
+      continue;
+    }
+
+    DelinearizedAccess access;
+
+    if (!DelinearizeAccess(SE, LI, *e.get(), access)) {
+      continue;
+    }
+
+    auto *elementSize = llvm::dyn_cast<llvm::SCEVConstant>(access.ElementSize);
+    ArrayShapeSpec shape{toString(access.Base, nullptr), false, {""},
+                         elementSize ? elementSize->getValue()->getZExtValue()
+                                     : 0,
+                         1};
+
+    for (auto *s : access.Sizes) {
+      shape.Sizes.push_back(toString(nullptr, s));
+    }
+
+    addShape(access.Base, std::move(shape));
+  }
+}
+
+} // namespace atrox
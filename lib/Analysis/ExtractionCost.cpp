@@ -0,0 +1,63 @@
+//
+//
+//
+
+#include "Atrox/Analysis/ExtractionCost.hpp"
+
+#include "Atrox/Analysis/PayloadWeights.hpp"
+
+#include "Atrox/Analysis/PayloadIntensity.hpp"
+
+#include "Atrox/Analysis/LoopBoundsAnalyzer.hpp"
+
+#include "llvm/Analysis/LoopInfo.h"
+// using llvm::Loop
+// using llvm::LoopInfo
+
+#include "llvm/IR/BasicBlock.h"
+// using llvm::BasicBlock
+
+#include "llvm/ADT/SmallVector.h"
+// using llvm::SmallVector
+
+#include "llvm/Support/Debug.h"
+// using LLVM_DEBUG macro
+// using llvm::dbgs
+
+#define DEBUG_TYPE "atrox-extraction-cost"
+
+namespace atrox {
+
+ExtractionCost
+CalculateExtractionCost(llvm::ArrayRef<llvm::BasicBlock *> Blocks,
+                        unsigned LiveIns, const llvm::Loop &L,
+                        const llvm::LoopInfo &LI,
+                        const LoopBoundsAnalyzer *LBA,
+                        const llvm::TargetTransformInfo *TTI) {
+  ExtractionCost ec;
+  ec.LiveIns = LiveIns;
+  ec.Model = TTI ? PayloadCostModel::TTI : PayloadCostModel::Table;
+  ec.CallOverhead =
+      CalculateCallWeight(LiveIns, L.getHeader()->getContext(), TTI);
+
+  llvm::SmallVector<llvm::BasicBlock *, 32> blocks{Blocks.begin(),
+                                                   Blocks.end()};
+
+  for (const auto &e : CalculatePayloadWeight(blocks, TTI)) {
+    ec.PayloadWeight +=
+        e.second * GetBlockMultiplier(e.first, L, LI, LBA, ec.IsExact);
+  }
+
+  if (LBA) {
+    if (auto info = LBA->getInfo(const_cast<llvm::Loop *>(&L))) {
+      ec.TripCount = info->TripCount;
+    }
+  }
+
+  LLVM_DEBUG(llvm::dbgs() << "payload weight: " << ec.PayloadWeight
+                          << " call overhead: " << ec.CallOverhead << '\n';);
+
+  return ec;
+}
+
+} // namespace atrox
@@ -0,0 +1,173 @@
+//
+//
+//
+
+#include "Atrox/Analysis/FieldDensityAnalyzer.hpp"
+
+#include "llvm/IR/Function.h"
+// using llvm::Function
+// using llvm::Argument
+
+#include "llvm/IR/Module.h"
+// using llvm::Module
+
+#include "llvm/IR/DataLayout.h"
+// using llvm::DataLayout
+// using llvm::StructLayout
+
+#include "llvm/IR/DerivedTypes.h"
+// using llvm::StructType
+
+#include "llvm/IR/Instructions.h"
+// using llvm::GetElementPtrInst
+// using llvm::LoadInst
+// using llvm::StoreInst
+
+#include "llvm/IR/Constants.h"
+// using llvm::ConstantInt
+
+#include "llvm/ADT/DenseMap.h"
+// using llvm::DenseMap
+
+#include "llvm/Support/raw_ostream.h"
+// using llvm::raw_string_ostream
+
+#include "llvm/Support/Debug.h"
+// using LLVM_DEBUG macro
+// using llvm::dbgs
+
+#include <map>
+// using std::map
+
+#include <iterator>
+// using std::next
+
+#define DEBUG_TYPE "atrox-field-density"
+
+namespace {
+
+struct FieldUseCounts {
+  unsigned Reads = 0;
+  unsigned Writes = 0;
+};
+
+// counts the accesses through a field address, which must not be used to
+// reach outside of the field
+bool CountFieldUses(llvm::Value *V, FieldUseCounts &Counts) {
+  for (auto *u : V->users()) {
+    if (llvm::isa<llvm::LoadInst>(u)) {
+      ++Counts.Reads;
+    } else if (auto *st = llvm::dyn_cast<llvm::StoreInst>(u)) {
+      if (st->getValueOperand() == V) {
+        return false;
+      }
+
+      ++Counts.Writes;
+    } else if (auto *gep = llvm::dyn_cast<llvm::GetElementPtrInst>(u)) {
+      auto *first = llvm::dyn_cast<llvm::ConstantInt>(*gep->idx_begin());
+
+      if (gep->getPointerOperand() != V || !first || !first->isZero() ||
+          !CountFieldUses(gep, Counts)) {
+        return false;
+      }
+    } else {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+} // namespace
+
+namespace atrox {
+
+bool GetStructArgAccesses(llvm::Argument &A, StructArgAccesses &Result) {
+  Result = StructArgAccesses{};
+
+  if (!A.getType()->isPointerTy()) {
+    return false;
+  }
+
+  for (auto *u : A.users()) {
+    auto *gep = llvm::dyn_cast<llvm::GetElementPtrInst>(u);
+    auto *ty = gep ? llvm::dyn_cast<llvm::StructType>(
+                         gep->getSourceElementType())
+                   : nullptr;
+
+    if (!ty || gep->getPointerOperand() != &A ||
+        (Result.Ty && Result.Ty != ty)) {
+      Result.IsConvertible = false;
+      continue;
+    }
+
+    Result.Ty = ty;
+
+    if (gep->getNumIndices() < 2 ||
+        !llvm::isa<llvm::ConstantInt>(*std::next(gep->idx_begin()))) {
+      Result.IsConvertible = false;
+      continue;
+    }
+
+    FieldUseCounts counts;
+    if (!CountFieldUses(gep, counts)) {
+      Result.IsConvertible = false;
+    }
+
+    Result.GEPs.push_back(gep);
+  }
+
+  return Result.Ty != nullptr;
+}
+
+void AnalyzeFieldDensity(llvm::Function &Payload,
+                         std::vector<FieldDensitySpec> &Specs) {
+  const auto &DL = Payload.getParent()->getDataLayout();
+
+  for (auto &arg : Payload.args()) {
+    StructArgAccesses accesses;
+
+    if (!GetStructArgAccesses(arg, accesses) || accesses.Ty->isOpaque()) {
+      continue;
+    }
+
+    auto *ty = accesses.Ty;
+    auto *sl = DL.getStructLayout(ty);
+    std::map<unsigned, FieldUseCounts> fields;
+
+    for (auto *e : accesses.GEPs) {
+      auto field = llvm::cast<llvm::ConstantInt>(*std::next(e->idx_begin()))
+                       ->getZExtValue();
+
+      CountFieldUses(e, fields[field]);
+    }
+
+    std::string name;
+    llvm::raw_string_ostream os(name);
+    ty->print(os, false, true);
+
+    FieldDensitySpec spec{arg.getName().str(),
+                          os.str(),
+                          DL.getTypeAllocSize(ty),
+                          ty->getNumElements(),
+                          {},
+                          0,
+                          accesses.IsConvertible};
+
+    for (const auto &e : fields) {
+      auto size = DL.getTypeAllocSize(ty->getElementType(e.first));
+
+      spec.Fields.push_back({e.first, sl->getElementOffset(e.first), size,
+                             e.second.Reads, e.second.Writes});
+      spec.UsedBytes += size;
+    }
+
+    LLVM_DEBUG(llvm::dbgs() << "argument " << arg.getName() << " uses "
+                            << spec.UsedBytes << " of " << spec.Size
+                            << " bytes of " << spec.Type << '\n';);
+
+    Specs.push_back(std::move(spec));
+  }
+}
+
+} // namespace atrox
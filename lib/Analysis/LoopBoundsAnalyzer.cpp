@@ -25,6 +25,7 @@
 
 #include "llvm/Support/raw_ostream.h"
 // using llvm::raw_ostream
+// using llvm::raw_string_ostream
 
 #include "llvm/Support/Debug.h"
 // using LLVM_DEBUG macro
@@ -34,6 +35,9 @@
 #include <map>
 // using std::map
 
+#include <string>
+// using std::string
+
 #include <cassert>
 // using cassert
 
@@ -198,8 +202,18 @@ bool LoopBoundsAnalyzer::analyze(llvm::Loop *CurL) {
     LLVM_DEBUG(llvm::dbgs() << "subloop with header: "
                             << e->getHeader()->getName() << '\n';);
 
-    auto found = LoopBoundsMap.emplace(std::make_pair(
-        e, LoopIterationSpaceInfo{nullptr, nullptr, nullptr, 0u}));
+    auto found = LoopBoundsMap.emplace(
+        std::make_pair(e, LoopIterationSpaceInfo{}));
+    auto &lisi = found.first->second;
+
+    const auto *btc = SE->getBackedgeTakenCount(e);
+    if (!llvm::isa<llvm::SCEVCouldNotCompute>(btc)) {
+      lisi.BackedgeTakenCount = const_cast<llvm::SCEV *>(btc);
+      LLVM_DEBUG(llvm::dbgs() << "backedge taken count: " << *btc << '\n';);
+    }
+
+    lisi.TripCount = SE->getSmallConstantMaxTripCount(e);
+    LLVM_DEBUG(llvm::dbgs() << "max trip count: " << lisi.TripCount << '\n';);
 
     // induction variable
     if (auto *ind = GetInductionVariable(e, SE)) {
@@ -214,20 +228,18 @@ bool LoopBoundsAnalyzer::analyze(llvm::Loop *CurL) {
         continue;
       }
 
-      auto &lisi = found.first->second;
-
       lisi.InductionVariable = ind;
       lisi.Start = const_cast<llvm::SCEV *>(indAR->getStart());
       LLVM_DEBUG(llvm::dbgs() << "induction start: " << *lisi.Start << '\n';);
 
-      lisi.End = const_cast<llvm::SCEV *>(indAR->getStart());
-      LLVM_DEBUG(llvm::dbgs() << "induction end: " << *lisi.End << '\n';);
-      // lisi.End = const_cast<llvm::SCEV *>(
-      // indAR->evaluateAtIteration(SE->getConstant(llvm::APInt{64, 5}), *SE));
-      // LLVM_DEBUG(llvm::dbgs() << "induction end: " << *lisi.End << '\n';);
+      if (lisi.BackedgeTakenCount && !ind->getType()->isFloatingPointTy()) {
+        auto *ty = SE->getEffectiveSCEVType(indAR->getType());
+        auto *it = SE->getTruncateOrZeroExtend(lisi.BackedgeTakenCount, ty);
 
-      lisi.TripCount = SE->getSmallConstantMaxTripCount(e);
-      LLVM_DEBUG(llvm::dbgs() << "trip count: " << lisi.TripCount << '\n';);
+        lisi.End =
+            const_cast<llvm::SCEV *>(indAR->evaluateAtIteration(it, *SE));
+        LLVM_DEBUG(llvm::dbgs() << "induction end: " << *lisi.End << '\n';);
+      }
     }
   }
 
@@ -341,15 +353,59 @@ LoopBoundsAnalyzer::getInfo(llvm::Value *IndVar) const {
   return llvm::None;
 }
 
+llvm::Optional<LoopBoundsSpec>
+LoopBoundsAnalyzer::getSpec(llvm::Loop *L) const {
+  auto found = LoopBoundsMap.find(L);
+  if (found == LoopBoundsMap.end()) {
+    return llvm::None;
+  }
+
+  auto toString = [](const llvm::Value *V, const llvm::SCEV *S) {
+    std::string str;
+    llvm::raw_string_ostream os(str);
+
+    if (S) {
+      S->print(os);
+    } else if (V) {
+      V->printAsOperand(os, false);
+    }
+
+    return os.str();
+  };
+
+  const auto &info = found->second;
+
+  return LoopBoundsSpec{L->getHeader()->getName().str(),
+                        toString(info.InductionVariable, nullptr),
+                        toString(nullptr, info.Start),
+                        toString(nullptr, info.End),
+                        toString(nullptr, info.BackedgeTakenCount),
+                        info.TripCount};
+}
+
 void LoopBoundsAnalyzer::print(llvm::raw_ostream &OS) const {
   for (auto &e : LoopBoundsMap) {
     OS << "loop with header: " << e.first->getHeader()->getName() << '\n';
-    OS << "start: ";
-    e.second.Start->print(OS);
-    OS << '\n';
-    OS << "end: ";
-    e.second.End->print(OS);
-    OS << '\n';
+
+    if (e.second.Start) {
+      OS << "start: ";
+      e.second.Start->print(OS);
+      OS << '\n';
+    }
+
+    if (e.second.End) {
+      OS << "end: ";
+      e.second.End->print(OS);
+      OS << '\n';
+    }
+
+    if (e.second.BackedgeTakenCount) {
+      OS << "backedge taken count: ";
+      e.second.BackedgeTakenCount->print(OS);
+      OS << '\n';
+    }
+
+    OS << "max trip count: " << e.second.TripCount << '\n';
   }
 }
 
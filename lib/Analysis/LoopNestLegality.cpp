@@ -0,0 +1,211 @@
+//
+//
+//
+
+#include "Atrox/Analysis/LoopNestLegality.hpp"
+
+#include "llvm/Analysis/DependenceAnalysis.h"
+// using llvm::DependenceInfo
+// using llvm::Dependence
+
+#include "llvm/Analysis/LoopInfo.h"
+// using llvm::Loop
+
+#include "llvm/IR/Constants.h"
+// using llvm::ConstantInt
+
+#include "llvm/IR/InstrTypes.h"
+// using llvm::BinaryOperator
+
+#include "llvm/Support/Debug.h"
+// using LLVM_DEBUG macro
+// using llvm::dbgs
+
+#include <iterator>
+// using std::distance
+
+#define DEBUG_TYPE "atrox-loop-nest"
+
+namespace {
+
+unsigned GetNumPHIs(const llvm::BasicBlock &BB) {
+  return std::distance(BB.phis().begin(), BB.phis().end());
+}
+
+} // namespace
+
+namespace atrox {
+
+llvm::Value *CountedLoopShape::getStart() const {
+  return IndVar->getIncomingValueForBlock(Preheader);
+}
+
+llvm::Optional<CountedLoopShape> MatchCountedLoop(llvm::Loop &L,
+                                                  const llvm::Loop &Scope) {
+  auto *preheader = L.getLoopPreheader();
+  auto *latch = L.getLoopLatch();
+  auto *exiting = L.getExitingBlock();
+
+  if (!preheader || !latch || !exiting || GetNumPHIs(*L.getHeader()) != 1) {
+    return llvm::None;
+  }
+
+  auto *indVar = &*L.getHeader()->phis().begin();
+  auto *inc = llvm::dyn_cast<llvm::BinaryOperator>(
+      indVar->getIncomingValueForBlock(latch));
+  auto *one = inc ? llvm::dyn_cast<llvm::ConstantInt>(inc->getOperand(1))
+                  : nullptr;
+
+  if (!indVar->getType()->isIntegerTy() || !inc ||
+      inc->getOpcode() != llvm::Instruction::Add ||
+      inc->getOperand(0) != indVar || !one || !one->isOne() ||
+      !Scope.isLoopInvariant(indVar->getIncomingValueForBlock(preheader))) {
+    return llvm::None;
+  }
+
+  auto *br = llvm::dyn_cast<llvm::BranchInst>(exiting->getTerminator());
+  auto *cmp = br && br->isConditional()
+                  ? llvm::dyn_cast<llvm::ICmpInst>(br->getCondition())
+                  : nullptr;
+
+  if (!cmp || !cmp->hasOneUse()) {
+    return llvm::None;
+  }
+
+  // a rotated loop tests the next value and a loop that exits from its header
+  // tests the current value
+  llvm::Value *counter = indVar;
+  if (exiting == latch) {
+    counter = inc;
+  }
+
+  auto pred = cmp->getPredicate();
+  unsigned endIndex = 1;
+
+  if (cmp->getOperand(1) == counter) {
+    pred = llvm::ICmpInst::getSwappedPredicate(pred);
+    endIndex = 0;
+  }
+
+  if (cmp->getOperand(1 - endIndex) != counter ||
+      !Scope.isLoopInvariant(cmp->getOperand(endIndex))) {
+    return llvm::None;
+  }
+
+  if (!L.contains(br->getSuccessor(0))) {
+    pred = llvm::ICmpInst::getInversePredicate(pred);
+  }
+
+  bool isSigned;
+
+  switch (pred) {
+  case llvm::ICmpInst::ICMP_SLT:
+    isSigned = true;
+    break;
+  case llvm::ICmpInst::ICMP_ULT:
+    isSigned = false;
+    break;
+  case llvm::ICmpInst::ICMP_NE:
+    if (!inc->hasNoSignedWrap() && !inc->hasNoUnsignedWrap()) {
+      return llvm::None;
+    }
+    isSigned = inc->hasNoSignedWrap();
+    break;
+  default:
+    return llvm::None;
+  }
+
+  return CountedLoopShape{indVar, inc, preheader, cmp, endIndex, pred,
+                          isSigned, exiting == latch};
+}
+
+bool IsPerfectLoopNest(const llvm::Loop &Outer, const llvm::Loop &Inner) {
+  if (Inner.getParentLoop() != &Outer || GetNumPHIs(*Outer.getHeader()) != 1 ||
+      GetNumPHIs(*Inner.getHeader()) != 1 || !Outer.getExitingBlock() ||
+      !Inner.getExitingBlock()) {
+    return false;
+  }
+
+  for (auto *bb : Outer.blocks()) {
+    if (Inner.contains(bb)) {
+      continue;
+    }
+
+    for (auto &e : *bb) {
+      if (e.mayHaveSideEffects()) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+bool IsInterchangeLegal(llvm::DependenceInfo *DI, llvm::Loop &Outer,
+                        llvm::Loop &Inner,
+                        llvm::ArrayRef<MemAccInst> Accesses) {
+  unsigned outerLevel = Outer.getLoopDepth();
+  unsigned innerLevel = Inner.getLoopDepth();
+
+  for (size_t i = 0; i < Accesses.size(); ++i) {
+    auto *src = Accesses[i].get();
+
+    if (!Outer.contains(src)) {
+      continue;
+    }
+
+    for (size_t j = i; j < Accesses.size(); ++j) {
+      auto *dst = Accesses[j].get();
+
+      if (!Outer.contains(dst) ||
+          (!src->mayWriteToMemory() && !dst->mayWriteToMemory())) {
+        continue;
+      }
+
+      if (!DI) {
+        return false;
+      }
+
+      auto dep = DI->depends(src, dst, true);
+
+      if (!dep) {
+        continue;
+      }
+
+      if (dep->isConfused() || dep->getLevels() < innerLevel) {
+        LLVM_DEBUG(llvm::dbgs() << "unanalyzable dependence between: " << *src
+                                << " and " << *dst << '\n';);
+        return false;
+      }
+
+      // dependences carried by the enclosing loops are not reordered
+      bool isCarriedOutside = false;
+      for (unsigned k = 1; k < outerLevel; ++k) {
+        if (!(dep->getDirection(k) & llvm::Dependence::DVEntry::EQ)) {
+          isCarriedOutside = true;
+          break;
+        }
+      }
+
+      if (isCarriedOutside) {
+        continue;
+      }
+
+      auto outerDir = dep->getDirection(outerLevel);
+      auto innerDir = dep->getDirection(innerLevel);
+
+      if (((outerDir & llvm::Dependence::DVEntry::LT) &&
+           (innerDir & llvm::Dependence::DVEntry::GT)) ||
+          ((outerDir & llvm::Dependence::DVEntry::GT) &&
+           (innerDir & llvm::Dependence::DVEntry::LT))) {
+        LLVM_DEBUG(llvm::dbgs() << "dependence prevents interchange between: "
+                                << *src << " and " << *dst << '\n';);
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+} // namespace atrox
@@ -12,6 +12,18 @@
 #include "llvm/Analysis/MemoryLocation.h"
 // using llvm::MemoryLocation
 
+#include "llvm/Analysis/ValueTracking.h"
+// using llvm::GetUnderlyingObject
+
+#include "llvm/IR/Instructions.h"
+// using llvm::getLoadStorePointerOperand
+
+#include "llvm/IR/Module.h"
+// using llvm::Module
+
+#include "llvm/IR/DataLayout.h"
+// using llvm::DataLayout
+
 #include "llvm/ADT/SmallPtrSet.h"
 // using llvm::SmallPtrSet
 
@@ -29,6 +41,56 @@
 
 namespace atrox {
 
+llvm::ModRefInfo MemoryAccessInfo::getRegionModRef(llvm::Value *V) {
+  auto mri = llvm::ModRefInfo::NoModRef;
+
+  if (Blocks.empty() || !V->getType()->isPointerTy()) {
+    return mri;
+  }
+
+  const auto &dl = Blocks.front()->getModule()->getDataLayout();
+  auto *obj = llvm::GetUnderlyingObject(V, dl);
+  llvm::MemoryLocation loc{V, llvm::MemoryLocation::UnknownSize};
+
+  for (auto *bb : Blocks) {
+    for (auto &i : *bb) {
+      if (!i.mayReadOrWriteMemory()) {
+        continue;
+      }
+
+      if (auto *ptr = llvm::getLoadStorePointerOperand(&i)) {
+        auto *accObj = llvm::GetUnderlyingObject(ptr, dl);
+
+        if (accObj == obj) {
+          mri = llvm::unionModRef(mri, i.mayWriteToMemory()
+                                           ? llvm::ModRefInfo::Mod
+                                           : llvm::ModRefInfo::Ref);
+          continue;
+        }
+
+        // distinct identified objects cannot alias
+        if (llvm::isIdentifiedObject(accObj) && llvm::isIdentifiedObject(obj)) {
+          continue;
+        }
+      }
+
+      // this also covers calls, based on their mod/ref behaviour and their
+      // arguments
+      mri = llvm::unionModRef(mri, AA->getModRefInfo(&i, loc));
+
+      if (llvm::isModAndRefSet(mri)) {
+        return mri;
+      }
+    }
+  }
+
+  LLVM_DEBUG(llvm::dbgs() << "mod/ref for " << *V << ": "
+                          << (llvm::isModSet(mri) ? "mod " : "")
+                          << (llvm::isRefSet(mri) ? "ref" : "") << '\n';);
+
+  return mri;
+}
+
 bool MemoryAccessInfo::isRead(llvm::Value *V) {
   LLVM_DEBUG(llvm::dbgs() << "examining read for: " << *V << '\n';);
 
@@ -47,18 +109,12 @@ bool MemoryAccessInfo::isRead(llvm::Value *V) {
         }
       }
     }
-  } else if (auto *arg = llvm::dyn_cast<llvm::Argument>(V)) {
-    if (AtroxIgnoreAliasing) {
-      return true;
+  } else if (llvm::isa<llvm::Argument>(V) || llvm::isa<llvm::Constant>(V)) {
+    if (!AA) {
+      return AtroxIgnoreAliasing;
     }
 
-    // TODO more elaborate handling is required here
-  } else if (auto *glob = llvm::dyn_cast<llvm::GlobalVariable>(V)) {
-    if (AtroxIgnoreAliasing) {
-      return true;
-    }
-
-    // TODO more elaborate handling is required here
+    return llvm::isRefSet(getRegionModRef(V));
   } else {
     llvm_unreachable("Unhandled value type");
   }
@@ -83,18 +139,12 @@ bool MemoryAccessInfo::isWrite(llvm::Value *V) {
         }
       }
     }
-  } else if (auto *arg = llvm::dyn_cast<llvm::Argument>(V)) {
-    if (AtroxIgnoreAliasing) {
-      return true;
-    }
-
-    // TODO more elaborate handling is required here
-  } else if (auto *glob = llvm::dyn_cast<llvm::GlobalVariable>(V)) {
-    if (AtroxIgnoreAliasing) {
-      return true;
+  } else if (llvm::isa<llvm::Argument>(V) || llvm::isa<llvm::Constant>(V)) {
+    if (!AA) {
+      return AtroxIgnoreAliasing;
     }
 
-    // TODO more elaborate handling is required here
+    return llvm::isModSet(getRegionModRef(V));
   } else {
     llvm_unreachable("Unhandled value type");
   }
@@ -0,0 +1,188 @@
+//
+//
+//
+
+#include "Atrox/Analysis/ParallelismAnalyzer.hpp"
+
+#include "Atrox/Analysis/ReductionRecognizer.hpp"
+
+#include "IteratorRecognition/Analysis/IteratorRecognition.hpp"
+
+#include "llvm/Config/llvm-config.h"
+// using LLVM_VERSION_MAJOR
+
+#include "llvm/Analysis/DependenceAnalysis.h"
+// using llvm::DependenceInfo
+// using llvm::Dependence
+
+#include "llvm/Analysis/LoopInfo.h"
+// using llvm::Loop
+
+#if LLVM_VERSION_MAJOR >= 8
+#include "llvm/Analysis/VectorUtils.h"
+// using llvm::uniteAccessGroups
+#endif
+
+#include "llvm/IR/Instructions.h"
+// using llvm::PHINode
+
+#include "llvm/IR/Metadata.h"
+// using llvm::MDNode
+// using llvm::MDString
+// using llvm::Metadata
+
+#include "llvm/IR/LLVMContext.h"
+// using llvm::LLVMContext
+
+#include "llvm/ADT/SmallVector.h"
+// using llvm::SmallVector
+
+#include "llvm/Support/Debug.h"
+// using LLVM_DEBUG macro
+// using llvm::dbgs
+
+#define DEBUG_TYPE "atrox-parallelism"
+
+namespace atrox {
+
+bool ParallelismAnalyzer::isIterator(const llvm::Instruction *I) const {
+  return Info && *Info && Info->isIterator(I);
+}
+
+void ParallelismAnalyzer::getPayloadAccesses(
+    llvm::ArrayRef<MemAccInst> Accesses,
+    llvm::SmallVectorImpl<llvm::Instruction *> &PayloadAccesses) const {
+  for (auto e : Accesses) {
+    if (!isIterator(e.get())) {
+      PayloadAccesses.push_back(e.get());
+    }
+  }
+}
+
+bool ParallelismAnalyzer::hasCarriedMemoryDependence(
+    llvm::Loop &L, llvm::ArrayRef<MemAccInst> Accesses) const {
+  unsigned level = L.getLoopDepth();
+
+  for (size_t i = 0; i < Accesses.size(); ++i) {
+    auto *src = Accesses[i].get();
+
+    for (size_t j = i; j < Accesses.size(); ++j) {
+      auto *dst = Accesses[j].get();
+
+      if (isIterator(src) && isIterator(dst)) {
+        continue;
+      }
+
+      if (!src->mayWriteToMemory() && !dst->mayWriteToMemory()) {
+        continue;
+      }
+
+      auto dep = DI->depends(src, dst, true);
+
+      if (!dep) {
+        continue;
+      }
+
+      if (dep->isConfused() || dep->getLevels() < level) {
+        LLVM_DEBUG(llvm::dbgs() << "unanalyzable dependence between: " << *src
+                                << " and " << *dst << '\n';);
+        return true;
+      }
+
+      // the dependence only concerns the payload loop if the iterations of
+      // all its outer loops can coincide
+      bool sameOuterIteration = true;
+      for (unsigned k = 1; k < level; ++k) {
+        if (!(dep->getDirection(k) & llvm::Dependence::DVEntry::EQ)) {
+          sameOuterIteration = false;
+          break;
+        }
+      }
+
+      if (sameOuterIteration &&
+          (dep->getDirection(level) & (llvm::Dependence::DVEntry::LT |
+                                       llvm::Dependence::DVEntry::GT))) {
+        LLVM_DEBUG(llvm::dbgs() << "loop-carried dependence between: " << *src
+                                << " and " << *dst << '\n';);
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+PayloadParallelism ParallelismAnalyzer::classify(
+    llvm::Loop &L, llvm::ArrayRef<MemAccInst> Accesses,
+    llvm::ArrayRef<llvm::PHINode *> CarriedValues) const {
+  if (hasCarriedMemoryDependence(L, Accesses)) {
+    return PayloadParallelism::Serial;
+  }
+
+  if (CarriedValues.empty()) {
+    return PayloadParallelism::DOALL;
+  }
+
+  for (auto *phi : CarriedValues) {
+    if (!phi) {
+      return PayloadParallelism::Serial;
+    }
+
+    if (!RecognizeReduction(*phi, L)) {
+      LLVM_DEBUG(llvm::dbgs() << "carried value is not a reduction: " << *phi
+                              << '\n';);
+      return PayloadParallelism::Serial;
+    }
+  }
+
+  return PayloadParallelism::Reduction;
+}
+
+void AnnotateParallelAccesses(llvm::Loop &L,
+                              llvm::ArrayRef<llvm::Instruction *> Accesses) {
+  if (Accesses.empty()) {
+    return;
+  }
+
+  auto &ctx = L.getHeader()->getContext();
+
+  // reserve the first operand for the self reference
+  llvm::SmallVector<llvm::Metadata *, 4> ops;
+  ops.push_back(nullptr);
+
+  if (auto *id = L.getLoopID()) {
+    for (unsigned i = 1; i < id->getNumOperands(); ++i) {
+      ops.push_back(id->getOperand(i));
+    }
+  }
+
+#if LLVM_VERSION_MAJOR >= 8
+  auto *group = llvm::MDNode::getDistinct(ctx, {});
+
+  for (auto *e : Accesses) {
+    e->setMetadata(llvm::LLVMContext::MD_access_group,
+                   llvm::uniteAccessGroups(
+                       e->getMetadata(llvm::LLVMContext::MD_access_group),
+                       group));
+  }
+
+  ops.push_back(llvm::MDNode::get(
+      ctx, {llvm::MDString::get(ctx, "llvm.loop.parallel_accesses"), group}));
+#endif
+
+  auto *loopID = llvm::MDNode::getDistinct(ctx, ops);
+  loopID->replaceOperandWith(0, loopID);
+  L.setLoopID(loopID);
+
+#if LLVM_VERSION_MAJOR < 8
+  for (auto *e : Accesses) {
+    e->setMetadata(
+        llvm::LLVMContext::MD_mem_parallel_loop_access,
+        llvm::MDNode::concatenate(
+            e->getMetadata(llvm::LLVMContext::MD_mem_parallel_loop_access),
+            llvm::MDNode::get(ctx, loopID)));
+  }
+#endif
+}
+
+} // namespace atrox
@@ -0,0 +1,170 @@
+//
+//
+//
+
+#include "Atrox/Analysis/PayloadIntensity.hpp"
+
+#include "Atrox/Analysis/LoopBoundsAnalyzer.hpp"
+
+#include "llvm/Analysis/LoopInfo.h"
+// using llvm::Loop
+// using llvm::LoopInfo
+
+#include "llvm/IR/DataLayout.h"
+// using llvm::DataLayout
+
+#include "llvm/IR/Instructions.h"
+// using llvm::LoadInst
+// using llvm::StoreInst
+// using llvm::CmpInst
+
+#include "llvm/IR/IntrinsicInst.h"
+// using llvm::IntrinsicInst
+// using llvm::MemIntrinsic
+// using llvm::MemTransferInst
+
+#include "llvm/IR/InstVisitor.h"
+// using llvm::InstVisitor
+
+#include "llvm/IR/DerivedTypes.h"
+// using llvm::VectorType
+
+#include "llvm/IR/Constants.h"
+// using llvm::ConstantInt
+
+#include "llvm/Support/Debug.h"
+// using LLVM_DEBUG macro
+// using llvm::dbgs
+
+#define DEBUG_TYPE "atrox-intensity"
+
+namespace atrox {
+
+namespace {
+
+class OperationCounter : public llvm::InstVisitor<OperationCounter> {
+  PayloadIntensity &PI;
+  uint64_t Multiplier = 1;
+
+  void count(llvm::Type *Ty) {
+    uint64_t lanes = 1;
+
+    if (auto *vt = llvm::dyn_cast<llvm::VectorType>(Ty)) {
+      lanes = vt->getNumElements();
+      PI.VectorOps += Multiplier;
+    }
+
+    if (Ty->getScalarType()->isFloatingPointTy()) {
+      PI.FPOps += lanes * Multiplier;
+    } else if (Ty->getScalarType()->isIntegerTy()) {
+      PI.IntOps += lanes * Multiplier;
+    }
+  }
+
+public:
+  explicit OperationCounter(PayloadIntensity &PI) : PI(PI) {}
+
+  void setMultiplier(uint64_t M) { Multiplier = M; }
+
+  void visitBinaryOperator(llvm::BinaryOperator &Inst) {
+    count(Inst.getType());
+  }
+
+  void visitCmpInst(llvm::CmpInst &Inst) {
+    count(Inst.getOperand(0)->getType());
+  }
+
+  void visitIntrinsicInst(llvm::IntrinsicInst &Inst) {
+    // math intrinsics, such as sqrt or fma
+    if (Inst.getType()->getScalarType()->isFloatingPointTy()) {
+      count(Inst.getType());
+    }
+  }
+};
+
+} // namespace
+
+uint64_t GetBlockMultiplier(const llvm::BasicBlock *BB, const llvm::Loop &L,
+                            const llvm::LoopInfo &LI,
+                            const LoopBoundsAnalyzer *LBA, bool &IsExact) {
+  uint64_t multiplier = 1;
+
+  for (auto *curL = LI.getLoopFor(BB); curL && curL != &L;
+       curL = curL->getParentLoop()) {
+    unsigned tripCount = 0;
+
+    if (LBA) {
+      if (auto info = LBA->getInfo(const_cast<llvm::Loop *>(curL))) {
+        tripCount = info->TripCount;
+      }
+    }
+
+    if (!tripCount) {
+      IsExact = false;
+      continue;
+    }
+
+    multiplier *= tripCount;
+  }
+
+  return multiplier;
+}
+
+PayloadIntensity
+CalculatePayloadIntensity(llvm::ArrayRef<llvm::BasicBlock *> Blocks,
+                          llvm::ArrayRef<MemAccInst> Accesses,
+                          const llvm::Loop &L, const llvm::LoopInfo &LI,
+                          const llvm::DataLayout &DL,
+                          const LoopBoundsAnalyzer *LBA) {
+  PayloadIntensity pi;
+  OperationCounter oc{pi};
+
+  for (auto *bb : Blocks) {
+    oc.setMultiplier(GetBlockMultiplier(bb, L, LI, LBA, pi.IsExact));
+    oc.visit(*bb);
+  }
+
+  for (auto e : Accesses) {
+    auto *inst = e.get();
+    auto multiplier = GetBlockMultiplier(inst->getParent(), L, LI, LBA,
+                                         pi.IsExact);
+
+    if (auto *ld = llvm::dyn_cast<llvm::LoadInst>(inst)) {
+      pi.BytesLoaded += DL.getTypeStoreSize(ld->getType()) * multiplier;
+    } else if (auto *st = llvm::dyn_cast<llvm::StoreInst>(inst)) {
+      pi.BytesStored +=
+          DL.getTypeStoreSize(st->getValueOperand()->getType()) * multiplier;
+    } else if (auto *mi = llvm::dyn_cast<llvm::MemIntrinsic>(inst)) {
+      auto *len = llvm::dyn_cast<llvm::ConstantInt>(mi->getLength());
+
+      if (!len) {
+        pi.IsExact = false;
+        continue;
+      }
+
+      pi.BytesStored += len->getZExtValue() * multiplier;
+
+      if (llvm::isa<llvm::MemTransferInst>(mi)) {
+        pi.BytesLoaded += len->getZExtValue() * multiplier;
+      }
+    }
+  }
+
+  LLVM_DEBUG(llvm::dbgs() << "payload ops: " << pi.getOps()
+                          << " bytes: " << pi.getBytes() << '\n';);
+
+  return pi;
+}
+
+RooflineBound ClassifyRoofline(const PayloadIntensity &PI, double PeakGOPS,
+                               double PeakBandwidth) {
+  if (!PI.getBytes() || PeakBandwidth <= 0.0) {
+    return RooflineBound::Compute;
+  }
+
+  return PI.getArithmeticIntensity() >= PeakGOPS / PeakBandwidth
+             ? RooflineBound::Compute
+             : RooflineBound::Memory;
+}
+
+} // namespace atrox
@@ -4,9 +4,24 @@
 
 #include "Atrox/Analysis/PayloadWeights.hpp"
 
+#include "llvm/Config/llvm-config.h"
+// using LLVM_VERSION_MAJOR
+
 #include "llvm/Analysis/LoopInfo.h"
 // using llvm::Loop
 
+#include "llvm/Analysis/BlockFrequencyInfo.h"
+// using llvm::BlockFrequencyInfo
+
+#include "llvm/Analysis/TargetTransformInfo.h"
+// using llvm::TargetTransformInfo
+
+#include "llvm/IR/Type.h"
+// using llvm::Type
+
+#include "llvm/ADT/Optional.h"
+// using llvm::Optional
+
 #include "llvm/IR/Instruction.h"
 // using llvm::Instruction
 
@@ -28,13 +43,56 @@
 #include "llvm/ADT/SmallPtrSet.h"
 // using llvm::SmallPtrSet
 
+#include "llvm/Support/JSON.h"
+// using llvm::json::parse
+// using llvm::json::Object
+
+#include "llvm/Support/MemoryBuffer.h"
+// using llvm::MemoryBuffer
+
+#include "llvm/Support/FileSystem.h"
+// using llvm::sys::fs::OF_Text
+
+#include "llvm/Support/FormatVariadic.h"
+// using llvm::formatv
+
+#include "llvm/Support/raw_ostream.h"
+// using llvm::raw_fd_ostream
+
+#include "llvm/Support/Debug.h"
+// using LLVM_DEBUG macro
+// using llvm::dbgs
+
+#include <algorithm>
+// using std::min
+
 #include <cassert>
 // using assert
 
+#include <utility>
+// using std::pair
+// using std::move
+
+#include <system_error>
+// using std::error_code
+
+#define DEBUG_TYPE "atrox-payload-weights"
+
 namespace atrox {
 
 namespace {
 
+PayloadWeightTable CurrentWeightTable;
+
+const std::pair<const char *, PayloadWeightTy PayloadWeightTable::*>
+    WeightTableKeys[] = {
+        {"cast", &PayloadWeightTable::Cast},
+        {"debug intrinsic", &PayloadWeightTable::DebugIntrinsic},
+        {"instruction", &PayloadWeightTable::Instruction},
+        {"memory", &PayloadWeightTable::Memory},
+        {"call", &PayloadWeightTable::Call},
+        {"call argument", &PayloadWeightTable::CallArgument}};
+
 PayloadWeightTy &operator+=(PayloadWeightTy &lhs,
                             const WeightedPayloadType &rhs) {
   lhs += static_cast<PayloadWeightTy>(rhs);
@@ -43,48 +101,50 @@ PayloadWeightTy &operator+=(PayloadWeightTy &lhs,
 
 class PayloadWeightCalculator
     : public llvm::InstVisitor<PayloadWeightCalculator> {
+  const PayloadWeightTable &m_Weights;
   PayloadWeightTy m_Weight;
 
 public:
-  PayloadWeightCalculator() : m_Weight(0) {}
+  PayloadWeightCalculator()
+      : m_Weights(GetPayloadWeightTable()), m_Weight(0) {}
 
   PayloadWeightTy getWeight() const { return m_Weight; }
   void reset() { m_Weight = 0; }
 
   void visitLoadInst(llvm::LoadInst &Inst) {
-    m_Weight += WeightedPayloadType::Memory;
+    m_Weight += m_Weights.Memory;
   }
 
   void visitCastInst(llvm::CastInst &Inst) {
-    m_Weight += WeightedPayloadType::Cast;
+    m_Weight += m_Weights.Cast;
   }
 
   void visitCallInst(llvm::CallInst &Inst) {
-    m_Weight += WeightedPayloadType::Call;
+    m_Weight += m_Weights.Call;
   }
 
   void visitStoreInst(llvm::StoreInst &Inst) {
-    m_Weight += WeightedPayloadType::Memory;
+    m_Weight += m_Weights.Memory;
   }
 
   void visitInstruction(llvm::Instruction &Inst) {
-    m_Weight += WeightedPayloadType::Instruction;
+    m_Weight += m_Weights.Instruction;
   }
 
   void visitDbgInfoIntrinsic(llvm::DbgInfoIntrinsic &Inst) {
-    m_Weight += WeightedPayloadType::DebugIntrinsic;
+    m_Weight += m_Weights.DebugIntrinsic;
   }
 
   void visitAllocaInst(llvm::AllocaInst &Inst) {
-    m_Weight += WeightedPayloadType::Memory;
+    m_Weight += m_Weights.Memory;
   }
 
   void visitGetElementPtrInst(llvm::GetElementPtrInst &Inst) {
-    m_Weight += WeightedPayloadType::Memory;
+    m_Weight += m_Weights.Memory;
   }
 
   void visitMemIntrinsic(llvm::MemIntrinsic &Inst) {
-    m_Weight += WeightedPayloadType::Memory;
+    m_Weight += m_Weights.Memory;
   }
 
   void visitTerminatorInst(llvm::TerminatorInst &Inst) {
@@ -93,15 +153,206 @@ public:
     if (br && br->isUnconditional())
       m_Weight += WeightedPayloadType::Minimum;
     else
-      m_Weight += WeightedPayloadType::Instruction;
+      m_Weight += m_Weights.Instruction;
+  }
+};
+
+#if LLVM_VERSION_MAJOR >= 12
+llvm::Optional<PayloadWeightTy> ToWeight(const llvm::InstructionCost &Cost) {
+  if (!Cost.isValid()) {
+    return llvm::None;
+  }
+
+  return static_cast<PayloadWeightTy>(*Cost.getValue());
+}
+#else
+llvm::Optional<PayloadWeightTy> ToWeight(int Cost) {
+  if (Cost < 0) {
+    return llvm::None;
+  }
+
+  return static_cast<PayloadWeightTy>(Cost);
+}
+#endif
+
+// table weights are relative to an instruction, which corresponds to a basic
+// TTI cost
+PayloadWeightTy ToTTIUnits(PayloadWeightTy Weight) {
+  auto instruction = GetPayloadWeightTable().Instruction;
+
+  if (!instruction) {
+    return Weight;
+  }
+
+  auto basic =
+      static_cast<PayloadWeightTy>(llvm::TargetTransformInfo::TCC_Basic);
+
+  return (Weight * basic + instruction / 2) / instruction;
+}
+
+class TTIPayloadWeightCalculator
+    : public llvm::InstVisitor<TTIPayloadWeightCalculator> {
+  const llvm::TargetTransformInfo &m_TTI;
+  PayloadWeightCalculator m_Table;
+  PayloadWeightTy m_Weight;
+
+  template <typename T>
+  void add(const T &Cost, llvm::Instruction &Inst) {
+    if (auto weight = ToWeight(Cost)) {
+      m_Weight += *weight;
+      return;
+    }
+
+    m_Table.reset();
+    m_Table.visit(Inst);
+    m_Weight += ToTTIUnits(m_Table.getWeight());
+  }
+
+  template <typename T> void visitMemoryInst(T &Inst, llvm::Type *Ty) {
+#if LLVM_VERSION_MAJOR >= 11
+    add(m_TTI.getMemoryOpCost(Inst.getOpcode(), Ty, Inst.getAlign(),
+                              Inst.getPointerAddressSpace(),
+                              llvm::TargetTransformInfo::TCK_RecipThroughput,
+                              &Inst),
+        Inst);
+#else
+    add(m_TTI.getMemoryOpCost(Inst.getOpcode(), Ty, Inst.getAlignment(),
+                              Inst.getPointerAddressSpace(), &Inst),
+        Inst);
+#endif
+  }
+
+public:
+  explicit TTIPayloadWeightCalculator(const llvm::TargetTransformInfo &TTI)
+      : m_TTI(TTI), m_Weight(0) {}
+
+  PayloadWeightTy getWeight() const { return m_Weight; }
+  void reset() { m_Weight = 0; }
+
+  void visitLoadInst(llvm::LoadInst &Inst) {
+    visitMemoryInst(Inst, Inst.getType());
+  }
+
+  void visitStoreInst(llvm::StoreInst &Inst) {
+    visitMemoryInst(Inst, Inst.getValueOperand()->getType());
+  }
+
+  void visitIntrinsicInst(llvm::IntrinsicInst &Inst) { visitInstruction(Inst); }
+
+  void visitCallInst(llvm::CallInst &Inst) {
+    add(m_TTI.getCallInstrCost(Inst.getCalledFunction(), Inst.getType(),
+                               Inst.getFunctionType()->params()),
+        Inst);
+  }
+
+  void visitInstruction(llvm::Instruction &Inst) {
+    add(m_TTI.getInstructionCost(
+            &Inst, llvm::TargetTransformInfo::TCK_RecipThroughput),
+        Inst);
   }
 };
 
 } // namespace
 
-BlockPayloadMapTy CalculatePayloadWeight(
-    const llvm::SmallVectorImpl<llvm::BasicBlock *> &Blocks) {
+const PayloadWeightTable &GetPayloadWeightTable() {
+  return CurrentWeightTable;
+}
+
+void SetPayloadWeightTable(const PayloadWeightTable &Table) {
+  CurrentWeightTable = Table;
+}
+
+bool ReadPayloadWeightTable(llvm::StringRef Filename,
+                            PayloadWeightTable &Table) {
+  auto bufferOrErr = llvm::MemoryBuffer::getFile(Filename);
+
+  if (!bufferOrErr) {
+    LLVM_DEBUG(llvm::dbgs() << "could not read weight table: " << Filename
+                            << '\n';);
+    return false;
+  }
+
+  auto valueOrErr = llvm::json::parse((*bufferOrErr)->getBuffer());
+
+  if (!valueOrErr) {
+    LLVM_DEBUG(llvm::dbgs() << "malformed weight table: "
+                            << llvm::toString(valueOrErr.takeError())
+                            << '\n';);
+    return false;
+  }
+
+  auto *obj = valueOrErr->getAsObject();
+
+  if (!obj) {
+    return false;
+  }
+
+  PayloadWeightTable table = Table;
+  auto maxWeight = static_cast<int64_t>(WeightedPayloadType::Maximum);
+
+  for (const auto &e : WeightTableKeys) {
+    auto weight = obj->getInteger(e.first);
+
+    if (!weight) {
+      continue;
+    }
+
+    if (*weight < 0 || *weight >= maxWeight) {
+      LLVM_DEBUG(llvm::dbgs() << "weight out of range for: " << e.first
+                              << '\n';);
+      return false;
+    }
+
+    table.*e.second = static_cast<PayloadWeightTy>(*weight);
+  }
+
+  Table = table;
+
+  return true;
+}
+
+bool WritePayloadWeightTable(llvm::StringRef Filename,
+                             const PayloadWeightTable &Table) {
+  llvm::json::Object obj;
+
+  for (const auto &e : WeightTableKeys) {
+    obj[e.first] = static_cast<int64_t>(Table.*e.second);
+  }
+
+  std::error_code ec;
+#if LLVM_VERSION_MAJOR >= 9
+  llvm::raw_fd_ostream os(Filename, ec, llvm::sys::fs::OF_Text);
+#else
+  llvm::raw_fd_ostream os(Filename, ec, llvm::sys::fs::F_Text);
+#endif
+
+  if (ec) {
+    return false;
+  }
+
+  os << llvm::formatv("{0:2}", llvm::json::Value(std::move(obj))) << '\n';
+  os.close();
+
+  return !os.has_error();
+}
+
+BlockPayloadMapTy
+CalculatePayloadWeight(const llvm::SmallVectorImpl<llvm::BasicBlock *> &Blocks,
+                       const llvm::TargetTransformInfo *TTI) {
   BlockPayloadMapTy blockPayloadMap;
+
+  if (TTI) {
+    TTIPayloadWeightCalculator tpwc{*TTI};
+
+    for (auto *e : Blocks) {
+      tpwc.reset();
+      tpwc.visit(*e);
+      blockPayloadMap.emplace(e, tpwc.getWeight());
+    }
+
+    return blockPayloadMap;
+  }
+
   PayloadWeightCalculator pwc;
 
   for (auto *e : Blocks) {
@@ -113,5 +364,43 @@ BlockPayloadMapTy CalculatePayloadWeight(
   return blockPayloadMap;
 }
 
+PayloadWeightTy CalculateCallWeight(unsigned NumArgs, llvm::LLVMContext &Ctx,
+                                    const llvm::TargetTransformInfo *TTI) {
+  auto &weights = GetPayloadWeightTable();
+
+  if (TTI) {
+    auto weight = ToWeight(
+        TTI->getCallInstrCost(nullptr, llvm::Type::getVoidTy(Ctx), {}));
+
+    return (weight ? *weight : ToTTIUnits(weights.Call)) +
+           ToTTIUnits(weights.CallArgument) * NumArgs;
+  }
+
+  return weights.Call + weights.CallArgument * NumArgs;
+}
+
+void ScalePayloadWeights(BlockPayloadMapTy &Weights,
+                         const llvm::BlockFrequencyInfo &BFI,
+                         const llvm::BasicBlock &Reference) {
+  auto refCount = BFI.getBlockProfileCount(&Reference);
+  bool useCounts = refCount && *refCount;
+  uint64_t ref = useCounts ? *refCount
+                           : BFI.getBlockFreq(&Reference).getFrequency();
+
+  if (!ref) {
+    return;
+  }
+
+  for (auto &e : Weights) {
+    uint64_t freq = useCounts
+                        ? BFI.getBlockProfileCount(e.first).getValueOr(0)
+                        : BFI.getBlockFreq(e.first).getFrequency();
+    auto scaled = static_cast<double>(e.second) * freq / ref + 0.5;
+
+    e.second = static_cast<PayloadWeightTy>(std::min<double>(
+        scaled, static_cast<PayloadWeightTy>(WeightedPayloadType::Maximum)));
+  }
+}
+
 } // namespace atrox
 
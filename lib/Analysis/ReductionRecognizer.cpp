@@ -0,0 +1,171 @@
+//
+//
+//
+
+#include "Atrox/Analysis/ReductionRecognizer.hpp"
+
+#include "llvm/Transforms/Utils/LoopUtils.h"
+// using llvm::RecurrenceDescriptor
+
+#include "llvm/Analysis/LoopInfo.h"
+// using llvm::Loop
+
+#include "llvm/IR/Instructions.h"
+// using llvm::PHINode
+
+#include "llvm/IR/Operator.h"
+// using llvm::FPMathOperator
+
+#include "llvm/IR/Constants.h"
+// using llvm::Constant
+// using llvm::ConstantInt
+// using llvm::ConstantFP
+
+#include "llvm/ADT/APInt.h"
+// using llvm::APInt
+
+#include "llvm/ADT/SmallPtrSet.h"
+// using llvm::SmallPtrSet
+
+#include "llvm/ADT/SmallVector.h"
+// using llvm::SmallVector
+
+#include "llvm/Support/Debug.h"
+// using LLVM_DEBUG macro
+// using llvm::dbgs
+
+#define DEBUG_TYPE "atrox-reduction"
+
+namespace {
+
+// check that all floating-point operations that the recurrence flows through
+// allow reassociation
+bool IsReassociable(llvm::PHINode &Phi, llvm::Loop &L) {
+  llvm::SmallVector<llvm::Instruction *, 8> workList{&Phi};
+  llvm::SmallPtrSet<llvm::Instruction *, 8> visited;
+
+  while (!workList.empty()) {
+    auto *cur = workList.pop_back_val();
+
+    if (!visited.insert(cur).second) {
+      continue;
+    }
+
+    if (llvm::isa<llvm::FPMathOperator>(cur) && !cur->hasAllowReassoc()) {
+      LLVM_DEBUG(llvm::dbgs() << "operation does not allow reassociation: "
+                              << *cur << '\n';);
+      return false;
+    }
+
+    for (auto *u : cur->users()) {
+      auto *i = llvm::dyn_cast<llvm::Instruction>(u);
+
+      if (i && L.contains(i) && i != &Phi) {
+        workList.push_back(i);
+      }
+    }
+  }
+
+  return true;
+}
+
+} // namespace
+
+namespace atrox {
+
+llvm::Optional<ReductionInfo> RecognizeReduction(llvm::PHINode &Phi,
+                                                 llvm::Loop &L) {
+  using RD = llvm::RecurrenceDescriptor;
+
+  RD rd;
+  if (Phi.getParent() != L.getHeader() || !RD::isReductionPHI(&Phi, &L, rd)) {
+    return llvm::None;
+  }
+
+  auto *ty = Phi.getType();
+  auto kind = rd.getRecurrenceKind();
+  ReductionOp op;
+  llvm::Constant *identity = nullptr;
+
+  switch (kind) {
+  case RD::RK_IntegerAdd:
+    op = ReductionOp::Add;
+    break;
+  case RD::RK_IntegerMult:
+    op = ReductionOp::Mul;
+    break;
+  case RD::RK_IntegerAnd:
+    op = ReductionOp::And;
+    break;
+  case RD::RK_IntegerOr:
+    op = ReductionOp::Or;
+    break;
+  case RD::RK_IntegerXor:
+    op = ReductionOp::Xor;
+    break;
+  case RD::RK_FloatAdd:
+    op = ReductionOp::FAdd;
+    break;
+  case RD::RK_FloatMult:
+    op = ReductionOp::FMul;
+    break;
+  case RD::RK_IntegerMinMax: {
+    auto bits = ty->getIntegerBitWidth();
+
+    switch (rd.getMinMaxRecurrenceKind()) {
+    case RD::MRK_SIntMin:
+      op = ReductionOp::SMin;
+      identity =
+          llvm::ConstantInt::get(ty, llvm::APInt::getSignedMaxValue(bits));
+      break;
+    case RD::MRK_SIntMax:
+      op = ReductionOp::SMax;
+      identity =
+          llvm::ConstantInt::get(ty, llvm::APInt::getSignedMinValue(bits));
+      break;
+    case RD::MRK_UIntMin:
+      op = ReductionOp::UMin;
+      identity = llvm::ConstantInt::get(ty, llvm::APInt::getMaxValue(bits));
+      break;
+    case RD::MRK_UIntMax:
+      op = ReductionOp::UMax;
+      identity = llvm::ConstantInt::get(ty, llvm::APInt::getMinValue(bits));
+      break;
+    default:
+      return llvm::None;
+    }
+    break;
+  }
+  case RD::RK_FloatMinMax:
+    switch (rd.getMinMaxRecurrenceKind()) {
+    case RD::MRK_FloatMin:
+      op = ReductionOp::FMin;
+      identity = llvm::ConstantFP::getInfinity(ty, false);
+      break;
+    case RD::MRK_FloatMax:
+      op = ReductionOp::FMax;
+      identity = llvm::ConstantFP::getInfinity(ty, true);
+      break;
+    default:
+      return llvm::None;
+    }
+    break;
+  default:
+    return llvm::None;
+  }
+
+  if (ty->isFloatingPointTy() && !IsReassociable(Phi, L)) {
+    return llvm::None;
+  }
+
+  if (!identity) {
+    identity = RD::getRecurrenceIdentity(kind, ty);
+  }
+
+  LLVM_DEBUG(llvm::dbgs() << "reduction " << toString(op) << ": " << Phi
+                          << '\n';);
+
+  return ReductionInfo{&Phi, op, identity};
+}
+
+} // namespace atrox
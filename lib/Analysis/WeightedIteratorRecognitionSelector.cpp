@@ -41,9 +41,10 @@
 namespace atrox {
 
 WeightedIteratorRecognitionSelector::WeightedIteratorRecognitionSelector(
-    iteratorrecognition::IteratorRecognitionInfo &ITRInfo)
+    iteratorrecognition::IteratorRecognitionInfo &ITRInfo,
+    llvm::BlockFrequencyInfo *BFI, const llvm::TargetTransformInfo *TTI)
     : CurLI(const_cast<llvm::LoopInfo *>(&ITRInfo.getLoopInfo())),
-      Info(ITRInfo) {}
+      Info(ITRInfo), BFI(BFI), TTI(TTI) {}
 
 void WeightedIteratorRecognitionSelector::calculate(
     llvm::Loop &L, llvm::SmallVectorImpl<llvm::BasicBlock *> &Blocks) {
@@ -75,7 +76,12 @@ void WeightedIteratorRecognitionSelector::calculate(
     blocks.erase(std::remove(blocks.begin(), blocks.end(), b), blocks.end());
   }
 
-  auto weights = CalculatePayloadWeight(payloadBlocks);
+  auto weights = CalculatePayloadWeight(payloadBlocks, TTI);
+
+  // the tree that runs the most per iteration is preferred over the largest
+  if (BFI) {
+    ScalePayloadWeights(weights, *BFI, *L.getHeader());
+  }
   auto trees = SelectPayloadTrees(L, Info.getLoopInfo(), payloadBlocks);
 
   // select payload with highest
@@ -64,6 +64,27 @@ void WriteJSONToFile(const llvm::json::Value &V,
 namespace llvm {
 namespace json {
 
+Value toJSON(const atrox::AccessFootprintSpec &Footprint) {
+  Object root;
+  Array strides;
+
+  for (const auto &e : Footprint.Strides) {
+    Object item;
+    item["loop"] = e.Loop;
+    item["stride"] = e.Stride;
+
+    strides.push_back(std::move(item));
+  }
+
+  root["base"] = Footprint.Base;
+  root["min offset"] = Footprint.MinOffset;
+  root["max offset"] = Footprint.MaxOffset;
+  root["element size"] = static_cast<int64_t>(Footprint.ElementSize);
+  root["strides"] = std::move(strides);
+
+  return std::move(root);
+}
+
 Value toJSON(ArrayRef<atrox::ArgSpec> ArgSpecs) {
   Object root;
   Array specs;
@@ -73,6 +94,21 @@ Value toJSON(ArrayRef<atrox::ArgSpec> ArgSpecs) {
     item["name"] = s.Name;
     item["direction"] = toInt(s.Direction);
     item["iterator dependent"] = s.IteratorDependent;
+    item["passing"] = atrox::toString(s.Passing);
+
+    if (s.ReturnIndex >= 0) {
+      item["return index"] = s.ReturnIndex;
+    }
+
+    if (s.Footprint) {
+      item["footprint"] = toJSON(*s.Footprint);
+    }
+
+    if (s.Pattern) {
+      item["access pattern"] = atrox::toString(s.Pattern->Pattern);
+      item["access pattern confidence"] =
+          atrox::toString(s.Pattern->Confidence);
+    }
 
     specs.push_back(std::move(item));
   }
@@ -82,6 +118,316 @@ Value toJSON(ArrayRef<atrox::ArgSpec> ArgSpecs) {
   return std::move(root);
 }
 
+Value toJSON(const atrox::AggregateLayoutSpec &Layout) {
+  Object root;
+  Array blocks;
+  Array fields;
+
+  for (auto e : Layout.BlockSizes) {
+    blocks.push_back(static_cast<int64_t>(e));
+  }
+
+  for (const auto &f : Layout.Fields) {
+    Object item;
+    item["name"] = f.Name;
+    item["block"] = static_cast<int64_t>(f.Block);
+    item["index"] = static_cast<int64_t>(f.Index);
+    item["offset"] = static_cast<int64_t>(f.Offset);
+    item["size"] = static_cast<int64_t>(f.Size);
+    item["writable"] = f.Writable;
+
+    fields.push_back(std::move(item));
+  }
+
+  root["kind"] = atrox::toString(Layout.Kind);
+  root["private outputs"] = Layout.PrivateOutputs;
+  root["alignment"] = static_cast<int64_t>(Layout.Alignment);
+  root["block sizes"] = std::move(blocks);
+  root["fields"] = std::move(fields);
+
+  return std::move(root);
+}
+
+Value toJSON(ArrayRef<atrox::ReductionSpec> Reductions) {
+  Array reductions;
+
+  for (const auto &e : Reductions) {
+    Object item;
+    item["name"] = e.Name;
+    item["operator"] = atrox::toString(e.Op);
+    item["identity"] = e.Identity;
+    item["private"] = e.Private;
+
+    reductions.push_back(std::move(item));
+  }
+
+  return std::move(reductions);
+}
+
+Value toJSON(const atrox::PayloadIntensity &Intensity) {
+  Object root;
+
+  root["int ops"] = static_cast<int64_t>(Intensity.IntOps);
+  root["fp ops"] = static_cast<int64_t>(Intensity.FPOps);
+  root["vector ops"] = static_cast<int64_t>(Intensity.VectorOps);
+  root["bytes loaded"] = static_cast<int64_t>(Intensity.BytesLoaded);
+  root["bytes stored"] = static_cast<int64_t>(Intensity.BytesStored);
+  root["arithmetic intensity"] = Intensity.getArithmeticIntensity();
+  root["exact"] = Intensity.IsExact;
+
+  return std::move(root);
+}
+
+Value toJSON(ArrayRef<atrox::LoopBoundsSpec> LoopBounds) {
+  Array bounds;
+
+  for (const auto &e : LoopBounds) {
+    Object item;
+    item["header"] = e.Header;
+    item["induction variable"] = e.InductionVariable;
+    item["start"] = e.Start;
+    item["end"] = e.End;
+    item["backedge taken count"] = e.BackedgeTakenCount;
+    item["max trip count"] = static_cast<int64_t>(e.MaxTripCount);
+
+    bounds.push_back(std::move(item));
+  }
+
+  return std::move(bounds);
+}
+
+Value toJSON(ArrayRef<atrox::PrefetchSpec> Prefetches) {
+  Array prefetches;
+
+  for (const auto &e : Prefetches) {
+    Object item;
+    item["kind"] = atrox::toString(e.Kind);
+    item["base"] = e.Base;
+
+    if (e.Kind == atrox::PrefetchKind::Indirect) {
+      item["index"] = e.Index;
+    }
+
+    item["loop"] = e.Loop;
+    item["stride"] = e.Stride;
+    item["distance"] = static_cast<int64_t>(e.Distance);
+    item["write"] = e.Write;
+
+    prefetches.push_back(std::move(item));
+  }
+
+  return std::move(prefetches);
+}
+
+Value toJSON(const atrox::PipelineSpec &Pipeline) {
+  Object root;
+  Array record, context;
+
+  for (const auto &e : Pipeline.RecordFields) {
+    record.push_back(e);
+  }
+
+  for (const auto &e : Pipeline.ContextFields) {
+    context.push_back(e);
+  }
+
+  root["workers"] = static_cast<int64_t>(Pipeline.Workers);
+  root["capacity"] = static_cast<int64_t>(Pipeline.Capacity);
+  root["record size"] = static_cast<int64_t>(Pipeline.RecordSize);
+  root["record"] = std::move(record);
+  root["context"] = std::move(context);
+
+  return std::move(root);
+}
+
+Value toJSON(const atrox::FissionSpec &Fission) {
+  Object root;
+  Array record, invariant;
+
+  for (const auto &e : Fission.RecordFields) {
+    record.push_back(e);
+  }
+
+  for (const auto &e : Fission.InvariantFields) {
+    invariant.push_back(e);
+  }
+
+  root["capacity"] = static_cast<int64_t>(Fission.Capacity);
+  root["bounded"] = Fission.Bounded;
+  root["record size"] = static_cast<int64_t>(Fission.RecordSize);
+  root["record"] = std::move(record);
+  root["invariant"] = std::move(invariant);
+
+  return std::move(root);
+}
+
+Value toJSON(const atrox::InterleavingSpec &Interleaving) {
+  Object root;
+
+  root["coroutine"] = Interleaving.Coroutine;
+  root["group size"] = static_cast<int64_t>(Interleaving.GroupSize);
+  root["suspend points"] = static_cast<int64_t>(Interleaving.SuspendPoints);
+
+  return std::move(root);
+}
+
+Value toJSON(const atrox::SpecializationSpec &Specialization) {
+  Object root;
+  Array args;
+
+  for (const auto &e : Specialization.Args) {
+    Object item;
+
+    item["name"] = e.Name;
+    item["value"] = e.Value;
+    item["source"] = atrox::toString(e.Source);
+
+    args.push_back(std::move(item));
+  }
+
+  root["specialized"] = Specialization.Specialized;
+  root["generic"] = Specialization.Generic;
+  root["args"] = std::move(args);
+
+  return std::move(root);
+}
+
+Value toJSON(const atrox::ExtractionCost &Extraction) {
+  Object root;
+
+  root["payload weight"] = static_cast<int64_t>(Extraction.PayloadWeight);
+  root["call overhead"] = static_cast<int64_t>(Extraction.CallOverhead);
+  root["live-ins"] = static_cast<int64_t>(Extraction.LiveIns);
+  root["trip count"] = static_cast<int64_t>(Extraction.TripCount);
+  root["exact"] = Extraction.IsExact;
+  root["cost model"] = atrox::toString(Extraction.Model);
+
+  return std::move(root);
+}
+
+Value toJSON(ArrayRef<atrox::ArrayShapeSpec> Shapes) {
+  Array shapes;
+
+  for (const auto &e : Shapes) {
+    Object item;
+    Array sizes;
+
+    for (const auto &s : e.Sizes) {
+      sizes.push_back(s);
+    }
+
+    item["array"] = e.Array;
+    item["static"] = e.IsStatic;
+    item["sizes"] = std::move(sizes);
+    item["element size"] = static_cast<int64_t>(e.ElementSize);
+    item["accesses"] = static_cast<int64_t>(e.Accesses);
+
+    shapes.push_back(std::move(item));
+  }
+
+  return std::move(shapes);
+}
+
+Value toJSON(ArrayRef<atrox::TilingSpec> Tilings) {
+  Array tilings;
+
+  for (const auto &e : Tilings) {
+    Object item;
+
+    item["loop"] = e.Loop;
+    item["outer loop"] = e.OuterLoop;
+    item["tile size"] = static_cast<int64_t>(e.TileSize);
+    item["footprint"] = static_cast<int64_t>(e.Footprint);
+    item["cache size"] = static_cast<int64_t>(e.CacheSize);
+
+    tilings.push_back(std::move(item));
+  }
+
+  return std::move(tilings);
+}
+
+Value toJSON(ArrayRef<atrox::InterchangeSpec> Interchanges) {
+  Array interchanges;
+
+  for (const auto &e : Interchanges) {
+    Object item;
+
+    item["loop"] = e.Loop;
+    item["outer loop"] = e.OuterLoop;
+    item["status"] = atrox::toString(e.Status);
+    item["improved accesses"] = static_cast<int64_t>(e.ImprovedAccesses);
+    item["worsened accesses"] = static_cast<int64_t>(e.WorsenedAccesses);
+
+    interchanges.push_back(std::move(item));
+  }
+
+  return std::move(interchanges);
+}
+
+Value toJSON(ArrayRef<atrox::FieldDensitySpec> Densities) {
+  Array densities;
+
+  for (const auto &e : Densities) {
+    Object item;
+    Array fields;
+
+    for (const auto &f : e.Fields) {
+      Object field;
+
+      field["index"] = static_cast<int64_t>(f.Index);
+      field["offset"] = static_cast<int64_t>(f.Offset);
+      field["size"] = static_cast<int64_t>(f.Size);
+      field["reads"] = static_cast<int64_t>(f.Reads);
+      field["writes"] = static_cast<int64_t>(f.Writes);
+
+      fields.push_back(std::move(field));
+    }
+
+    item["arg"] = e.Arg;
+    item["type"] = e.Type;
+    item["size"] = static_cast<int64_t>(e.Size);
+    item["fields"] = static_cast<int64_t>(e.NumFields);
+    item["accessed fields"] = std::move(fields);
+    item["used bytes"] = static_cast<int64_t>(e.UsedBytes);
+    item["density"] =
+        e.Size ? static_cast<double>(e.UsedBytes) / e.Size : 0.0;
+    item["convertible"] = e.IsConvertible;
+
+    densities.push_back(std::move(item));
+  }
+
+  return std::move(densities);
+}
+
+Value toJSON(const atrox::SoALayoutSpec &Layout) {
+  Object root;
+  Array params;
+
+  for (const auto &e : Layout.Params) {
+    Object item;
+
+    item["name"] = e.Name;
+    item["arg"] = e.Arg;
+    item["field"] = static_cast<int64_t>(e.Field);
+
+    params.push_back(std::move(item));
+  }
+
+  root["function"] = Layout.Function;
+  root["params"] = std::move(params);
+
+  return std::move(root);
+}
+
+Value toJSON(const atrox::SkippedRewriteSpec &Skipped) {
+  Object root;
+
+  root["kind"] = Skipped.Kind;
+  root["reason"] = Skipped.Reason;
+
+  return std::move(root);
+}
+
 Value toJSON(const atrox::FunctionArgSpec &FAS) {
   Object root;
 
@@ -92,6 +438,84 @@ Value toJSON(const atrox::FunctionArgSpec &FAS) {
   if (FAS.CurLoop) {
     root["loop"] = iteratorrecognition::json::toJSON(*FAS.CurLoop);
     root["args"] = toJSON(FAS.Args);
+
+    if (FAS.AggregateLayout) {
+      root["aggregate layout"] = toJSON(*FAS.AggregateLayout);
+    }
+
+    if (FAS.Parallelism) {
+      root["parallelism"] = atrox::toString(*FAS.Parallelism);
+    }
+
+    if (!FAS.Reductions.empty()) {
+      root["reductions"] = toJSON(FAS.Reductions);
+    }
+
+    if (FAS.Intensity) {
+      auto intensity = toJSON(*FAS.Intensity);
+
+      if (FAS.Bound) {
+        intensity.getAsObject()->insert(
+            {"roofline bound", atrox::toString(*FAS.Bound)});
+      }
+
+      root["intensity"] = std::move(intensity);
+    }
+
+    if (!FAS.LoopBounds.empty()) {
+      root["loop bounds"] = toJSON(FAS.LoopBounds);
+    }
+
+    if (!FAS.Prefetches.empty()) {
+      root["prefetches"] = toJSON(FAS.Prefetches);
+    }
+
+    if (FAS.Pipeline) {
+      root["pipeline"] = toJSON(*FAS.Pipeline);
+    }
+
+    if (FAS.Fission) {
+      root["fission"] = toJSON(*FAS.Fission);
+    }
+
+    if (FAS.Interleaving) {
+      root["interleaving"] = toJSON(*FAS.Interleaving);
+    }
+
+    if (FAS.Specialization) {
+      root["specialization"] = toJSON(*FAS.Specialization);
+    }
+
+    if (FAS.Extraction) {
+      auto extraction = toJSON(*FAS.Extraction);
+      extraction.getAsObject()->insert({"mode", atrox::toString(FAS.Mode)});
+
+      root["extraction"] = std::move(extraction);
+    }
+
+    if (!FAS.ArrayShapes.empty()) {
+      root["array shapes"] = toJSON(FAS.ArrayShapes);
+    }
+
+    if (!FAS.Tilings.empty()) {
+      root["tiling"] = toJSON(FAS.Tilings);
+    }
+
+    if (!FAS.Interchanges.empty()) {
+      root["interchange"] = toJSON(FAS.Interchanges);
+    }
+
+    if (!FAS.FieldDensities.empty()) {
+      root["field density"] = toJSON(FAS.FieldDensities);
+    }
+
+    if (FAS.SoALayout) {
+      root["soa layout"] = toJSON(*FAS.SoALayout);
+    }
+
+    if (FAS.SkippedRewrite) {
+      root["skipped rewrite"] = toJSON(*FAS.SkippedRewrite);
+    }
   }
 
   return std::move(root);
@@ -4,6 +4,8 @@
 
 #include "private/PassCommandLineOptions.hpp"
 
+#include "Atrox/Analysis/ExtractionCost.hpp"
+
 #include "llvm/Support/CommandLine.h"
 // using llvm::cl::opt
 // using llvm::cl::list
@@ -20,7 +22,9 @@ llvm::cl::OptionCategory AtroxCLCategory("Atrox Pass",
 
 llvm::cl::opt<bool>
     AtroxIgnoreAliasing("atrox-ignore-aliasing", llvm::cl::init(true),
-                        llvm::cl::desc("use specific aliasing assumptions"),
+                        llvm::cl::desc("assume that arguments and globals are "
+                                       "accessed when alias analysis is not "
+                                       "available"),
                         llvm::cl::cat(AtroxCLCategory));
 
 llvm::cl::opt<bool> AtroxSkipCalls("atrox-skip-regions-with-calls",
@@ -37,3 +41,176 @@ llvm::cl::opt<std::string> AtroxFunctionWhiteListFile(
     llvm::cl::desc("process only the specified functions"),
     llvm::cl::cat(AtroxCLCategory));
 
+llvm::cl::opt<bool> AtroxAnnotateParallelLoops(
+    "atrox-annotate-parallel-loops", llvm::cl::init(false),
+    llvm::cl::desc("mark payload accesses of loops certified as parallel"),
+    llvm::cl::cat(AtroxCLCategory));
+
+llvm::cl::opt<bool> AtroxPrivatizeReductions(
+    "atrox-privatize-reductions", llvm::cl::init(false),
+    llvm::cl::desc("compute partial results of reductions in payloads"),
+    llvm::cl::cat(AtroxCLCategory));
+
+llvm::cl::opt<double>
+    AtroxPeakGOPS("atrox-peak-gops", llvm::cl::init(100.0),
+                  llvm::cl::desc("peak machine compute rate in Gop/s"),
+                  llvm::cl::cat(AtroxCLCategory));
+
+llvm::cl::opt<double> AtroxPeakBandwidth(
+    "atrox-peak-bandwidth", llvm::cl::init(20.0),
+    llvm::cl::desc("peak machine memory bandwidth in GB/s"),
+    llvm::cl::cat(AtroxCLCategory));
+
+llvm::cl::opt<bool> AtroxPrefetch(
+    "atrox-prefetch", llvm::cl::init(false),
+    llvm::cl::desc("insert software prefetches for strided accesses in "
+                   "payloads"),
+    llvm::cl::cat(AtroxCLCategory));
+
+llvm::cl::opt<bool> AtroxPrefetchIndirect(
+    "atrox-prefetch-indirect", llvm::cl::init(false),
+    llvm::cl::desc("also prefetch indirect accesses through strided indices "
+                   "in payloads"),
+    llvm::cl::cat(AtroxCLCategory));
+
+llvm::cl::opt<unsigned> AtroxPrefetchDistance(
+    "atrox-prefetch-distance", llvm::cl::init(0),
+    llvm::cl::desc("prefetch distance in loop iterations (0 derives it from "
+                   "the prefetch latency and the payload weight)"),
+    llvm::cl::cat(AtroxCLCategory));
+
+llvm::cl::opt<unsigned> AtroxPrefetchLatency(
+    "atrox-prefetch-latency", llvm::cl::init(200),
+    llvm::cl::desc("memory latency to hide in payload weight units"),
+    llvm::cl::cat(AtroxCLCategory));
+
+llvm::cl::opt<unsigned>
+    AtroxCacheLineSize("atrox-cache-line-size", llvm::cl::init(64),
+                       llvm::cl::desc("cache line size in bytes"),
+                       llvm::cl::cat(AtroxCLCategory));
+
+llvm::cl::opt<bool> AtroxDSWP(
+    "atrox-dswp", llvm::cl::init(false),
+    llvm::cl::desc("replace payloads with a decoupled software pipeline that "
+                   "runs them on worker threads"),
+    llvm::cl::cat(AtroxCLCategory));
+
+llvm::cl::opt<unsigned>
+    AtroxDSWPWorkers("atrox-dswp-workers", llvm::cl::init(1),
+                     llvm::cl::desc("number of decoupled pipeline workers"),
+                     llvm::cl::cat(AtroxCLCategory));
+
+llvm::cl::opt<unsigned> AtroxDSWPCapacity(
+    "atrox-dswp-capacity", llvm::cl::init(1024),
+    llvm::cl::desc("capacity in iterations of each decoupled pipeline queue"),
+    llvm::cl::cat(AtroxCLCategory));
+
+llvm::cl::opt<bool> AtroxFission(
+    "atrox-fission", llvm::cl::init(false),
+    llvm::cl::desc("split loops into an iterator phase that gathers the "
+                   "payload inputs and a phase that runs the payload on them"),
+    llvm::cl::cat(AtroxCLCategory));
+
+llvm::cl::opt<unsigned> AtroxFissionCapacity(
+    "atrox-fission-capacity", llvm::cl::init(1024),
+    llvm::cl::desc("initial capacity in iterations of the fission buffer when "
+                   "the loop trip count is not bounded"),
+    llvm::cl::cat(AtroxCLCategory));
+
+llvm::cl::opt<bool> AtroxInterleave(
+    "atrox-interleave", llvm::cl::init(false),
+    llvm::cl::desc("run payloads with irregular loads as coroutines that "
+                   "prefetch and suspend, interleaving a group of iterations"),
+    llvm::cl::cat(AtroxCLCategory));
+
+llvm::cl::opt<unsigned> AtroxInterleaveGroup(
+    "atrox-interleave-group", llvm::cl::init(8),
+    llvm::cl::desc("number of interleaved payload iterations in flight"),
+    llvm::cl::cat(AtroxCLCategory));
+
+llvm::cl::opt<bool> AtroxSpecialize(
+    "atrox-specialize", llvm::cl::init(false),
+    llvm::cl::desc("specialize payloads for the values of their inputs that "
+                   "are known or expected at the loop"),
+    llvm::cl::cat(AtroxCLCategory));
+
+llvm::cl::opt<unsigned> AtroxSpecializeMaxTripCount(
+    "atrox-specialize-max-trip-count", llvm::cl::init(16),
+    llvm::cl::desc("largest bound of a nested loop trip count to specialize "
+                   "payloads for"),
+    llvm::cl::cat(AtroxCLCategory));
+
+llvm::cl::opt<atrox::ExtractionMode> AtroxExtractionMode(
+    "atrox-extraction-mode", llvm::cl::init(atrox::ExtractionMode::Clone),
+    llvm::cl::desc("what to do with the original loop of a payload"),
+    llvm::cl::values(
+        clEnumValN(atrox::ExtractionMode::Clone, "clone",
+                   "leave the loop untouched and only clone its payload"),
+        clEnumValN(atrox::ExtractionMode::Replace, "replace",
+                   "call the payload from the loop when it is profitable and "
+                   "emit nothing otherwise")),
+    llvm::cl::cat(AtroxCLCategory));
+
+llvm::cl::opt<unsigned> AtroxReplaceMaxOverhead(
+    "atrox-replace-max-overhead", llvm::cl::init(10),
+    llvm::cl::desc("largest call overhead as a percentage of the payload "
+                   "weight for replacing a payload with a call"),
+    llvm::cl::cat(AtroxCLCategory));
+
+llvm::cl::opt<unsigned> AtroxReplaceMinTripCount(
+    "atrox-replace-min-trip-count", llvm::cl::init(8),
+    llvm::cl::desc("smallest trip count bound of a loop for replacing its "
+                   "payload with a call"),
+    llvm::cl::cat(AtroxCLCategory));
+
+llvm::cl::opt<atrox::PayloadCostModel> AtroxPayloadCostModel(
+    "atrox-payload-cost-model", llvm::cl::init(atrox::PayloadCostModel::Table),
+    llvm::cl::desc("cost model of payload weights"),
+    llvm::cl::values(
+        clEnumValN(atrox::PayloadCostModel::Table, "table",
+                   "fixed weights for each kind of instruction"),
+        clEnumValN(atrox::PayloadCostModel::TTI, "tti",
+                   "instruction costs of the module target, falling back to "
+                   "the table when the target is not available")),
+    llvm::cl::cat(AtroxCLCategory));
+
+llvm::cl::opt<std::string> AtroxPayloadWeightsFile(
+    "atrox-payload-weights-file",
+    llvm::cl::desc("weight table written by atrox-calibrate to use instead "
+                   "of the built-in one"),
+    llvm::cl::cat(AtroxCLCategory));
+
+llvm::cl::opt<bool> AtroxProfileWeights(
+    "atrox-profile-weights", llvm::cl::init(false),
+    llvm::cl::desc("scale payload weights by block frequency, using profile "
+                   "counts when available"),
+    llvm::cl::cat(AtroxCLCategory));
+
+llvm::cl::opt<bool> AtroxInterchange(
+    "atrox-interchange", llvm::cl::init(false),
+    llvm::cl::desc("interchange loop nests in payloads whose inner loop walks "
+                   "arrays along a larger stride than their outer loop"),
+    llvm::cl::cat(AtroxCLCategory));
+
+llvm::cl::opt<bool> AtroxSoA(
+    "atrox-soa", llvm::cl::init(false),
+    llvm::cl::desc("create a variant of payloads that takes the accessed "
+                   "fields of arrays of structs as separate arrays"),
+    llvm::cl::cat(AtroxCLCategory));
+
+llvm::cl::opt<bool> AtroxTile(
+    "atrox-tile", llvm::cl::init(false),
+    llvm::cl::desc("tile loop nests in payloads whose inner loop walks "
+                   "across cache lines that the outer loop reuses"),
+    llvm::cl::cat(AtroxCLCategory));
+
+llvm::cl::opt<unsigned> AtroxTileCacheSize(
+    "atrox-tile-cache-size", llvm::cl::init(0),
+    llvm::cl::desc("size in bytes of the cache to select tile sizes for (0 "
+                   "reads it from the host)"),
+    llvm::cl::cat(AtroxCLCategory));
+
+llvm::cl::opt<unsigned> AtroxTileCacheLevel(
+    "atrox-tile-cache-level", llvm::cl::init(2),
+    llvm::cl::desc("level of the host data cache to select tile sizes for"),
+    llvm::cl::cat(AtroxCLCategory));
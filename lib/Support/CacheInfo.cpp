@@ -0,0 +1,69 @@
+//
+//
+//
+
+#include "Atrox/Support/CacheInfo.hpp"
+
+#include "llvm/Support/raw_ostream.h"
+// using llvm::raw_ostream
+
+#include "llvm/Support/Debug.h"
+// using LLVM_DEBUG macro
+// using llvm::dbgs
+
+#include <fstream>
+// using std::ifstream
+
+#include <string>
+// using std::string
+// using std::to_string
+
+#define DEBUG_TYPE "atrox-cache-info"
+
+namespace atrox {
+
+uint64_t GetDataCacheSize(unsigned Level) {
+  const std::string dir{"/sys/devices/system/cpu/cpu0/cache/index"};
+
+  for (unsigned i = 0;; ++i) {
+    std::ifstream levelFile{dir + std::to_string(i) + "/level"};
+
+    if (!levelFile) {
+      break;
+    }
+
+    unsigned level = 0;
+    std::string type;
+    std::ifstream typeFile{dir + std::to_string(i) + "/type"};
+
+    if (!(levelFile >> level) || !(typeFile >> type) || level != Level ||
+        type == "Instruction") {
+      continue;
+    }
+
+    uint64_t size = 0;
+    std::string unit;
+    std::ifstream sizeFile{dir + std::to_string(i) + "/size"};
+
+    if (!(sizeFile >> size)) {
+      continue;
+    }
+
+    sizeFile >> unit;
+
+    if (unit == "K") {
+      size *= 1024;
+    } else if (unit == "M") {
+      size *= 1024 * 1024;
+    }
+
+    LLVM_DEBUG(llvm::dbgs() << "level " << Level << " data cache size: " << size
+                            << '\n';);
+
+    return size;
+  }
+
+  return 0;
+}
+
+} // namespace atrox
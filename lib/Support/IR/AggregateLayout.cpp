@@ -0,0 +1,172 @@
+//
+//
+//
+
+#include "Atrox/Support/IR/AggregateLayout.hpp"
+
+#include "llvm/IR/DerivedTypes.h"
+// using llvm::StructType
+// using llvm::ArrayType
+
+#include "llvm/IR/DataLayout.h"
+// using llvm::DataLayout
+// using llvm::StructLayout
+
+#include "llvm/IR/Type.h"
+// using llvm::Type
+
+#include "llvm/Support/MathExtras.h"
+// using llvm::alignTo
+
+#include "llvm/Support/Debug.h"
+// using LLVM_DEBUG macro
+// using llvm::dbgs
+
+#include <algorithm>
+// using std::stable_sort
+
+#define DEBUG_TYPE "atrox-aggregate-layout"
+
+namespace atrox {
+
+namespace {
+
+constexpr int PaddingOwner = -1;
+
+struct BlockBuilder {
+  llvm::SmallVector<llvm::Type *, 16> Elements;
+  llvm::SmallVector<int, 16> Owners;
+
+  bool empty() const { return Elements.empty(); }
+
+  void add(llvm::Type *Ty, int Owner) {
+    Elements.push_back(Ty);
+    Owners.push_back(Owner);
+  }
+
+  uint64_t getEndOffset(const llvm::DataLayout &DL,
+                        llvm::LLVMContext &Ctx) const {
+    if (Elements.empty()) {
+      return 0;
+    }
+
+    auto *sl = DL.getStructLayout(llvm::StructType::get(Ctx, Elements));
+
+    return sl->getElementOffset(Elements.size() - 1) +
+           DL.getTypeAllocSize(Elements.back());
+  }
+
+  void padTo(unsigned Boundary, const llvm::DataLayout &DL,
+             llvm::LLVMContext &Ctx) {
+    auto end = getEndOffset(DL, Ctx);
+    auto size = llvm::alignTo(end, Boundary) - end;
+
+    if (size) {
+      add(llvm::ArrayType::get(llvm::Type::getInt8Ty(Ctx), size),
+          PaddingOwner);
+    }
+  }
+};
+
+} // namespace
+
+void ComputeAggregateLayout(llvm::ArrayRef<AggregateField> Fields,
+                            AggregateLayoutKind Kind, bool PrivateOutputs,
+                            unsigned CacheLineSize, const llvm::DataLayout &DL,
+                            llvm::LLVMContext &Ctx,
+                            llvm::SmallVectorImpl<llvm::StructType *> &Blocks,
+                            AggregateLayoutSpec &Spec) {
+  Spec = AggregateLayoutSpec{};
+  Spec.Kind = Kind;
+  Spec.PrivateOutputs =
+      Kind == AggregateLayoutKind::CacheAware && PrivateOutputs;
+  Spec.Fields.resize(Fields.size());
+
+  if (Fields.empty()) {
+    return;
+  }
+
+  llvm::SmallVector<BlockBuilder, 2> builders;
+
+  if (Kind == AggregateLayoutKind::Discovery) {
+    builders.emplace_back();
+
+    for (size_t i = 0; i < Fields.size(); ++i) {
+      builders.back().add(Fields[i].Ty, i);
+    }
+  } else {
+    llvm::SmallVector<int, 16> readOnly, writable;
+
+    for (size_t i = 0; i < Fields.size(); ++i) {
+      (Fields[i].Writable ? writable : readOnly).push_back(i);
+    }
+
+    auto bySizeAndAlignment = [&](int e1, int e2) {
+      auto s1 = DL.getTypeAllocSize(Fields[e1].Ty);
+      auto s2 = DL.getTypeAllocSize(Fields[e2].Ty);
+
+      if (s1 != s2) {
+        return s1 > s2;
+      }
+
+      return DL.getABITypeAlignment(Fields[e1].Ty) >
+             DL.getABITypeAlignment(Fields[e2].Ty);
+    };
+
+    std::stable_sort(readOnly.begin(), readOnly.end(), bySizeAndAlignment);
+    std::stable_sort(writable.begin(), writable.end(), bySizeAndAlignment);
+
+    builders.emplace_back();
+
+    for (auto e : readOnly) {
+      builders.back().add(Fields[e].Ty, e);
+    }
+
+    if (!writable.empty()) {
+      if (Spec.PrivateOutputs && !builders.back().empty()) {
+        builders.emplace_back();
+      } else {
+        builders.back().padTo(CacheLineSize, DL, Ctx);
+      }
+
+      for (auto e : writable) {
+        builders.back().add(Fields[e].Ty, e);
+      }
+
+      builders.back().padTo(CacheLineSize, DL, Ctx);
+    }
+  }
+
+  for (unsigned b = 0; b < builders.size(); ++b) {
+    auto &builder = builders[b];
+    auto *blockTy = llvm::StructType::get(Ctx, builder.Elements);
+    auto *sl = DL.getStructLayout(blockTy);
+
+    Blocks.push_back(blockTy);
+    Spec.BlockSizes.push_back(DL.getTypeAllocSize(blockTy));
+
+    for (unsigned i = 0; i < builder.Owners.size(); ++i) {
+      if (builder.Owners[i] == PaddingOwner) {
+        continue;
+      }
+
+      const auto &field = Fields[builder.Owners[i]];
+      Spec.Fields[builder.Owners[i]] = {field.Name,
+                                        b,
+                                        i,
+                                        sl->getElementOffset(i),
+                                        DL.getTypeAllocSize(field.Ty),
+                                        field.Writable};
+    }
+
+    LLVM_DEBUG(llvm::dbgs() << "aggregate block " << b << ": " << *blockTy
+                            << '\n';);
+  }
+
+  Spec.Alignment = Kind == AggregateLayoutKind::CacheAware
+                       ? CacheLineSize
+                       : DL.getABITypeAlignment(Blocks.front());
+}
+
+} // namespace atrox
+
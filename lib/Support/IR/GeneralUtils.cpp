@@ -16,12 +16,19 @@
 #include "llvm/IR/Function.h"
 // using llvm::Function
 
+#include "llvm/IR/GlobalValue.h"
+// using llvm::GlobalValue
+
+#include "llvm/IR/CallingConv.h"
+// using llvm::CallingConv
+
 #include "llvm/Support/Debug.h"
 // using LLVM_DEBUG macro
 // using llvm::dbgs
 
 #include <algorithm>
 // using std::for_each
+// using std::find
 
 #define DEBUG_TYPE "atrox-general-utils"
 
@@ -54,6 +61,33 @@ bool IsIgnoredIntrinsic(const llvm::Value *V) {
   return false;
 }
 
+bool InternalizePayload(llvm::Function &F,
+                        llvm::ArrayRef<llvm::CallInst *> Calls) {
+  if (F.isDeclaration()) {
+    return false;
+  }
+
+  for (auto *u : F.users()) {
+    auto *call = llvm::dyn_cast<llvm::CallInst>(u);
+
+    if (!call || call->getCalledFunction() != &F ||
+        std::find(Calls.begin(), Calls.end(), call) == Calls.end()) {
+      LLVM_DEBUG(llvm::dbgs() << "not internalizing payload: " << F.getName()
+                              << '\n';);
+      return false;
+    }
+  }
+
+  F.setLinkage(llvm::GlobalValue::InternalLinkage);
+  F.setCallingConv(llvm::CallingConv::Fast);
+
+  for (auto *call : Calls) {
+    call->setCallingConv(llvm::CallingConv::Fast);
+  }
+
+  return true;
+}
+
 //
 
 void InstructionEraser::visitIntrinsicInst(llvm::IntrinsicInst &I) {
@@ -0,0 +1,430 @@
+//
+//
+//
+
+#include "Atrox/Transforms/CoroutineInterleaver.hpp"
+
+#include "Atrox/Transforms/PayloadRegion.hpp"
+
+#include "llvm/Config/llvm-config.h"
+// using LLVM_VERSION_MAJOR
+
+#include "llvm/Analysis/LoopInfo.h"
+// using llvm::Loop
+
+#include "llvm/IR/Function.h"
+// using llvm::Function
+
+#include "llvm/IR/Module.h"
+// using llvm::Module
+
+#include "llvm/IR/DataLayout.h"
+// using llvm::DataLayout
+
+#include "llvm/IR/DerivedTypes.h"
+// using llvm::ArrayType
+// using llvm::FunctionType
+// using llvm::PointerType
+
+#include "llvm/IR/Constants.h"
+// using llvm::ConstantPointerNull
+// using llvm::ConstantAggregateZero
+// using llvm::ConstantTokenNone
+
+#include "llvm/IR/Instructions.h"
+// using llvm::LoadInst
+// using llvm::AllocaInst
+// using llvm::ReturnInst
+// using llvm::BranchInst
+// using llvm::SwitchInst
+// using llvm::PHINode
+
+#include "llvm/IR/Intrinsics.h"
+// using llvm::Intrinsic::getDeclaration
+
+#include "llvm/IR/IRBuilder.h"
+// using llvm::IRBuilder
+
+#include "llvm/Transforms/Utils/Cloning.h"
+// using llvm::CloneFunctionInto
+
+#include "llvm/Transforms/Utils/ValueMapper.h"
+// using llvm::ValueToValueMapTy
+
+#include "llvm/ADT/SmallVector.h"
+// using llvm::SmallVector
+
+#include "llvm/Support/Debug.h"
+// using LLVM_DEBUG macro
+// using llvm::dbgs
+
+#define DEBUG_TYPE "atrox-interleave"
+
+namespace {
+
+llvm::CallInst *CreatePrefetch(llvm::Value *Ptr, llvm::IRBuilder<> &Builder) {
+  auto *m = Builder.GetInsertBlock()->getModule();
+  auto *addr = Builder.CreateBitCast(
+      Ptr, Builder.getInt8PtrTy(Ptr->getType()->getPointerAddressSpace()));
+
+#if LLVM_VERSION_MAJOR >= 10
+  auto *prefetch = llvm::Intrinsic::getDeclaration(
+      m, llvm::Intrinsic::prefetch, {addr->getType()});
+#else
+  auto *prefetch =
+      llvm::Intrinsic::getDeclaration(m, llvm::Intrinsic::prefetch);
+#endif
+
+  return Builder.CreateCall(prefetch, {addr, Builder.getInt32(0),
+                                       Builder.getInt32(3),
+                                       Builder.getInt32(1)});
+}
+
+// emit a loop that resumes the coroutines of the given slots round-robin
+// until all of them are done, and continue to the given block
+void CreateDrain(llvm::Value *Handles, llvm::ArrayType *HandlesTy,
+                 llvm::BasicBlock &Entry, llvm::BasicBlock &Continue) {
+  auto &ctx = Entry.getContext();
+  auto *m = Entry.getModule();
+  auto *F = Entry.getParent();
+  auto *i8PtrTy = llvm::Type::getInt8PtrTy(ctx);
+  auto *nullHandle = llvm::ConstantPointerNull::get(i8PtrTy);
+
+  auto *doneFunc =
+      llvm::Intrinsic::getDeclaration(m, llvm::Intrinsic::coro_done);
+  auto *resumeFunc =
+      llvm::Intrinsic::getDeclaration(m, llvm::Intrinsic::coro_resume);
+  auto *destroyFunc =
+      llvm::Intrinsic::getDeclaration(m, llvm::Intrinsic::coro_destroy);
+
+  auto *pass = llvm::BasicBlock::Create(ctx, "drain.pass", F, &Continue);
+  auto *scan = llvm::BasicBlock::Create(ctx, "drain.scan", F, &Continue);
+  auto *step = llvm::BasicBlock::Create(ctx, "drain.step", F, &Continue);
+  auto *resume = llvm::BasicBlock::Create(ctx, "drain.resume", F, &Continue);
+  auto *finish = llvm::BasicBlock::Create(ctx, "drain.finish", F, &Continue);
+  auto *next = llvm::BasicBlock::Create(ctx, "drain.next", F, &Continue);
+
+  llvm::IRBuilder<> builder{&Entry};
+  builder.CreateBr(pass);
+
+  builder.SetInsertPoint(pass);
+  builder.CreateBr(scan);
+
+  builder.SetInsertPoint(scan);
+  auto *k = builder.CreatePHI(builder.getInt32Ty(), 2, "drain.slot");
+  auto *isLive = builder.CreatePHI(builder.getInt1Ty(), 2, "drain.live");
+  k->addIncoming(builder.getInt32(0), pass);
+  isLive->addIncoming(builder.getFalse(), pass);
+
+  auto *slot = builder.CreateInBoundsGEP(HandlesTy, Handles,
+                                         {builder.getInt32(0), k});
+  auto *handle = builder.CreateLoad(i8PtrTy, slot);
+  builder.CreateCondBr(builder.CreateICmpEQ(handle, nullHandle), next, step);
+
+  builder.SetInsertPoint(step);
+  builder.CreateCondBr(builder.CreateCall(doneFunc, handle), finish, resume);
+
+  builder.SetInsertPoint(resume);
+  builder.CreateCall(resumeFunc, handle);
+  builder.CreateBr(next);
+
+  builder.SetInsertPoint(finish);
+  builder.CreateCall(destroyFunc, handle);
+  builder.CreateStore(nullHandle, slot);
+  builder.CreateBr(next);
+
+  builder.SetInsertPoint(next);
+  auto *isStillLive = builder.CreatePHI(builder.getInt1Ty(), 3);
+  isStillLive->addIncoming(isLive, scan);
+  isStillLive->addIncoming(builder.getTrue(), resume);
+  isStillLive->addIncoming(isLive, finish);
+
+  auto *kNext = builder.CreateAdd(k, builder.getInt32(1));
+  k->addIncoming(kNext, next);
+  isLive->addIncoming(isStillLive, next);
+
+  auto *passDone = llvm::BasicBlock::Create(ctx, "drain.again", F, &Continue);
+  auto *isLast = builder.CreateICmpEQ(
+      kNext, builder.getInt32(HandlesTy->getNumElements()));
+  builder.CreateCondBr(isLast, passDone, scan);
+
+  // start another pass while any coroutine was resumed in this one
+  builder.SetInsertPoint(passDone);
+  builder.CreateCondBr(isStillLive, pass, &Continue);
+}
+
+} // namespace
+
+namespace atrox {
+
+llvm::Function *CreatePayloadCoroutine(llvm::Function &Payload,
+                                       llvm::ArrayRef<llvm::LoadInst *> Loads) {
+  auto &M = *Payload.getParent();
+  auto &ctx = Payload.getContext();
+  const auto &DL = M.getDataLayout();
+  auto *i8PtrTy = llvm::Type::getInt8PtrTy(ctx);
+  auto *sizeTy = DL.getIntPtrType(ctx);
+
+  auto *coroTy = llvm::FunctionType::get(
+      i8PtrTy, Payload.getFunctionType()->params(), false);
+  auto *coro =
+      llvm::Function::Create(coroTy, llvm::GlobalValue::InternalLinkage,
+                             Payload.getName() + ".coro", &M);
+
+  llvm::ValueToValueMapTy vmap;
+  auto argIt = coro->arg_begin();
+  for (auto &e : Payload.args()) {
+    argIt->setName(e.getName());
+    vmap[&e] = &*argIt++;
+  }
+
+  llvm::SmallVector<llvm::ReturnInst *, 4> returns;
+#if LLVM_VERSION_MAJOR >= 13
+  llvm::CloneFunctionInto(coro, &Payload, vmap,
+                          llvm::CloneFunctionChangeType::LocalChangesOnly,
+                          returns);
+#else
+  llvm::CloneFunctionInto(coro, &Payload, vmap, false, returns);
+#endif
+  coro->setCallingConv(llvm::CallingConv::C);
+
+  // the coroutine passes only lower functions marked as not yet split, which
+  // the frontend is expected to do since LLVM 13
+#if LLVM_VERSION_MAJOR >= 15
+  coro->addFnAttr(llvm::Attribute::PresplitCoroutine);
+#elif LLVM_VERSION_MAJOR >= 13
+  coro->addFnAttr("coroutine.presplit", "0");
+#endif
+
+  auto *body = &coro->getEntryBlock();
+  auto *entry = llvm::BasicBlock::Create(ctx, "coro.entry", coro, body);
+  auto *alloc = llvm::BasicBlock::Create(ctx, "coro.alloc", coro, body);
+  auto *begin = llvm::BasicBlock::Create(ctx, "coro.begin", coro, body);
+  auto *finalSuspend = llvm::BasicBlock::Create(ctx, "coro.final", coro);
+  auto *trap = llvm::BasicBlock::Create(ctx, "coro.trap", coro);
+  auto *cleanup = llvm::BasicBlock::Create(ctx, "coro.cleanup", coro);
+  auto *suspend = llvm::BasicBlock::Create(ctx, "coro.suspend", coro);
+
+  auto *idFunc = llvm::Intrinsic::getDeclaration(&M, llvm::Intrinsic::coro_id);
+  auto *allocFunc =
+      llvm::Intrinsic::getDeclaration(&M, llvm::Intrinsic::coro_alloc);
+  auto *sizeFunc =
+      llvm::Intrinsic::getDeclaration(&M, llvm::Intrinsic::coro_size, sizeTy);
+  auto *beginFunc =
+      llvm::Intrinsic::getDeclaration(&M, llvm::Intrinsic::coro_begin);
+  auto *suspendFunc =
+      llvm::Intrinsic::getDeclaration(&M, llvm::Intrinsic::coro_suspend);
+  auto *freeFunc =
+      llvm::Intrinsic::getDeclaration(&M, llvm::Intrinsic::coro_free);
+  auto *endFunc =
+      llvm::Intrinsic::getDeclaration(&M, llvm::Intrinsic::coro_end);
+  auto *mallocFunc = GetRuntimeFunction(
+      M, "malloc", llvm::FunctionType::get(i8PtrTy, {sizeTy}, false));
+  auto *releaseFunc = GetRuntimeFunction(
+      M, "free",
+      llvm::FunctionType::get(llvm::Type::getVoidTy(ctx), {i8PtrTy}, false));
+
+  auto *nullPtr = llvm::ConstantPointerNull::get(i8PtrTy);
+  auto *noSave = llvm::ConstantTokenNone::get(ctx);
+
+  // the static allocas of the payload are spilled to the coroutine frame only
+  // if they are in the entry block
+  llvm::SmallVector<llvm::AllocaInst *, 4> allocas;
+  for (auto &i : *body) {
+    auto *alloca = llvm::dyn_cast<llvm::AllocaInst>(&i);
+
+    if (alloca && alloca->isStaticAlloca()) {
+      allocas.push_back(alloca);
+    }
+  }
+
+  llvm::IRBuilder<> builder{entry};
+
+  for (auto *e : allocas) {
+    e->moveBefore(*entry, entry->end());
+  }
+
+  auto *id = builder.CreateCall(
+      idFunc, {builder.getInt32(0), nullPtr, nullPtr, nullPtr}, "coro.id");
+  builder.CreateCondBr(builder.CreateCall(allocFunc, id), alloc, begin);
+
+  builder.SetInsertPoint(alloc);
+  auto *mem =
+      builder.CreateCall(mallocFunc, builder.CreateCall(sizeFunc, {}), "mem");
+  builder.CreateBr(begin);
+
+  builder.SetInsertPoint(begin);
+  auto *frame = builder.CreatePHI(i8PtrTy, 2, "coro.frame");
+  frame->addIncoming(nullPtr, entry);
+  frame->addIncoming(mem, alloc);
+  auto *handle = builder.CreateCall(beginFunc, {id, frame}, "coro.handle");
+  builder.CreateBr(body);
+
+  for (auto *e : returns) {
+    llvm::BranchInst::Create(finalSuspend, e);
+    e->eraseFromParent();
+  }
+
+  // the handle is checked for completion, so the last suspend point is final
+  builder.SetInsertPoint(finalSuspend);
+  auto *state = builder.CreateCall(suspendFunc, {noSave, builder.getTrue()});
+  auto *sw = builder.CreateSwitch(state, suspend, 2);
+  sw->addCase(builder.getInt8(0), trap);
+  sw->addCase(builder.getInt8(1), cleanup);
+
+  builder.SetInsertPoint(trap);
+  builder.CreateUnreachable();
+
+  builder.SetInsertPoint(cleanup);
+  builder.CreateCall(releaseFunc, builder.CreateCall(freeFunc, {id, handle}));
+  builder.CreateBr(suspend);
+
+  builder.SetInsertPoint(suspend);
+  builder.CreateCall(endFunc, {handle, builder.getFalse()});
+  builder.CreateRet(handle);
+
+  for (auto *e : Loads) {
+    auto *load = llvm::cast<llvm::LoadInst>(vmap[e]);
+    auto *bb = load->getParent();
+
+    builder.SetInsertPoint(load);
+    CreatePrefetch(load->getPointerOperand(), builder);
+    state = builder.CreateCall(suspendFunc, {noSave, builder.getFalse()});
+
+    auto *resume = bb->splitBasicBlock(load, "coro.resume");
+    bb->getTerminator()->eraseFromParent();
+    builder.SetInsertPoint(bb);
+    sw = builder.CreateSwitch(state, suspend, 2);
+    sw->addCase(builder.getInt8(0), resume);
+    sw->addCase(builder.getInt8(1), cleanup);
+  }
+
+  LLVM_DEBUG(llvm::dbgs() << "created coroutine: " << coro->getName()
+                          << " with " << Loads.size() << " suspend points\n";);
+
+  return coro;
+}
+
+bool CreateInterleavedExecution(
+    llvm::Loop &L, llvm::ArrayRef<llvm::BasicBlock *> PayloadBlocks,
+    llvm::Function &Payload, llvm::ArrayRef<llvm::Value *> Inputs,
+    llvm::ArrayRef<llvm::LoadInst *> Loads, unsigned GroupSize,
+    InterleavingSpec *Spec) {
+  auto *preheader = L.getLoopPreheader();
+  auto *loopExit = L.getExitBlock();
+
+  if (!preheader || !loopExit || loopExit->isEHPad() || Loads.empty() ||
+      !GroupSize || !Payload.getReturnType()->isVoidTy() ||
+      Payload.arg_size() != Inputs.size()) {
+    LLVM_DEBUG(llvm::dbgs() << "cannot interleave payload: "
+                            << Payload.getName() << '\n';);
+    return false;
+  }
+
+  // replace the payload region with starting the payload coroutine
+
+  auto *issue = ReplacePayloadRegion(PayloadBlocks, "interleave.issue");
+
+  if (!issue) {
+    LLVM_DEBUG(llvm::dbgs() << "cannot replace payload region: "
+                            << Payload.getName() << '\n';);
+    return false;
+  }
+
+  auto &F = *issue->getParent();
+  auto &M = *F.getParent();
+  auto &ctx = F.getContext();
+  auto *i8PtrTy = llvm::Type::getInt8PtrTy(ctx);
+  auto *nullHandle = llvm::ConstantPointerNull::get(i8PtrTy);
+
+  auto *coro = CreatePayloadCoroutine(Payload, Loads);
+
+  auto *doneFunc =
+      llvm::Intrinsic::getDeclaration(&M, llvm::Intrinsic::coro_done);
+  auto *resumeFunc =
+      llvm::Intrinsic::getDeclaration(&M, llvm::Intrinsic::coro_resume);
+  auto *destroyFunc =
+      llvm::Intrinsic::getDeclaration(&M, llvm::Intrinsic::coro_destroy);
+
+  auto *handlesTy = llvm::ArrayType::get(i8PtrTy, GroupSize);
+  llvm::IRBuilder<> builder{&*F.getEntryBlock().getFirstInsertionPt()};
+  auto *handles = builder.CreateAlloca(handlesTy, nullptr, "interleave.group");
+  auto *next = builder.CreateAlloca(builder.getInt32Ty(), nullptr,
+                                    "interleave.next");
+
+  builder.SetInsertPoint(preheader->getTerminator());
+  builder.CreateStore(llvm::ConstantAggregateZero::get(handlesTy), handles);
+  builder.CreateStore(builder.getInt32(0), next);
+
+  auto *create = issue->splitBasicBlock(issue->getTerminator(),
+                                        "interleave.create");
+  issue->getTerminator()->eraseFromParent();
+
+  auto *scan = llvm::BasicBlock::Create(ctx, "interleave.scan", &F, create);
+  auto *check = llvm::BasicBlock::Create(ctx, "interleave.check", &F, create);
+  auto *step = llvm::BasicBlock::Create(ctx, "interleave.step", &F, create);
+  auto *finish =
+      llvm::BasicBlock::Create(ctx, "interleave.finish", &F, create);
+  auto *advance =
+      llvm::BasicBlock::Create(ctx, "interleave.advance", &F, create);
+
+  builder.SetInsertPoint(issue);
+  auto *first = builder.CreateLoad(builder.getInt32Ty(), next);
+  builder.CreateBr(scan);
+
+  builder.SetInsertPoint(scan);
+  auto *k = builder.CreatePHI(builder.getInt32Ty(), 2, "interleave.slot");
+  k->addIncoming(first, issue);
+  auto *slot =
+      builder.CreateInBoundsGEP(handlesTy, handles, {builder.getInt32(0), k});
+  auto *handle = builder.CreateLoad(i8PtrTy, slot);
+  builder.CreateCondBr(builder.CreateICmpEQ(handle, nullHandle), create,
+                       check);
+
+  // a coroutine might be done without being resumed
+  builder.SetInsertPoint(check);
+  builder.CreateCondBr(builder.CreateCall(doneFunc, handle), finish, step);
+
+  builder.SetInsertPoint(step);
+  builder.CreateCall(resumeFunc, handle);
+  builder.CreateCondBr(builder.CreateCall(doneFunc, handle), finish, advance);
+
+  builder.SetInsertPoint(finish);
+  builder.CreateCall(destroyFunc, handle);
+  builder.CreateBr(create);
+
+  auto wrapAround = [&builder, GroupSize](llvm::Value *V) {
+    auto *inc = builder.CreateAdd(V, builder.getInt32(1));
+    return builder.CreateSelect(
+        builder.CreateICmpEQ(inc, builder.getInt32(GroupSize)),
+        builder.getInt32(0), inc);
+  };
+
+  builder.SetInsertPoint(advance);
+  k->addIncoming(wrapAround(k), advance);
+  builder.CreateBr(scan);
+
+  builder.SetInsertPoint(create->getTerminator());
+  builder.CreateStore(builder.CreateCall(coro, Inputs), slot);
+  builder.CreateStore(wrapAround(k), next);
+
+  // finish the coroutines still in flight when the iterator is done
+
+  auto *end = loopExit->splitBasicBlock(loopExit->getFirstInsertionPt(),
+                                        "interleave.end");
+  loopExit->getTerminator()->eraseFromParent();
+  CreateDrain(handles, handlesTy, *loopExit, *end);
+
+  if (Spec) {
+    Spec->Coroutine = coro->getName().str();
+    Spec->GroupSize = GroupSize;
+    Spec->SuspendPoints = Loads.size();
+  }
+
+  LLVM_DEBUG(llvm::dbgs() << "interleaved payload: " << Payload.getName()
+                          << '\n';);
+
+  return true;
+}
+
+} // namespace atrox
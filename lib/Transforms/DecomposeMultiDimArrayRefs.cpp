@@ -4,6 +4,11 @@
 
 #include "Atrox/Transforms/DecomposeMultiDimArrayRefs.hpp"
 
+#include "Atrox/Analysis/ArrayDelinearizer.hpp"
+
+#include "llvm/Config/llvm-config.h"
+// using LLVM_VERSION_MAJOR
+
 #include "llvm/IR/Value.h"
 // using llvm::Value
 
@@ -22,6 +27,61 @@
 #include "llvm/IR/IRBuilder.h"
 // using llvm::IRBuilder
 
+#include "llvm/IR/Dominators.h"
+// using llvm::DominatorTree
+
+#include "llvm/IR/DataLayout.h"
+// using llvm::DataLayout
+
+#include "llvm/IR/GlobalVariable.h"
+// using llvm::GlobalVariable
+
+#include "llvm/Analysis/LoopInfo.h"
+// using llvm::LoopInfo
+
+#include "llvm/Analysis/ValueTracking.h"
+// using llvm::isKnownNonNegative
+// using llvm::GetUnderlyingObject
+
+#include "llvm/Analysis/ScalarEvolution.h"
+// using llvm::ScalarEvolution
+
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
+// using llvm::SCEVAddRecExpr
+// using llvm::SCEVConstant
+
+#if LLVM_VERSION_MAJOR >= 11
+#include "llvm/Transforms/Utils/ScalarEvolutionExpander.h"
+#else
+#include "llvm/Analysis/ScalarEvolutionExpander.h"
+#endif
+// using llvm::SCEVExpander
+
+#include "llvm/Transforms/Utils/Local.h"
+// using llvm::RecursivelyDeleteTriviallyDeadInstructions
+
+#include "llvm/IR/Operator.h"
+// using llvm::GEPOperator
+
+#include "llvm/Analysis/AliasAnalysis.h"
+// using llvm::AAResults
+// using llvm::isModSet
+
+#include "llvm/Analysis/MemoryLocation.h"
+// using llvm::MemoryLocation
+
+#include "llvm/Analysis/CFG.h"
+// using llvm::isPotentiallyReachable
+
+#include "llvm/IR/LLVMContext.h"
+// using llvm::LLVMContext
+
+#include "llvm/IR/Metadata.h"
+// using llvm::MDNode
+
+#include "llvm/ADT/DenseMap.h"
+// using llvm::DenseMap
+
 #include "llvm/Support/Debug.h"
 // using LLVM_DEBUG macro
 // using llvm::dbgs
@@ -35,6 +95,16 @@
 
 #include <algorithm>
 // using std::copy
+// using std::all_of
+
+#include <map>
+// using std::map
+
+#include <utility>
+// using std::pair
+
+#include <tuple>
+// using std::tuple
 
 #define DEBUG_TYPE "atrox-decompose-array-refs"
 
@@ -98,78 +168,689 @@ void GetDecomposedArraySizes(const llvm::PointerType *PtrTy,
   return;
 }
 
-bool FlattenMultiDimArrayIndices(llvm::GetElementPtrInst *GEP) {
-  bool changed = false;
+namespace {
 
-  if (!GEP) {
-    return changed;
+// the earliest point where all given values are available or nullptr if that
+// is right after a terminator
+llvm::Instruction *GetHoistPoint(llvm::ArrayRef<llvm::Value *> Operands,
+                                 llvm::Function &F,
+                                 const llvm::DominatorTree &DT) {
+  llvm::Instruction *latest = nullptr;
+
+  for (auto *e : Operands) {
+    auto *inst = llvm::dyn_cast<llvm::Instruction>(e);
+
+    if (inst && (!latest || DT.dominates(latest, inst))) {
+      latest = inst;
+    }
   }
 
-  llvm::SmallVector<uint64_t, 8> sizes;
-  GetDecomposedArraySizes(
-      llvm::dyn_cast<llvm::PointerType>(GEP->getPointerOperandType()), sizes);
+  if (!latest) {
+    return &*F.getEntryBlock().getFirstInsertionPt();
+  }
 
-  if (sizes.size() <= 1) {
-    return changed;
+  if (llvm::isa<llvm::PHINode>(latest)) {
+    return &*latest->getParent()->getFirstInsertionPt();
   }
 
-  llvm::SmallVector<uint64_t, 8> products;
-  products.resize(sizes.size());
+  return latest->isTerminator() ? nullptr : latest->getNextNode();
+}
 
-  products[0] = 1u;
-  std::reverse(sizes.begin(), sizes.end());
+// flattens the array accesses of a function, while sharing the common row
+// computations between accesses and bumping the innermost loop accesses
+class IndexFlattener {
+  llvm::DominatorTree &DT;
+  llvm::LoopInfo &LI;
+  const llvm::DataLayout &DL;
+  llvm::DenseMap<llvm::Value *, llvm::Value *> BasePtrs;
+  // keyed by the inbounds flag, the base pointer and the row indices
+  std::map<std::pair<bool, std::vector<llvm::Value *>>, llvm::Value *> RowPtrs;
+  std::map<std::pair<llvm::Value *, llvm::Value *>, llvm::Value *> BumpedPtrs;
+
+  llvm::Value *getBasePtr(llvm::Value *Base, llvm::Type *Ty,
+                          llvm::Function &F) {
+    auto found = BasePtrs.find(Base);
+
+    if (found != BasePtrs.end()) {
+      return found->second;
+    }
 
-  for (auto i = 1u; i < products.size(); ++i) {
-    products[i] = products[i - 1] * sizes[i - 1];
+    auto *ip = GetHoistPoint(Base, F, DT);
+
+    if (!ip) {
+      return nullptr;
+    }
+
+    llvm::IRBuilder<> builder{ip};
+    auto *ptr = builder.CreatePointerCast(Base, Ty, "ptrcast");
+    BasePtrs.insert({Base, ptr});
+
+    return ptr;
   }
 
-  LLVM_DEBUG(llvm::dbgs() << "product sizes: ";
-             for (auto e
-                  : products) { llvm::dbgs() << e << ' '; };
-             llvm::dbgs() << '\n';);
+  llvm::Value *getRowPtr(llvm::GetElementPtrInst *GEP, llvm::Value *BasePtr,
+                         llvm::Type *ElemTy,
+                         llvm::ArrayRef<llvm::Value *> Indices,
+                         llvm::ArrayRef<uint64_t> Strides) {
+    bool isInBounds = GEP->isInBounds();
+    std::vector<llvm::Value *> operands{BasePtr};
+    operands.insert(operands.end(), Indices.begin(), Indices.end());
+
+    auto key = std::make_pair(isInBounds, operands);
+    auto found = RowPtrs.find(key);
+
+    if (found != RowPtrs.end()) {
+      return found->second;
+    }
+
+    // rows that cannot be hoisted are not shared
+    auto *ip = GetHoistPoint(operands, *GEP->getFunction(), DT);
+    bool isShared = ip != nullptr;
+
+    if (!ip) {
+      ip = GEP;
+    }
+
+    // inbounds offsets do not overflow as signed values and do not wrap
+    // either if none of their indices is negative
+    bool hasNSW = isInBounds;
+    bool hasNUW =
+        hasNSW && std::all_of(Indices.begin(), Indices.end(), [this](auto *e) {
+          return llvm::isKnownNonNegative(e, DL);
+        });
+
+    llvm::IRBuilder<> builder{ip};
+    auto *idxTy = DL.getIntPtrType(GEP->getType());
+    llvm::Value *offset = nullptr;
+
+    for (size_t i = 0; i < Indices.size(); ++i) {
+      auto *c = llvm::dyn_cast<llvm::ConstantInt>(Indices[i]);
+
+      if (c && c->isZero()) {
+        continue;
+      }
+
+      llvm::Value *idx = builder.CreateSExtOrTrunc(Indices[i], idxTy);
+
+      if (Strides[i] != 1) {
+        idx = builder.CreateMul(idx, llvm::ConstantInt::get(idxTy, Strides[i]),
+                                "scaled.idx", hasNUW, hasNSW);
+      }
+
+      offset = offset ? builder.CreateAdd(offset, idx, "summed.idx", hasNUW,
+                                          hasNSW)
+                      : idx;
+    }
+
+    llvm::Value *row = BasePtr;
+
+    if (offset) {
+      row = isInBounds
+                ? builder.CreateInBoundsGEP(ElemTy, BasePtr, offset, "row.ptr")
+                : builder.CreateGEP(ElemTy, BasePtr, offset, "row.ptr");
+    }
+
+    if (isShared) {
+      RowPtrs.insert({key, row});
+    }
+
+    return row;
+  }
 
-  llvm::SmallVector<llvm::Value *, 8> scaledIndices, summedIndices;
-  scaledIndices.resize(sizes.size());
+  // a pointer that is bumped along with the induction variable used as the
+  // last index of an innermost loop access, if its row is loop invariant
+  llvm::Value *getBumpedPtr(llvm::GetElementPtrInst *GEP, llvm::Value *RowPtr,
+                            llvm::Type *ElemTy, llvm::Value *Idx) {
+    auto *curLoop = LI.getLoopFor(GEP->getParent());
 
-  llvm::SmallVector<llvm::Value *, 8> indices{std::next(GEP->idx_begin()),
-                                              GEP->idx_end()};
-  std::reverse(indices.begin(), indices.end());
+    if (!curLoop || !curLoop->empty() || !curLoop->isLoopInvariant(RowPtr)) {
+      return nullptr;
+    }
+
+    auto found = BumpedPtrs.find({RowPtr, Idx});
+
+    if (found != BumpedPtrs.end()) {
+      return found->second;
+    }
+
+    auto *preheader = curLoop->getLoopPreheader();
+    auto *latch = curLoop->getLoopLatch();
+    auto *cast = llvm::dyn_cast<llvm::CastInst>(Idx);
+    auto *phi = llvm::dyn_cast<llvm::PHINode>(cast ? cast->getOperand(0) : Idx);
+
+    if (!preheader || !latch || !phi ||
+        phi->getParent() != curLoop->getHeader() ||
+        phi->getNumIncomingValues() != 2) {
+      return nullptr;
+    }
+
+    bool isZExt = cast && llvm::isa<llvm::ZExtInst>(cast);
+
+    if (cast && !isZExt && !llvm::isa<llvm::SExtInst>(cast)) {
+      return nullptr;
+    }
+
+    auto *inc = llvm::dyn_cast<llvm::BinaryOperator>(
+        phi->getIncomingValueForBlock(latch));
+
+    if (!inc || inc->getOpcode() != llvm::Instruction::Add ||
+        !(isZExt ? inc->hasNoUnsignedWrap() : inc->hasNoSignedWrap())) {
+      return nullptr;
+    }
+
+    auto *step = llvm::dyn_cast<llvm::ConstantInt>(
+        inc->getOperand(0) == phi ? inc->getOperand(1) : inc->getOperand(0));
+
+    if (!step || (inc->getOperand(0) != phi && inc->getOperand(1) != phi)) {
+      return nullptr;
+    }
+
+    auto *idxTy = DL.getIntPtrType(GEP->getType());
+    auto extend = [isZExt, idxTy](llvm::IRBuilder<> &Builder, llvm::Value *V) {
+      return isZExt ? Builder.CreateZExtOrTrunc(V, idxTy)
+                    : Builder.CreateSExtOrTrunc(V, idxTy);
+    };
+
+    llvm::IRBuilder<> builder{preheader->getTerminator()};
+    auto *start = builder.CreateGEP(
+        ElemTy, RowPtr,
+        extend(builder, phi->getIncomingValueForBlock(preheader)),
+        "bumped.start");
+
+    builder.SetInsertPoint(&curLoop->getHeader()->front());
+    auto *ptr = builder.CreatePHI(GEP->getType(), 2, "bumped.ptr");
 
-  llvm::IRBuilder<> builder{GEP};
-  changed = true;
+    builder.SetInsertPoint(latch->getTerminator());
+    auto *next =
+        builder.CreateGEP(ElemTy, ptr, extend(builder, step), "bumped.next");
 
-  for (size_t i = 0; i < scaledIndices.size(); ++i) {
-    scaledIndices[i] = builder.CreateMul(
-        indices[i], builder.getInt64(products[i]), "scaled.idx");
+    ptr->addIncoming(start, preheader);
+    ptr->addIncoming(next, latch);
+
+    BumpedPtrs.insert({{RowPtr, Idx}, ptr});
+
+    return ptr;
   }
 
-  summedIndices.push_back(scaledIndices[0]);
-  for (size_t i = 1; i < scaledIndices.size(); ++i) {
-    summedIndices.push_back(builder.CreateAdd(summedIndices[i - 1],
-                                              scaledIndices[i], "summed.idx"));
+public:
+  IndexFlattener(llvm::DominatorTree &DT, llvm::LoopInfo &LI,
+                 const llvm::DataLayout &DL)
+      : DT(DT), LI(LI), DL(DL) {}
+
+  bool flatten(llvm::GetElementPtrInst *GEP) {
+    auto *ptrTy =
+        llvm::dyn_cast<llvm::PointerType>(GEP->getPointerOperandType());
+
+    llvm::SmallVector<uint64_t, 8> sizes;
+    GetDecomposedArraySizes(ptrTy, sizes);
+
+    if (sizes.size() <= 1 || GEP->getNumIndices() != sizes.size() + 1) {
+      return false;
+    }
+
+    // the stride of each index in elements of the basic type, including the
+    // index that steps over the whole array
+    llvm::SmallVector<uint64_t, 8> strides;
+    strides.resize(sizes.size() + 1);
+    strides.back() = 1u;
+
+    for (auto i = sizes.size(); i > 0; --i) {
+      strides[i - 1] = strides[i] * sizes[i - 1];
+    }
+
+    LLVM_DEBUG(llvm::dbgs() << "index strides: ";
+               for (auto e
+                    : strides) { llvm::dbgs() << e << ' '; };
+               llvm::dbgs() << '\n';);
+
+    llvm::SmallVector<llvm::Type *, 8> newTypes;
+    GetDecomposedMultiDimArrayType(ptrTy, &newTypes);
+
+    auto *basePtr = getBasePtr(GEP->getPointerOperand(), newTypes.back(),
+                               *GEP->getFunction());
+
+    if (!basePtr) {
+      return false;
+    }
+
+    auto *elemTy =
+        llvm::dyn_cast<llvm::PointerType>(newTypes.back())->getElementType();
+    llvm::SmallVector<llvm::Value *, 8> indices{GEP->idx_begin(),
+                                                GEP->idx_end()};
+    auto *lastIdx = indices.pop_back_val();
+    strides.pop_back();
+
+    auto *rowPtr = getRowPtr(GEP, basePtr, elemTy, indices, strides);
+    llvm::Value *newPtr = getBumpedPtr(GEP, rowPtr, elemTy, lastIdx);
+
+    if (!newPtr) {
+      auto *newGEP = llvm::GetElementPtrInst::Create(elemTy, rowPtr, lastIdx,
+                                                     "flattened.ptr", GEP);
+      newGEP->setIsInBounds(GEP->isInBounds());
+      newGEP->setDebugLoc(GEP->getDebugLoc());
+      newPtr = newGEP;
+    }
+
+    LLVM_DEBUG(llvm::dbgs() << "flattened: " << *GEP << "\nto: " << *newPtr
+                            << '\n';);
+
+    GEP->replaceAllUsesWith(newPtr);
+    GEP->eraseFromParent();
+
+    return true;
   }
+};
+
+// decomposes the array accesses of a function, while sharing the row pointer
+// loads between accesses and placing them outside the loops that they are
+// invariant in
+class RefDecomposer {
+  llvm::DominatorTree &DT;
+  llvm::LoopInfo &LI;
+  llvm::AAResults *AA;
+  // keyed by the base pointer and the indices of the row
+  std::map<std::vector<llvm::Value *>, llvm::Value *> RowPtrs;
+
+  bool mayModify(llvm::Instruction &I, llvm::LoadInst &Load) const {
+    if (!I.mayWriteToMemory()) {
+      return false;
+    }
 
-  llvm::SmallVector<llvm::Type *, 8> newTypes;
+    return !AA || llvm::isModSet(AA->getModRefInfo(
+                      &I, llvm::MemoryLocation::get(&Load)));
+  }
 
-  GetDecomposedMultiDimArrayType(
-      llvm::dyn_cast<llvm::PointerType>(GEP->getPointerOperandType()),
-      &newTypes);
+  // a row pointer load can be moved to the preheader of a loop if its
+  // operands are invariant, the loop does not write to the row and the load
+  // executes whenever the loop is entered
+  bool canHoistOutOf(llvm::Loop &L, llvm::LoadInst &Load,
+                     llvm::GetElementPtrInst &GEP) const {
+    if (!L.getLoopPreheader() || !L.hasLoopInvariantOperands(&GEP)) {
+      return false;
+    }
 
-  auto *ptrCast = llvm::CastInst::CreatePointerCast(
-      GEP->getPointerOperand(), newTypes.back(), "ptrcast", GEP);
+    llvm::SmallVector<llvm::BasicBlock *, 4> exiting;
+    L.getExitingBlocks(exiting);
 
-  auto *elemTy =
-      llvm::dyn_cast<llvm::PointerType>(newTypes.back())->getElementType();
-  auto *newGEP = llvm::GetElementPtrInst::Create(
-      elemTy, ptrCast, summedIndices.back(), "decomposed.ptr", GEP);
+    if (std::any_of(exiting.begin(), exiting.end(), [&](auto *e) {
+          return !DT.dominates(Load.getParent(), e);
+        })) {
+      return false;
+    }
 
-  if (auto *dbg = GEP->getMetadata("dbg")) {
-    ptrCast->setMetadata("dbg", dbg);
-    newGEP->setMetadata("dbg", dbg);
+    for (auto *bb : L.blocks()) {
+      for (auto &inst : *bb) {
+        if (inst.mayThrow() || mayModify(inst, Load)) {
+          return false;
+        }
+      }
+    }
+
+    return true;
   }
 
-  GEP->replaceAllUsesWith(newGEP);
-  GEP->eraseFromParent();
+  // rows of a constant global are invariant in the whole program, which is
+  // what the metadata promises, while a row that this function does not write
+  // can still be written by its callers
+  bool isInvariant(llvm::LoadInst &Load) const {
+    const auto &dl = Load.getModule()->getDataLayout();
+    auto *gv = llvm::dyn_cast<llvm::GlobalVariable>(
+        llvm::GetUnderlyingObject(Load.getPointerOperand(), dl));
+
+    return gv && gv->isConstant();
+  }
+
+  bool isReachable(llvm::Instruction &From, llvm::Instruction &To) const {
+#if LLVM_VERSION_MAJOR >= 9
+    return llvm::isPotentiallyReachable(&From, &To, nullptr, &DT, &LI);
+#else
+    return llvm::isPotentiallyReachable(&From, &To, &DT, &LI);
+#endif
+  }
+
+  // a shared row pointer load is stale at an access if a write to its row
+  // might execute after it and before the access
+  bool mayBeClobbered(llvm::LoadInst &Load, llvm::Instruction &Access) const {
+    if (Load.getMetadata(llvm::LLVMContext::MD_invariant_load)) {
+      return false;
+    }
+
+    for (auto &bb : *Load.getFunction()) {
+      for (auto &inst : bb) {
+        if (mayModify(inst, Load) && isReachable(Load, inst) &&
+            isReachable(inst, Access)) {
+          return true;
+        }
+      }
+    }
+
+    return false;
+  }
+
+  llvm::Value *getRowPtr(llvm::ArrayRef<llvm::Value *> Key,
+                         llvm::Instruction *InsertPoint) const {
+    auto found = RowPtrs.find({Key.begin(), Key.end()});
+
+    if (found == RowPtrs.end()) {
+      return nullptr;
+    }
+
+    auto *inst = llvm::dyn_cast<llvm::Instruction>(found->second);
+
+    if (!inst) {
+      return found->second;
+    }
+
+    if (!DT.dominates(inst, InsertPoint)) {
+      return nullptr;
+    }
+
+    auto *load = llvm::dyn_cast<llvm::LoadInst>(inst);
+    if (load && mayBeClobbered(*load, *InsertPoint)) {
+      LLVM_DEBUG(llvm::dbgs() << "row pointer load might be clobbered: "
+                              << *load << '\n';);
+      return nullptr;
+    }
+
+    return found->second;
+  }
+
+public:
+  RefDecomposer(llvm::DominatorTree &DT, llvm::LoopInfo &LI,
+                llvm::AAResults *AA)
+      : DT(DT), LI(LI), AA(AA) {}
+
+  bool decompose(llvm::GetElementPtrInst *GEP) {
+    LLVM_DEBUG(llvm::dbgs() << "decomposing: " << *GEP << '\n';);
+
+    llvm::SmallVector<llvm::Type *, 8> newTypes;
+    GetDecomposedMultiDimArrayType(
+        llvm::dyn_cast<llvm::PointerType>(GEP->getPointerOperandType()),
+        &newTypes);
+
+    if (GEP->getNumIndices() < 2 || newTypes.size() != GEP->getNumIndices()) {
+      LLVM_DEBUG(llvm::dbgs() << "GEP instruction does not step through "
+                                 "arrays in all its indices\n";);
+      return false;
+    }
+
+    std::vector<llvm::Value *> key{GEP->getPointerOperand()};
+    llvm::Value *lastPtr = getRowPtr(key, GEP);
+
+    if (!lastPtr) {
+      auto *ip = GetHoistPoint(key, *GEP->getFunction(), DT);
+
+      lastPtr = llvm::CastInst::CreatePointerCast(
+          GEP->getPointerOperand(), newTypes[0], "ptrcast", ip ? ip : GEP);
+      RowPtrs[key] = lastPtr;
+    }
+
+    llvm::SmallVector<llvm::Value *, 8> indices{GEP->idx_begin(),
+                                                GEP->idx_end()};
+
+    for (auto i = 0u; i < indices.size() - 1; ++i) {
+      key.push_back(indices[i]);
+
+      if (auto *row = getRowPtr(key, GEP)) {
+        lastPtr = row;
+        continue;
+      }
+
+      auto *elemTy =
+          llvm::dyn_cast<llvm::PointerType>(newTypes[i])->getElementType();
+      auto *rowGEP = llvm::GetElementPtrInst::Create(
+          elemTy, lastPtr, indices[i], "lastptr", GEP);
+      auto *load = new llvm::LoadInst(rowGEP, "ptrload", GEP);
+
+      llvm::Loop *outermost = nullptr;
+      for (auto *curLoop = LI.getLoopFor(GEP->getParent());
+           curLoop && canHoistOutOf(*curLoop, *load, *rowGEP);
+           curLoop = curLoop->getParentLoop()) {
+        outermost = curLoop;
+      }
+
+      if (outermost) {
+        auto *ip = outermost->getLoopPreheader()->getTerminator();
+        rowGEP->moveBefore(ip);
+        load->moveBefore(ip);
+      } else {
+        rowGEP->setDebugLoc(GEP->getDebugLoc());
+        load->setDebugLoc(GEP->getDebugLoc());
+      }
+
+      if (isInvariant(*load)) {
+        load->setMetadata(llvm::LLVMContext::MD_invariant_load,
+                          llvm::MDNode::get(load->getContext(), {}));
+      }
+
+      LLVM_DEBUG(llvm::dbgs() << "row pointer load: " << *load << '\n';);
+
+      RowPtrs[key] = load;
+      lastPtr = load;
+    }
+
+    auto *elemTy = llvm::dyn_cast<llvm::PointerType>(newTypes.back())
+                       ->getElementType();
+    auto *newGEP = llvm::GetElementPtrInst::Create(
+        elemTy, lastPtr, indices.back(), "lastptr", GEP);
+    newGEP->setDebugLoc(GEP->getDebugLoc());
+
+    GEP->replaceAllUsesWith(newGEP);
+    GEP->eraseFromParent();
+
+    return true;
+  }
+};
+
+// flattens the accesses to linearized arrays into a row pointer and an index
+// within the row, using the subscripts recovered by delinearization
+class DelinearizedFlattener {
+  llvm::ScalarEvolution &SE;
+  llvm::DominatorTree &DT;
+  llvm::LoopInfo &LI;
+  llvm::SCEVExpander Expander;
+  llvm::DenseMap<std::pair<llvm::Value *, llvm::Type *>, llvm::Value *>
+      BasePtrs;
+  // keyed by the typed base pointer, the row offset and the inbounds flag
+  std::map<std::tuple<llvm::Value *, const llvm::SCEV *, bool>, llvm::Value *>
+      RowPtrs;
+  std::map<std::pair<llvm::Value *, const llvm::SCEV *>, llvm::Value *>
+      BumpedPtrs;
+
+  template <typename MapT, typename KeyT>
+  llvm::Value *lookup(MapT &Map, const KeyT &Key,
+                      llvm::Instruction *InsertPoint) const {
+    auto found = Map.find(Key);
+
+    if (found == Map.end()) {
+      return nullptr;
+    }
+
+    auto *inst = llvm::dyn_cast<llvm::Instruction>(found->second);
+
+    return !inst || DT.dominates(inst, InsertPoint) ? found->second : nullptr;
+  }
+
+  // the preheader of the outermost loop that the given expression and base
+  // pointer are invariant in, or the access itself
+  llvm::Instruction *getInsertPoint(const llvm::SCEV *S, llvm::Value *Base,
+                                    llvm::Instruction *Access) const {
+    llvm::Instruction *ip = Access;
+
+    for (auto *curLoop = LI.getLoopFor(Access->getParent());
+         curLoop && curLoop->getLoopPreheader() &&
+         SE.isLoopInvariant(S, curLoop) && curLoop->isLoopInvariant(Base);
+         curLoop = curLoop->getParentLoop()) {
+      ip = curLoop->getLoopPreheader()->getTerminator();
+    }
+
+    return ip;
+  }
+
+  llvm::Value *getBasePtr(llvm::Value *Base, llvm::Type *Ty,
+                          llvm::Instruction *Access) {
+    if (Base->getType() == Ty) {
+      return Base;
+    }
+
+    if (auto *ptr = lookup(BasePtrs, std::make_pair(Base, Ty), Access)) {
+      return ptr;
+    }
+
+    auto *ip = GetHoistPoint(Base, *Access->getFunction(), DT);
+    llvm::IRBuilder<> builder{ip ? ip : Access};
+    auto *ptr = builder.CreatePointerCast(Base, Ty, "ptrcast");
+    BasePtrs[{Base, Ty}] = ptr;
+
+    return ptr;
+  }
+
+  llvm::Value *getBumpedPtr(llvm::Value *RowPtr, llvm::Type *ElemTy,
+                            const llvm::SCEV *Idx, llvm::Instruction *Access) {
+    auto *ar = llvm::dyn_cast<llvm::SCEVAddRecExpr>(Idx);
+    auto *curLoop = LI.getLoopFor(Access->getParent());
+
+    if (!ar || !ar->isAffine() || ar->getLoop() != curLoop ||
+        !curLoop->empty() || !curLoop->isLoopInvariant(RowPtr)) {
+      return nullptr;
+    }
+
+    auto *step = llvm::dyn_cast<llvm::SCEVConstant>(ar->getStepRecurrence(SE));
+    auto *preheader = curLoop->getLoopPreheader();
+    auto *latch = curLoop->getLoopLatch();
+
+    if (!step || !preheader || !latch) {
+      return nullptr;
+    }
+
+    if (auto *ptr = lookup(BumpedPtrs, std::make_pair(RowPtr, Idx), Access)) {
+      return ptr;
+    }
+
+    llvm::IRBuilder<> builder{preheader->getTerminator()};
+    auto *start = builder.CreateGEP(
+        ElemTy, RowPtr,
+        Expander.expandCodeFor(ar->getStart(), Idx->getType(),
+                               preheader->getTerminator()),
+        "bumped.start");
+
+    builder.SetInsertPoint(&curLoop->getHeader()->front());
+    auto *ptr = builder.CreatePHI(RowPtr->getType(), 2, "bumped.ptr");
+
+    builder.SetInsertPoint(latch->getTerminator());
+    auto *next =
+        builder.CreateGEP(ElemTy, ptr, step->getValue(), "bumped.next");
+
+    ptr->addIncoming(start, preheader);
+    ptr->addIncoming(next, latch);
+
+    BumpedPtrs[{RowPtr, Idx}] = ptr;
+
+    return ptr;
+  }
+
+public:
+  DelinearizedFlattener(llvm::ScalarEvolution &SE, llvm::DominatorTree &DT,
+                        llvm::LoopInfo &LI, const llvm::DataLayout &DL)
+      : SE(SE), DT(DT), LI(LI), Expander(SE, DL, "delinearized") {}
+
+  bool flatten(llvm::Instruction *Access) {
+    DelinearizedAccess access;
+
+    if (!DelinearizeAccess(SE, LI, *Access, access)) {
+      return false;
+    }
+
+    auto opIdx = llvm::isa<llvm::LoadInst>(Access)
+                     ? llvm::LoadInst::getPointerOperandIndex()
+                     : llvm::StoreInst::getPointerOperandIndex();
+    auto *ptr = Access->getOperand(opIdx);
+    auto *ptrTy = llvm::cast<llvm::PointerType>(ptr->getType());
+    auto *baseTy = llvm::dyn_cast<llvm::PointerType>(access.Base->getType());
+
+    if (!baseTy || baseTy->getAddressSpace() != ptrTy->getAddressSpace()) {
+      return false;
+    }
+
+    auto *elemTy = ptrTy->getElementType();
+    auto *gep = llvm::dyn_cast<llvm::GEPOperator>(ptr);
+    bool isInBounds = gep && gep->isInBounds();
+
+    auto *basePtr = getBasePtr(access.Base, ptrTy, Access);
+    auto *rowOffset = access.getRowOffset(SE);
+    auto key = std::make_tuple(basePtr, rowOffset, isInBounds);
+    auto *rowPtr = lookup(RowPtrs, key, Access);
+
+    if (!rowPtr) {
+      auto *ip = getInsertPoint(rowOffset, basePtr, Access);
+      auto *offset =
+          Expander.expandCodeFor(rowOffset, rowOffset->getType(), ip);
+
+      llvm::IRBuilder<> builder{ip};
+      rowPtr = isInBounds ? builder.CreateInBoundsGEP(elemTy, basePtr, offset,
+                                                      "row.ptr")
+                          : builder.CreateGEP(elemTy, basePtr, offset,
+                                              "row.ptr");
+      RowPtrs[key] = rowPtr;
+    }
+
+    auto *idx = access.Subscripts.back();
+    auto *newPtr = getBumpedPtr(rowPtr, elemTy, idx, Access);
+
+    if (!newPtr) {
+      llvm::IRBuilder<> builder{Access};
+      auto *offset = Expander.expandCodeFor(idx, idx->getType(), Access);
+
+      newPtr = isInBounds ? builder.CreateInBoundsGEP(elemTy, rowPtr, offset,
+                                                      "flattened.ptr")
+                          : builder.CreateGEP(elemTy, rowPtr, offset,
+                                              "flattened.ptr");
+    }
+
+    LLVM_DEBUG(llvm::dbgs() << "flattened: " << *ptr << "\nto: " << *newPtr
+                            << '\n';);
+
+    Access->setOperand(opIdx, newPtr);
+    llvm::RecursivelyDeleteTriviallyDeadInstructions(ptr);
+
+    return true;
+  }
+};
+
+} // namespace
+
+bool FlattenMultiDimArrayIndices(llvm::ArrayRef<llvm::GetElementPtrInst *> GEPs,
+                                 llvm::DominatorTree &DT, llvm::LoopInfo &LI) {
+  bool changed = false;
+
+  if (GEPs.empty()) {
+    return changed;
+  }
+
+  IndexFlattener flattener{DT, LI, GEPs.front()->getModule()->getDataLayout()};
+
+  for (auto *e : GEPs) {
+    changed |= flattener.flatten(e);
+  }
+
+  return changed;
+}
+
+bool FlattenDelinearizedAccesses(llvm::ArrayRef<llvm::Instruction *> Accesses,
+                                 llvm::ScalarEvolution &SE,
+                                 llvm::DominatorTree &DT, llvm::LoopInfo &LI) {
+  bool changed = false;
+
+  if (Accesses.empty()) {
+    return changed;
+  }
+
+  DelinearizedFlattener flattener{
+      SE, DT, LI, Accesses.front()->getModule()->getDataLayout()};
+
+  for (auto *e : Accesses) {
+    changed |= flattener.flatten(e);
+  }
 
   return changed;
 }
@@ -238,5 +919,17 @@ bool DecomposeMultiDimArrayRefs(llvm::GetElementPtrInst *GEP) {
   return true;
 }
 
-} // namespace atrox
+bool DecomposeMultiDimArrayRefs(llvm::ArrayRef<llvm::GetElementPtrInst *> GEPs,
+                                llvm::DominatorTree &DT, llvm::LoopInfo &LI,
+                                llvm::AAResults *AA) {
+  bool changed = false;
+  RefDecomposer decomposer{DT, LI, AA};
+
+  for (auto *e : GEPs) {
+    changed |= decomposer.decompose(e);
+  }
 
+  return changed;
+}
+
+} // namespace atrox
@@ -0,0 +1,194 @@
+//
+//
+//
+
+#include "Atrox/Transforms/DecoupledPipeline.hpp"
+
+#include "Atrox/Transforms/PayloadRegion.hpp"
+
+#include "Atrox/Support/IR/GeneralUtils.hpp"
+
+#include "llvm/Analysis/LoopInfo.h"
+// using llvm::Loop
+
+#include "llvm/IR/Function.h"
+// using llvm::Function
+
+#include "llvm/IR/Module.h"
+// using llvm::Module
+
+#include "llvm/IR/DataLayout.h"
+// using llvm::DataLayout
+
+#include "llvm/IR/DerivedTypes.h"
+// using llvm::StructType
+// using llvm::FunctionType
+// using llvm::PointerType
+
+#include "llvm/IR/Instructions.h"
+// using llvm::CallInst
+
+#include "llvm/IR/IRBuilder.h"
+// using llvm::IRBuilder
+
+#include "llvm/ADT/SmallVector.h"
+// using llvm::SmallVector
+
+#include "llvm/Support/Debug.h"
+// using LLVM_DEBUG macro
+// using llvm::dbgs
+
+#define DEBUG_TYPE "atrox-dswp"
+
+namespace atrox {
+
+bool CreateDecoupledPipeline(llvm::Loop &L,
+                             llvm::ArrayRef<llvm::BasicBlock *> PayloadBlocks,
+                             llvm::Function &Payload,
+                             llvm::ArrayRef<llvm::Value *> Inputs,
+                             unsigned Workers, unsigned Capacity,
+                             PipelineSpec *Spec) {
+  auto *preheader = L.getLoopPreheader();
+  auto *loopExit = L.getExitBlock();
+
+  if (!preheader || !loopExit || !Payload.getReturnType()->isVoidTy() ||
+      Payload.arg_size() != Inputs.size()) {
+    LLVM_DEBUG(llvm::dbgs() << "cannot pipeline payload: " << Payload.getName()
+                            << '\n';);
+    return false;
+  }
+
+  // replace the payload region with pushing its inputs
+
+  auto *push = ReplacePayloadRegion(PayloadBlocks, "dswp.push");
+
+  if (!push) {
+    LLVM_DEBUG(llvm::dbgs() << "cannot replace payload region: "
+                            << Payload.getName() << '\n';);
+    return false;
+  }
+
+  auto &F = *push->getParent();
+  auto &M = *F.getParent();
+  auto &ctx = F.getContext();
+  const auto &DL = M.getDataLayout();
+
+  llvm::SmallVector<unsigned, 8> recordIdx, contextIdx;
+  llvm::SmallVector<llvm::Type *, 8> recordTys, contextTys;
+
+  for (unsigned i = 0; i < Inputs.size(); ++i) {
+    bool isInvariant = L.isLoopInvariant(Inputs[i]);
+
+    (isInvariant ? contextIdx : recordIdx).push_back(i);
+    (isInvariant ? contextTys : recordTys).push_back(Inputs[i]->getType());
+  }
+
+  auto *recordTy = llvm::StructType::create(
+      ctx, recordTys, (Payload.getName() + ".dswp.record").str());
+  auto *contextTy = llvm::StructType::create(
+      ctx, contextTys, (Payload.getName() + ".dswp.context").str());
+
+  // trampoline that unpacks the inputs and calls the payload
+
+  auto *i8PtrTy = llvm::Type::getInt8PtrTy(ctx);
+  auto *trampolineTy = llvm::FunctionType::get(llvm::Type::getVoidTy(ctx),
+                                               {i8PtrTy, i8PtrTy}, false);
+  auto *trampoline =
+      llvm::Function::Create(trampolineTy, llvm::GlobalValue::InternalLinkage,
+                             Payload.getName() + ".dswp", &M);
+
+  llvm::IRBuilder<> builder{
+      llvm::BasicBlock::Create(ctx, "entry", trampoline)};
+  auto *recordArg = builder.CreateBitCast(trampoline->arg_begin(),
+                                          recordTy->getPointerTo());
+  auto *contextArg = builder.CreateBitCast(trampoline->arg_begin() + 1,
+                                           contextTy->getPointerTo());
+
+  llvm::SmallVector<llvm::Value *, 8> args(Inputs.size());
+
+  for (unsigned i = 0; i < recordIdx.size(); ++i) {
+    args[recordIdx[i]] = builder.CreateLoad(
+        recordTys[i], builder.CreateStructGEP(recordTy, recordArg, i));
+  }
+
+  for (unsigned i = 0; i < contextIdx.size(); ++i) {
+    args[contextIdx[i]] = builder.CreateLoad(
+        contextTys[i], builder.CreateStructGEP(contextTy, contextArg, i));
+  }
+
+  auto *call = builder.CreateCall(&Payload, args);
+  builder.CreateRetVoid();
+
+  InternalizePayload(Payload, {call});
+
+  // runtime interface
+
+  auto *sizeTy = DL.getIntPtrType(ctx);
+  auto *createFunc = GetRuntimeFunction(
+      M, "atrox_dswp_create",
+      llvm::FunctionType::get(i8PtrTy,
+                              {trampolineTy->getPointerTo(), i8PtrTy, sizeTy,
+                               sizeTy, llvm::Type::getInt32Ty(ctx)},
+                              false));
+  auto *pushFunc = GetRuntimeFunction(
+      M, "atrox_dswp_push",
+      llvm::FunctionType::get(llvm::Type::getVoidTy(ctx), {i8PtrTy, i8PtrTy},
+                              false));
+  auto *finishFunc = GetRuntimeFunction(
+      M, "atrox_dswp_finish",
+      llvm::FunctionType::get(llvm::Type::getVoidTy(ctx), {i8PtrTy}, false));
+
+  builder.SetInsertPoint(&*F.getEntryBlock().getFirstInsertionPt());
+  auto *record = builder.CreateAlloca(recordTy, nullptr, "dswp.record");
+  auto *context = builder.CreateAlloca(contextTy, nullptr, "dswp.context");
+
+  builder.SetInsertPoint(preheader->getTerminator());
+
+  for (unsigned i = 0; i < contextIdx.size(); ++i) {
+    builder.CreateStore(Inputs[contextIdx[i]],
+                        builder.CreateStructGEP(contextTy, context, i));
+  }
+
+  auto *handle = builder.CreateCall(
+      createFunc,
+      {trampoline, builder.CreateBitCast(context, i8PtrTy),
+       llvm::ConstantInt::get(sizeTy, DL.getTypeAllocSize(recordTy)),
+       llvm::ConstantInt::get(sizeTy, Capacity), builder.getInt32(Workers)},
+      "dswp");
+
+  builder.SetInsertPoint(&*loopExit->getFirstInsertionPt());
+  builder.CreateCall(finishFunc, {handle});
+
+  builder.SetInsertPoint(push->getTerminator());
+
+  for (unsigned i = 0; i < recordIdx.size(); ++i) {
+    builder.CreateStore(Inputs[recordIdx[i]],
+                        builder.CreateStructGEP(recordTy, record, i));
+  }
+
+  builder.CreateCall(pushFunc,
+                     {handle, builder.CreateBitCast(record, i8PtrTy)});
+
+  if (Spec) {
+    Spec->Workers = Workers;
+    Spec->Capacity = Capacity;
+    Spec->RecordSize = DL.getTypeAllocSize(recordTy);
+    Spec->RecordFields.clear();
+    Spec->ContextFields.clear();
+
+    for (auto i : recordIdx) {
+      Spec->RecordFields.push_back(Inputs[i]->getName().str());
+    }
+
+    for (auto i : contextIdx) {
+      Spec->ContextFields.push_back(Inputs[i]->getName().str());
+    }
+  }
+
+  LLVM_DEBUG(llvm::dbgs() << "pipelined payload: " << Payload.getName()
+                          << '\n';);
+
+  return true;
+}
+
+} // namespace atrox
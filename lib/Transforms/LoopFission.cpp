@@ -0,0 +1,208 @@
+//
+//
+//
+
+#include "Atrox/Transforms/LoopFission.hpp"
+
+#include "Atrox/Transforms/PayloadRegion.hpp"
+
+#include "Atrox/Support/IR/GeneralUtils.hpp"
+
+#include "llvm/Analysis/LoopInfo.h"
+// using llvm::Loop
+
+#include "llvm/IR/Function.h"
+// using llvm::Function
+
+#include "llvm/IR/Module.h"
+// using llvm::Module
+
+#include "llvm/IR/DataLayout.h"
+// using llvm::DataLayout
+
+#include "llvm/IR/DerivedTypes.h"
+// using llvm::StructType
+// using llvm::FunctionType
+// using llvm::PointerType
+
+#include "llvm/IR/Instructions.h"
+// using llvm::CallInst
+// using llvm::PHINode
+
+#include "llvm/IR/IRBuilder.h"
+// using llvm::IRBuilder
+
+#include "llvm/ADT/SmallVector.h"
+// using llvm::SmallVector
+
+#include "llvm/Support/Debug.h"
+// using LLVM_DEBUG macro
+// using llvm::dbgs
+
+#define DEBUG_TYPE "atrox-fission"
+
+namespace {
+
+// the runtime buffer does not guarantee a stricter alignment for its records
+constexpr unsigned MaxRecordAlignment = 16;
+
+} // namespace
+
+namespace atrox {
+
+bool CreateIteratorFission(llvm::Loop &L,
+                           llvm::ArrayRef<llvm::BasicBlock *> PayloadBlocks,
+                           llvm::Function &Payload,
+                           llvm::ArrayRef<llvm::Value *> Inputs,
+                           llvm::ArrayRef<bool> IteratorDependent,
+                           uint64_t Capacity, FissionSpec *Spec) {
+  auto *preheader = L.getLoopPreheader();
+  auto *loopExit = L.getExitBlock();
+
+  if (!preheader || !loopExit || loopExit->isEHPad() ||
+      !Payload.getReturnType()->isVoidTy() ||
+      Payload.arg_size() != Inputs.size()) {
+    LLVM_DEBUG(llvm::dbgs() << "cannot fission payload: " << Payload.getName()
+                            << '\n';);
+    return false;
+  }
+
+  auto &M = *Payload.getParent();
+  auto &ctx = Payload.getContext();
+  const auto &DL = M.getDataLayout();
+
+  llvm::SmallVector<unsigned, 8> recordIdx, invariantIdx;
+  llvm::SmallVector<llvm::Type *, 8> recordTys;
+
+  for (unsigned i = 0; i < Inputs.size(); ++i) {
+    bool isDependent = i < IteratorDependent.size() && IteratorDependent[i];
+
+    if (isDependent || !L.isLoopInvariant(Inputs[i])) {
+      recordIdx.push_back(i);
+      recordTys.push_back(Inputs[i]->getType());
+    } else {
+      invariantIdx.push_back(i);
+    }
+  }
+
+  auto *recordTy = llvm::StructType::create(
+      ctx, recordTys, (Payload.getName() + ".fission.record").str());
+
+  if (DL.getABITypeAlignment(recordTy) > MaxRecordAlignment) {
+    LLVM_DEBUG(llvm::dbgs() << "record alignment is not supported: "
+                            << *recordTy << '\n';);
+    return false;
+  }
+
+  // replace the payload region with appending its inputs
+
+  auto *append = ReplacePayloadRegion(PayloadBlocks, "fission.append");
+
+  if (!append) {
+    LLVM_DEBUG(llvm::dbgs() << "cannot replace payload region: "
+                            << Payload.getName() << '\n';);
+    return false;
+  }
+
+  auto &F = *append->getParent();
+
+  // runtime interface
+
+  auto *i8PtrTy = llvm::Type::getInt8PtrTy(ctx);
+  auto *sizeTy = DL.getIntPtrType(ctx);
+  auto *createFunc = GetRuntimeFunction(
+      M, "atrox_buffer_create",
+      llvm::FunctionType::get(i8PtrTy, {sizeTy, sizeTy}, false));
+  auto *appendFunc = GetRuntimeFunction(
+      M, "atrox_buffer_append",
+      llvm::FunctionType::get(i8PtrTy, {i8PtrTy}, false));
+  auto *sizeFunc = GetRuntimeFunction(
+      M, "atrox_buffer_size",
+      llvm::FunctionType::get(sizeTy, {i8PtrTy}, false));
+  auto *dataFunc = GetRuntimeFunction(
+      M, "atrox_buffer_data",
+      llvm::FunctionType::get(i8PtrTy, {i8PtrTy}, false));
+  auto *destroyFunc = GetRuntimeFunction(
+      M, "atrox_buffer_destroy",
+      llvm::FunctionType::get(llvm::Type::getVoidTy(ctx), {i8PtrTy}, false));
+
+  llvm::IRBuilder<> builder{preheader->getTerminator()};
+  auto *buffer = builder.CreateCall(
+      createFunc,
+      {llvm::ConstantInt::get(sizeTy, DL.getTypeAllocSize(recordTy)),
+       llvm::ConstantInt::get(sizeTy, Capacity)},
+      "fission.buffer");
+
+  builder.SetInsertPoint(append->getTerminator());
+  auto *record = builder.CreateBitCast(builder.CreateCall(appendFunc, buffer),
+                                       recordTy->getPointerTo());
+
+  for (unsigned i = 0; i < recordIdx.size(); ++i) {
+    builder.CreateStore(Inputs[recordIdx[i]],
+                        builder.CreateStructGEP(recordTy, record, i));
+  }
+
+  // run the payload over the gathered records when the iterator is done
+
+  auto *end =
+      loopExit->splitBasicBlock(loopExit->getFirstInsertionPt(), "fission.end");
+  auto *body = llvm::BasicBlock::Create(ctx, "fission.body", &F, end);
+  loopExit->getTerminator()->eraseFromParent();
+
+  builder.SetInsertPoint(loopExit);
+  auto *n = builder.CreateCall(sizeFunc, buffer, "fission.size");
+  auto *data =
+      builder.CreateBitCast(builder.CreateCall(dataFunc, buffer),
+                            recordTy->getPointerTo(), "fission.data");
+  builder.CreateCondBr(
+      builder.CreateICmpEQ(n, llvm::ConstantInt::get(sizeTy, 0)), end, body);
+
+  builder.SetInsertPoint(body);
+  auto *idx = builder.CreatePHI(sizeTy, 2, "fission.idx");
+  idx->addIncoming(llvm::ConstantInt::get(sizeTy, 0), loopExit);
+
+  auto *cur = builder.CreateInBoundsGEP(recordTy, data, idx);
+  llvm::SmallVector<llvm::Value *, 8> args(Inputs.size());
+
+  for (unsigned i = 0; i < recordIdx.size(); ++i) {
+    args[recordIdx[i]] = builder.CreateLoad(
+        recordTys[i], builder.CreateStructGEP(recordTy, cur, i));
+  }
+
+  for (auto i : invariantIdx) {
+    args[i] = Inputs[i];
+  }
+
+  auto *call = builder.CreateCall(&Payload, args);
+  auto *next = builder.CreateNUWAdd(idx, llvm::ConstantInt::get(sizeTy, 1),
+                                    "fission.next");
+  idx->addIncoming(next, body);
+  builder.CreateCondBr(builder.CreateICmpULT(next, n), body, end);
+
+  builder.SetInsertPoint(&*end->getFirstInsertionPt());
+  builder.CreateCall(destroyFunc, buffer);
+
+  InternalizePayload(Payload, {call});
+
+  if (Spec) {
+    Spec->Capacity = Capacity;
+    Spec->RecordSize = DL.getTypeAllocSize(recordTy);
+    Spec->RecordFields.clear();
+    Spec->InvariantFields.clear();
+
+    for (auto i : recordIdx) {
+      Spec->RecordFields.push_back(Inputs[i]->getName().str());
+    }
+
+    for (auto i : invariantIdx) {
+      Spec->InvariantFields.push_back(Inputs[i]->getName().str());
+    }
+  }
+
+  LLVM_DEBUG(llvm::dbgs() << "fissioned payload: " << Payload.getName()
+                          << '\n';);
+
+  return true;
+}
+
+} // namespace atrox
@@ -25,6 +25,26 @@
 #include "llvm/IR/Function.h"
 // using llvm::Function
 
+#include "llvm/IR/Dominators.h"
+// using llvm::DominatorTree
+// using llvm::DominatorTreeAnalysis
+// using llvm::DominatorTreeWrapperPass
+
+#include "llvm/Analysis/LoopInfo.h"
+// using llvm::LoopInfo
+// using llvm::LoopAnalysis
+// using llvm::LoopInfoWrapperPass
+
+#include "llvm/Analysis/AliasAnalysis.h"
+// using llvm::AAResults
+// using llvm::AAManager
+// using llvm::AAResultsWrapperPass
+
+#include "llvm/Analysis/ScalarEvolution.h"
+// using llvm::ScalarEvolution
+// using llvm::ScalarEvolutionAnalysis
+// using llvm::ScalarEvolutionWrapperPass
+
 #include "llvm/IR/LegacyPassManager.h"
 // using llvm::PassManagerBase
 
@@ -32,8 +52,8 @@
 // using llvm::PassManagerBuilder
 // using llvm::RegisterStandardPasses
 
-#include "llvm/ADT/SmallPtrSet.h"
-// using llvm::SmallPtrSet
+#include "llvm/ADT/SetVector.h"
+// using llvm::SetVector
 
 #include "llvm/Support/CommandLine.h"
 // using llvm::cl::opt
@@ -97,7 +117,11 @@ DecomposeMultiDimArrayRefsPass::DecomposeMultiDimArrayRefsPass() {
   llvm::cl::ParseEnvironmentOptions(DEBUG_TYPE, PASS_CMDLINE_OPTIONS_ENVVAR);
 }
 
-bool DecomposeMultiDimArrayRefsPass::perform(llvm::Function &F) {
+bool DecomposeMultiDimArrayRefsPass::perform(llvm::Function &F,
+                                             llvm::DominatorTree &DT,
+                                             llvm::LoopInfo &LI,
+                                             llvm::AAResults *AA,
+                                             llvm::ScalarEvolution *SE) {
   llvm::SmallVector<std::string, 32> AtroxFunctionWhiteList;
 
   if (AtroxFunctionWhiteListFile.getPosition()) {
@@ -121,23 +145,33 @@ bool DecomposeMultiDimArrayRefsPass::perform(llvm::Function &F) {
 
   LLVM_DEBUG(llvm::dbgs() << "processing func: " << F.getName() << '\n';);
 
-  bool hasChanged = false;
   MemAccInstVisitor accesses;
   accesses.visit(F);
 
+  // all accesses are decomposed together to share their row pointer loads
+  llvm::SetVector<llvm::GetElementPtrInst *> geps;
+
   for (auto &e : accesses.Accesses) {
-    llvm::SmallVector<llvm::GetElementPtrInst *, 8> geps;
     if (auto *gep = llvm::dyn_cast_or_null<llvm::GetElementPtrInst>(
             e.getPointerOperand())) {
-      geps.push_back(gep);
+      geps.insert(gep);
     }
+  }
 
-    auto last = std::unique(geps.begin(), geps.end());
-    geps.erase(last, geps.end());
+  bool hasChanged = DecomposeMultiDimArrayRefs(geps.getArrayRef(), DT, LI, AA);
 
-    for (auto *gep : geps) {
-      hasChanged |= DecomposeMultiDimArrayRefs(gep);
+  // the remaining accesses to multi-dimensional arrays are linearized
+  if (SE) {
+    llvm::SmallVector<llvm::Instruction *, 32> linearized;
+
+    for (auto &e : accesses.Accesses) {
+      if (llvm::isa<llvm::LoadInst>(e.get()) ||
+          llvm::isa<llvm::StoreInst>(e.get())) {
+        linearized.push_back(e.get());
+      }
     }
+
+    hasChanged |= FlattenDelinearizedAccesses(linearized, *SE, DT, LI);
   }
 
   return hasChanged;
@@ -146,7 +180,12 @@ bool DecomposeMultiDimArrayRefsPass::perform(llvm::Function &F) {
 llvm::PreservedAnalyses
 DecomposeMultiDimArrayRefsPass::run(llvm::Function &F,
                                     llvm::FunctionAnalysisManager &FAM) {
-  bool hasChanged = perform(F);
+  auto &DT = FAM.getResult<llvm::DominatorTreeAnalysis>(F);
+  auto &LI = FAM.getResult<llvm::LoopAnalysis>(F);
+  auto &AA = FAM.getResult<llvm::AAManager>(F);
+  auto &SE = FAM.getResult<llvm::ScalarEvolutionAnalysis>(F);
+
+  bool hasChanged = perform(F, DT, LI, &AA, &SE);
 
   if (!hasChanged) {
     return llvm::PreservedAnalyses::all();
@@ -162,13 +201,21 @@ DecomposeMultiDimArrayRefsPass::run(llvm::Function &F,
 
 void DecomposeMultiDimArrayRefsLegacyPass::getAnalysisUsage(
     llvm::AnalysisUsage &AU) const {
+  AU.addRequired<llvm::DominatorTreeWrapperPass>();
+  AU.addRequired<llvm::LoopInfoWrapperPass>();
+  AU.addRequired<llvm::AAResultsWrapperPass>();
+  AU.addRequired<llvm::ScalarEvolutionWrapperPass>();
   AU.setPreservesCFG();
 }
 
 bool DecomposeMultiDimArrayRefsLegacyPass::runOnFunction(llvm::Function &F) {
   DecomposeMultiDimArrayRefsPass pass;
+  auto &DT = getAnalysis<llvm::DominatorTreeWrapperPass>().getDomTree();
+  auto &LI = getAnalysis<llvm::LoopInfoWrapperPass>().getLoopInfo();
+  auto &AA = getAnalysis<llvm::AAResultsWrapperPass>().getAAResults();
+  auto &SE = getAnalysis<llvm::ScalarEvolutionWrapperPass>().getSE();
 
-  return pass.perform(F);
+  return pass.perform(F, DT, LI, &AA, &SE);
 }
 
 } // namespace atrox
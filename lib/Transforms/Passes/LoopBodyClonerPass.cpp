@@ -14,6 +14,8 @@
 
 #include "Atrox/Analysis/WeightedIteratorRecognitionSelector.hpp"
 
+#include "Atrox/Analysis/PayloadWeights.hpp"
+
 #include "Atrox/Transforms/Passes/LoopBodyClonerPass.hpp"
 
 #include "Atrox/Transforms/LoopBodyCloner.hpp"
@@ -40,6 +42,22 @@
 // using llvm::AAResultsWrapperPass
 // using llvm::AAResults
 
+#include "llvm/Analysis/DependenceAnalysis.h"
+// using llvm::DependenceAnalysisWrapperPass
+// using llvm::DependenceAnalysis
+// using llvm::DependenceInfo
+
+#include "llvm/Analysis/BlockFrequencyInfo.h"
+// using llvm::BlockFrequencyInfo
+
+#include "llvm/Analysis/BranchProbabilityInfo.h"
+// using llvm::BranchProbabilityInfo
+
+#include "llvm/Analysis/TargetTransformInfo.h"
+// using llvm::TargetIRAnalysis
+// using llvm::TargetTransformInfo
+// using llvm::TargetTransformInfoWrapperPass
+
 #include "llvm/IR/Instruction.h"
 // using llvm::Instruction
 
@@ -53,9 +71,29 @@
 // using llvm::PassManagerBuilder
 // using llvm::RegisterStandardPasses
 
+#include "llvm/Transforms/Coroutines.h"
+// using llvm::createCoroEarlyPass
+// using llvm::createCoroSplitPass
+// using llvm::createCoroElidePass
+// using llvm::createCoroCleanupPass
+
 #include "llvm/ADT/SmallVector.h"
 // using llvm::SmallVector
 
+#include "llvm/ADT/Optional.h"
+// using llvm::Optional
+
+#include "llvm/Config/llvm-config.h"
+// using LLVM_VERSION_MAJOR
+
+#if LLVM_VERSION_MAJOR >= 14
+#include "llvm/MC/TargetRegistry.h"
+// using llvm::TargetRegistry
+#else
+#include "llvm/Support/TargetRegistry.h"
+// using llvm::TargetRegistry
+#endif
+
 #include "llvm/Support/CommandLine.h"
 // using llvm::cl::opt
 // using llvm::cl::desc
@@ -103,6 +141,7 @@ static void
 registerLoopBodyClonerLegacyPass(const llvm::PassManagerBuilder &Builder,
                                  llvm::legacy::PassManagerBase &PM) {
   PM.add(new atrox::LoopBodyClonerLegacyPass());
+  PM.add(llvm::createCoroEarlyPass());
 
   return;
 }
@@ -111,6 +150,51 @@ static llvm::RegisterStandardPasses RegisterLoopBodyClonerLegacyPass(
     llvm::PassManagerBuilder::EP_EarlyAsPossible,
     registerLoopBodyClonerLegacyPass);
 
+// the interleaved payloads are coroutines, but the frontend schedules the
+// coroutine passes only for sources that use coroutines; the options of the
+// pass are not parsed until it runs, so the passes are always scheduled, at
+// the same points as the frontend does, and do nothing without coroutines
+
+static void registerCoroutineOpt0Passes(const llvm::PassManagerBuilder &Builder,
+                                        llvm::legacy::PassManagerBase &PM) {
+  PM.add(llvm::createCoroSplitPass());
+  PM.add(llvm::createCoroElidePass());
+  PM.add(llvm::createCoroCleanupPass());
+}
+
+static void registerCoroutineSCCPasses(const llvm::PassManagerBuilder &Builder,
+                                       llvm::legacy::PassManagerBase &PM) {
+  PM.add(llvm::createCoroSplitPass());
+}
+
+static void
+registerCoroutineScalarPasses(const llvm::PassManagerBuilder &Builder,
+                              llvm::legacy::PassManagerBase &PM) {
+  PM.add(llvm::createCoroElidePass());
+}
+
+static void
+registerCoroutineCleanupPasses(const llvm::PassManagerBuilder &Builder,
+                               llvm::legacy::PassManagerBase &PM) {
+  PM.add(llvm::createCoroCleanupPass());
+}
+
+static llvm::RegisterStandardPasses
+    RegisterCoroutineOpt0Passes(llvm::PassManagerBuilder::EP_EnabledOnOptLevel0,
+                                registerCoroutineOpt0Passes);
+
+static llvm::RegisterStandardPasses RegisterCoroutineSCCPasses(
+    llvm::PassManagerBuilder::EP_CGSCCOptimizerLate,
+    registerCoroutineSCCPasses);
+
+static llvm::RegisterStandardPasses RegisterCoroutineScalarPasses(
+    llvm::PassManagerBuilder::EP_ScalarOptimizerLate,
+    registerCoroutineScalarPasses);
+
+static llvm::RegisterStandardPasses RegisterCoroutineCleanupPasses(
+    llvm::PassManagerBuilder::EP_OptimizerLast,
+    registerCoroutineCleanupPasses);
+
 //
 
 enum class SelectionStrategy {
@@ -145,6 +229,15 @@ static void checkAndSetCmdLineOptions() {
   }
 }
 
+// the target cost model falls back to the generic one, which is not better
+// than the table weights, when the target is not part of the build
+static bool hasTargetFor(const llvm::Module &M) {
+  std::string error;
+
+  return !M.getTargetTriple().empty() &&
+         llvm::TargetRegistry::lookupTarget(M.getTargetTriple(), error);
+}
+
 //
 
 namespace atrox {
@@ -162,7 +255,9 @@ bool LoopBodyClonerPass::perform(
     llvm::Module &M,
     std::function<llvm::ScalarEvolution &(llvm::Function &)> &GetSE,
     std::function<llvm::MemoryDependenceResults &(llvm::Function &)> &GetMDR,
-    std::function<llvm::AAResults &(llvm::Function &)> &GetAA) {
+    std::function<llvm::AAResults &(llvm::Function &)> &GetAA,
+    std::function<llvm::DependenceInfo &(llvm::Function &)> &GetDI,
+    std::function<llvm::TargetTransformInfo &(llvm::Function &)> &GetTTI) {
   llvm::SmallVector<llvm::Function *, 32> workList;
   workList.reserve(M.size());
 
@@ -177,6 +272,17 @@ bool LoopBodyClonerPass::perform(
     AtroxReportsDir = dirOrErr.get();
   }
 
+  if (AtroxPayloadWeightsFile.getPosition()) {
+    PayloadWeightTable table;
+
+    if (!ReadPayloadWeightTable(AtroxPayloadWeightsFile, table)) {
+      llvm::report_fatal_error("Failed to read payload weights file " +
+                               AtroxPayloadWeightsFile);
+    }
+
+    SetPayloadWeightTable(table);
+  }
+
   auto not_in = [](const auto &C, const auto &E) {
     return C.end() == std::find(std::begin(C), std::end(C), E);
   };
@@ -203,6 +309,8 @@ bool LoopBodyClonerPass::perform(
   }
 
   bool hasChanged = false;
+  bool hasTarget = hasTargetFor(M);
+
   while (!workList.empty()) {
     auto &F = *workList.pop_back_val();
 
@@ -218,18 +326,35 @@ bool LoopBodyClonerPass::perform(
     auto itrInfo = BuildITRInfo(li, *BuildPDG(F, &GetMDR(F)));
     auto &SE = GetSE(F);
     auto &AA = GetAA(F);
+    auto &DI = GetDI(F);
+
+    // built on the same loop info, like the other analyses above
+    llvm::Optional<llvm::BranchProbabilityInfo> bpi;
+    llvm::Optional<llvm::BlockFrequencyInfo> bfi;
+
+    if (AtroxProfileWeights) {
+      bpi.emplace(F, li);
+      bfi.emplace(F, *bpi, li);
+    }
+
+    auto *BFI = bfi ? &*bfi : nullptr;
+
+    const llvm::TargetTransformInfo *TTI =
+        AtroxPayloadCostModel == PayloadCostModel::TTI && hasTarget
+            ? &GetTTI(F)
+            : nullptr;
 
     if (SelectionStrategyOption ==
         SelectionStrategy::IteratorRecognitionBased) {
       IteratorRecognitionSelector s{*itrInfo};
-      hasChanged |= lpc.cloneLoops(li, s, &*itrInfo, &SE, &AA);
+      hasChanged |= lpc.cloneLoops(li, s, &*itrInfo, &SE, &AA, &DI, BFI, TTI);
     } else if (SelectionStrategyOption ==
                SelectionStrategy::WeightedIteratorRecognitionBased) {
-      WeightedIteratorRecognitionSelector s{*itrInfo};
-      hasChanged |= lpc.cloneLoops(li, s, &*itrInfo, &SE, &AA);
+      WeightedIteratorRecognitionSelector s{*itrInfo, BFI, TTI};
+      hasChanged |= lpc.cloneLoops(li, s, &*itrInfo, &SE, &AA, &DI, BFI, TTI);
     } else {
       NaiveSelector s;
-      hasChanged |= lpc.cloneLoops(li, s, &*itrInfo, &SE, &AA);
+      hasChanged |= lpc.cloneLoops(li, s, &*itrInfo, &SE, &AA, &DI, BFI, TTI);
     }
 
     if (ExportResults || ExportFailResults) {
@@ -277,10 +402,20 @@ LoopBodyClonerPass::run(llvm::Module &M, llvm::ModuleAnalysisManager &MAM) {
     return FAM.getResult<llvm::AAManager>(F);
   };
 
-  bool hasChanged = perform(M, GetSE, GetMDR, GetAA);
+  std::function<llvm::DependenceInfo &(llvm::Function &)> GetDI =
+      [&](llvm::Function &F) -> llvm::DependenceInfo & {
+    return FAM.getResult<llvm::DependenceAnalysis>(F);
+  };
+
+  std::function<llvm::TargetTransformInfo &(llvm::Function &)> GetTTI =
+      [&](llvm::Function &F) -> llvm::TargetTransformInfo & {
+    return FAM.getResult<llvm::TargetIRAnalysis>(F);
+  };
+
+  bool hasChanged = perform(M, GetSE, GetMDR, GetAA, GetDI, GetTTI);
 
-  return hasChanged ? llvm::PreservedAnalyses::all()
-                    : llvm::PreservedAnalyses::none();
+  return hasChanged ? llvm::PreservedAnalyses::none()
+                    : llvm::PreservedAnalyses::all();
 }
 
 // legacy passmanager pass
@@ -289,7 +424,11 @@ void LoopBodyClonerLegacyPass::getAnalysisUsage(llvm::AnalysisUsage &AU) const {
   AU.addRequiredTransitive<llvm::ScalarEvolutionWrapperPass>();
   AU.addRequiredTransitive<llvm::AAResultsWrapperPass>();
   AU.addRequired<llvm::MemoryDependenceWrapperPass>();
-  AU.setPreservesAll();
+  AU.addRequired<llvm::DependenceAnalysisWrapperPass>();
+  AU.addRequired<llvm::TargetTransformInfoWrapperPass>();
+
+  // the rewriting modes and the parallel loop annotations change the original
+  // functions, so like the new passmanager pass nothing is preserved
 }
 
 bool LoopBodyClonerLegacyPass::runOnModule(llvm::Module &M) {
@@ -310,7 +449,17 @@ bool LoopBodyClonerLegacyPass::runOnModule(llvm::Module &M) {
     return this->getAnalysis<AAResultsWrapperPass>(F).getAAResults();
   };
 
-  return pass.perform(M, GetSE, GetMDR, GetAA);
+  std::function<llvm::DependenceInfo &(llvm::Function &)> GetDI =
+      [this](llvm::Function &F) -> llvm::DependenceInfo & {
+    return this->getAnalysis<llvm::DependenceAnalysisWrapperPass>(F).getDI();
+  };
+
+  std::function<llvm::TargetTransformInfo &(llvm::Function &)> GetTTI =
+      [this](llvm::Function &F) -> llvm::TargetTransformInfo & {
+    return this->getAnalysis<llvm::TargetTransformInfoWrapperPass>().getTTI(F);
+  };
+
+  return pass.perform(M, GetSE, GetMDR, GetAA, GetDI, GetTTI);
 }
 
 } // namespace atrox
@@ -0,0 +1,336 @@
+//
+//
+//
+
+#include "Atrox/Transforms/PayloadInterchanger.hpp"
+
+#include "Atrox/Analysis/LoopNestLegality.hpp"
+
+#include "llvm/Analysis/ScalarEvolution.h"
+// using llvm::ScalarEvolution
+// using llvm::SCEV
+
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
+// using llvm::SCEVAddRecExpr
+// using llvm::SCEVConstant
+
+#include "llvm/Analysis/LoopInfo.h"
+// using llvm::LoopInfo
+// using llvm::Loop
+
+#include "llvm/IR/Dominators.h"
+// using llvm::DominatorTree
+
+#include "llvm/IR/Instructions.h"
+// using llvm::LoadInst
+// using llvm::StoreInst
+// using llvm::PHINode
+// using llvm::BranchInst
+
+#include "llvm/IR/Function.h"
+// using llvm::Function
+
+#include "llvm/ADT/Optional.h"
+// using llvm::Optional
+
+#include "llvm/Support/Debug.h"
+// using LLVM_DEBUG macro
+// using llvm::dbgs
+
+#include <cstdlib>
+// using std::llabs
+
+#define DEBUG_TYPE "atrox-interchange"
+
+namespace {
+
+// the step of a pointer in a loop, which is zero when it does not change
+llvm::Optional<int64_t> GetStep(const llvm::SCEV *Ptr, const llvm::Loop &L,
+                                llvm::ScalarEvolution &SE) {
+  if (SE.isLoopInvariant(Ptr, &L)) {
+    return 0;
+  }
+
+  auto *ar = llvm::dyn_cast<llvm::SCEVAddRecExpr>(Ptr);
+  auto *step = ar ? llvm::dyn_cast<llvm::SCEVConstant>(
+                        ar->getStepRecurrence(SE))
+                  : nullptr;
+
+  if (!ar || ar->getLoop() != &L || !ar->isAffine() || !step) {
+    return llvm::None;
+  }
+
+  return step->getAPInt().getSExtValue();
+}
+
+bool IsUsedOnlyIn(llvm::Instruction &I, const llvm::Loop &L,
+                  const atrox::CountedLoopShape &Shape) {
+  for (auto *u : I.users()) {
+    auto *user = llvm::cast<llvm::Instruction>(u);
+
+    if (user != Shape.IndVar && user != Shape.Inc && user != Shape.Cmp &&
+        !L.contains(user)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool IsUsedOnlyByControl(llvm::Instruction &I,
+                         const atrox::CountedLoopShape &Shape) {
+  for (auto *u : I.users()) {
+    if (u != Shape.IndVar && u != Shape.Cmp) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// checks that the iteration spaces of two loops can be swapped, which
+// requires that both loops test their bound in the same place, that their
+// induction variables are only used by the inner loop, that the values of the
+// inner loop are not used outside of it and that only the outer loop decides
+// whether the inner one is entered
+bool AreSwappable(const llvm::Loop &Outer, const llvm::Loop &Inner,
+                  const atrox::CountedLoopShape &OuterShape,
+                  const atrox::CountedLoopShape &InnerShape) {
+  // a rotated loop has no guard for the range that it would take over, so it
+  // would enter its body once even if the range is empty
+  if (OuterShape.IsRotated != InnerShape.IsRotated ||
+      OuterShape.Pred != InnerShape.Pred ||
+      OuterShape.IndVar->getType() != InnerShape.IndVar->getType() ||
+      !IsUsedOnlyIn(*OuterShape.IndVar, Inner, OuterShape) ||
+      !IsUsedOnlyByControl(*OuterShape.Inc, OuterShape) ||
+      !IsUsedOnlyByControl(*InnerShape.Inc, InnerShape)) {
+    return false;
+  }
+
+  for (auto *bb : Inner.blocks()) {
+    for (auto &e : *bb) {
+      if (!IsUsedOnlyIn(e, Inner, InnerShape)) {
+        return false;
+      }
+    }
+  }
+
+  auto *exiting = Outer.getExitingBlock();
+
+  for (auto *bb : Outer.blocks()) {
+    if (Inner.contains(bb) || bb == exiting) {
+      continue;
+    }
+
+    auto *br = llvm::dyn_cast<llvm::BranchInst>(bb->getTerminator());
+
+    if (!br || (br->isConditional() &&
+                !Outer.isLoopInvariant(br->getCondition()))) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+} // namespace
+
+namespace atrox {
+
+void PayloadInterchanger::analyze(llvm::Loop &L,
+                                  llvm::ArrayRef<MemAccInst> Accesses) {
+  Candidates.clear();
+
+  for (auto *outer : L.getLoopsInPreorder()) {
+    if (outer == &L || outer->getSubLoops().size() != 1) {
+      continue;
+    }
+
+    auto *inner = outer->getSubLoops().front();
+
+    if (!inner->getSubLoops().empty()) {
+      continue;
+    }
+
+    unsigned improved = 0;
+    unsigned worsened = 0;
+    bool isAffine = true;
+
+    for (auto e : Accesses) {
+      auto *i = e.get();
+
+      if (!inner->contains(i)) {
+        continue;
+      }
+
+      if (!llvm::isa<llvm::LoadInst>(i) && !llvm::isa<llvm::StoreInst>(i)) {
+        isAffine = false;
+        continue;
+      }
+
+      auto *ptr = SE->getSCEV(e.getPointerOperand());
+      auto innerStep = GetStep(ptr, *inner, *SE);
+      auto *ar = llvm::dyn_cast<llvm::SCEVAddRecExpr>(ptr);
+      auto outerStep =
+          GetStep(innerStep && *innerStep ? ar->getStart() : ptr, *outer, *SE);
+
+      if (!innerStep || !outerStep) {
+        isAffine = false;
+        continue;
+      }
+
+      if (std::llabs(*outerStep) < std::llabs(*innerStep)) {
+        ++improved;
+      } else if (std::llabs(*innerStep) < std::llabs(*outerStep)) {
+        ++worsened;
+      }
+    }
+
+    if (improved <= worsened) {
+      continue;
+    }
+
+    auto status = InterchangeStatus::Applied;
+    auto outerShape = MatchCountedLoop(*outer, *outer);
+    auto innerShape = MatchCountedLoop(*inner, *outer);
+
+    if (!isAffine) {
+      status = InterchangeStatus::NonAffine;
+    } else if (!IsPerfectLoopNest(*outer, *inner) || !outerShape ||
+               !innerShape ||
+               !AreSwappable(*outer, *inner, *outerShape, *innerShape)) {
+      status = InterchangeStatus::UnsupportedShape;
+    } else if (!IsInterchangeLegal(DI, *outer, *inner, Accesses)) {
+      status = InterchangeStatus::Dependence;
+    }
+
+    LLVM_DEBUG(llvm::dbgs() << "interchange candidate with " << improved
+                            << " improved and " << worsened
+                            << " worsened accesses: "
+                            << inner->getHeader()->getName() << " ("
+                            << toString(status) << ")\n";);
+
+    Candidates.push_back({outer, inner, status, improved, worsened});
+  }
+}
+
+void PayloadInterchanger::getInterchangeable(
+    llvm::SmallVectorImpl<llvm::Loop *> &Loops) const {
+  for (const auto &e : Candidates) {
+    if (e.Status == InterchangeStatus::Applied) {
+      Loops.push_back(e.Outer);
+    }
+  }
+}
+
+bool PayloadInterchanger::insertInterchange(const Candidate &C,
+                                            GetCloneFuncTy GetClone) {
+  auto *innerHeader =
+      llvm::dyn_cast_or_null<llvm::BasicBlock>(GetClone(C.Inner->getHeader()));
+  auto *outerHeader =
+      llvm::dyn_cast_or_null<llvm::BasicBlock>(GetClone(C.Outer->getHeader()));
+
+  if (!innerHeader || !outerHeader) {
+    return false;
+  }
+
+  llvm::DominatorTree DT{*innerHeader->getParent()};
+  llvm::LoopInfo LI{DT};
+
+  auto *inner = LI.getLoopFor(innerHeader);
+  auto *outer = LI.getLoopFor(outerHeader);
+
+  if (!inner || !outer || inner->getHeader() != innerHeader ||
+      outer->getHeader() != outerHeader ||
+      !IsPerfectLoopNest(*outer, *inner)) {
+    return false;
+  }
+
+  auto outerShape = MatchCountedLoop(*outer, *outer);
+  auto innerShape = MatchCountedLoop(*inner, *outer);
+
+  if (!outerShape || !innerShape ||
+      !AreSwappable(*outer, *inner, *outerShape, *innerShape)) {
+    LLVM_DEBUG(llvm::dbgs() << "unsupported nest shape: "
+                            << outerHeader->getName() << '\n';);
+    return false;
+  }
+
+  // the body of the inner loop sees the induction variables swapped, while
+  // each loop takes over the iteration space of the other
+  llvm::SmallVector<llvm::Use *, 8> outerUses, innerUses;
+
+  auto collectUses = [](const CountedLoopShape &Shape,
+                        llvm::SmallVectorImpl<llvm::Use *> &Uses) {
+    for (auto &u : Shape.IndVar->uses()) {
+      if (u.getUser() != Shape.Inc && u.getUser() != Shape.Cmp) {
+        Uses.push_back(&u);
+      }
+    }
+  };
+
+  collectUses(*outerShape, outerUses);
+  collectUses(*innerShape, innerUses);
+
+  for (auto *u : outerUses) {
+    u->set(innerShape->IndVar);
+  }
+
+  for (auto *u : innerUses) {
+    u->set(outerShape->IndVar);
+  }
+
+  auto *outerStart = outerShape->getStart();
+  auto *outerEnd = outerShape->getEnd();
+
+  outerShape->IndVar->setIncomingValue(
+      outerShape->IndVar->getBasicBlockIndex(outerShape->Preheader),
+      innerShape->getStart());
+  outerShape->Cmp->setOperand(outerShape->EndIndex, innerShape->getEnd());
+  innerShape->IndVar->setIncomingValue(
+      innerShape->IndVar->getBasicBlockIndex(innerShape->Preheader),
+      outerStart);
+  innerShape->Cmp->setOperand(innerShape->EndIndex, outerEnd);
+
+  // the increments do not wrap for the iteration spaces they take over
+  bool hasNSW = outerShape->Inc->hasNoSignedWrap();
+  bool hasNUW = outerShape->Inc->hasNoUnsignedWrap();
+
+  outerShape->Inc->setHasNoSignedWrap(innerShape->Inc->hasNoSignedWrap());
+  outerShape->Inc->setHasNoUnsignedWrap(innerShape->Inc->hasNoUnsignedWrap());
+  innerShape->Inc->setHasNoSignedWrap(hasNSW);
+  innerShape->Inc->setHasNoUnsignedWrap(hasNUW);
+
+  LLVM_DEBUG(llvm::dbgs() << "interchanged nest: " << outerHeader->getName()
+                          << '\n';);
+
+  return true;
+}
+
+unsigned PayloadInterchanger::insert(GetCloneFuncTy GetClone) {
+  unsigned n = 0;
+
+  for (auto &e : Candidates) {
+    if (e.Status != InterchangeStatus::Applied) {
+      continue;
+    }
+
+    if (insertInterchange(e, GetClone)) {
+      ++n;
+    } else {
+      e.Status = InterchangeStatus::UnsupportedShape;
+    }
+  }
+
+  return n;
+}
+
+void PayloadInterchanger::getSpecs(std::vector<InterchangeSpec> &Specs) const {
+  for (const auto &e : Candidates) {
+    Specs.push_back({e.Inner->getHeader()->getName().str(),
+                     e.Outer->getHeader()->getName().str(), e.Status,
+                     e.Improved, e.Worsened});
+  }
+}
+
+} // namespace atrox
@@ -0,0 +1,557 @@
+//
+//
+//
+
+#include "Atrox/Transforms/PayloadPrefetcher.hpp"
+
+#include "Atrox/Analysis/PayloadWeights.hpp"
+
+#include "Atrox/Analysis/LoopBoundsAnalyzer.hpp"
+
+#include "llvm/Config/llvm-config.h"
+// using LLVM_VERSION_MAJOR
+
+#include "llvm/Analysis/ScalarEvolution.h"
+// using llvm::ScalarEvolution
+// using llvm::SCEV
+
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
+// using llvm::SCEVAddRecExpr
+// using llvm::SCEVConstant
+// using llvm::SCEVUnknown
+// using llvm::visitAll
+
+#include "llvm/Analysis/LoopInfo.h"
+// using llvm::LoopInfo
+// using llvm::Loop
+
+#include "llvm/IR/DataLayout.h"
+// using llvm::DataLayout
+
+#include "llvm/IR/Instructions.h"
+// using llvm::LoadInst
+// using llvm::StoreInst
+// using llvm::PHINode
+// using llvm::GetElementPtrInst
+
+#include "llvm/IR/InstrTypes.h"
+// using llvm::CastInst
+// using llvm::BinaryOperator
+
+#include "llvm/IR/IRBuilder.h"
+// using llvm::IRBuilder
+
+#include "llvm/IR/Intrinsics.h"
+// using llvm::Intrinsic::getDeclaration
+
+#include "llvm/IR/Module.h"
+// using llvm::Module
+
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
+// using llvm::SplitBlockAndInsertIfThen
+
+#include "llvm/ADT/Optional.h"
+// using llvm::Optional
+
+#include "llvm/ADT/SmallVector.h"
+// using llvm::SmallVector
+
+#include "llvm/ADT/STLExtras.h"
+// using llvm::any_of
+
+#include "llvm/Support/Debug.h"
+// using LLVM_DEBUG macro
+// using llvm::dbgs
+
+#include <cstdlib>
+// using std::llabs
+
+#define DEBUG_TYPE "atrox-prefetch"
+
+namespace {
+
+constexpr unsigned MaxAddressDepth = 8;
+
+llvm::Optional<int64_t> GetAffineStride(const llvm::SCEV *Ptr,
+                                        const llvm::Loop &L,
+                                        llvm::ScalarEvolution &SE) {
+  auto *ar = llvm::dyn_cast<llvm::SCEVAddRecExpr>(Ptr);
+
+  if (!ar || !ar->isAffine() || ar->getLoop() != &L) {
+    return llvm::None;
+  }
+
+  auto *step = llvm::dyn_cast<llvm::SCEVConstant>(ar->getStepRecurrence(SE));
+  if (!step || step->getValue()->isZero()) {
+    return llvm::None;
+  }
+
+  return step->getAPInt().getSExtValue();
+}
+
+std::string GetBaseName(const llvm::SCEV *Ptr, llvm::ScalarEvolution &SE) {
+  auto *base = llvm::dyn_cast<llvm::SCEVUnknown>(SE.getPointerBase(Ptr));
+
+  return base ? base->getValue()->getName().str() : std::string{};
+}
+
+// collects the values loaded in a loop that an expression depends on
+struct LoadedValuesCollector {
+  const llvm::Loop &L;
+  llvm::SmallVector<llvm::LoadInst *, 2> Loads;
+
+  explicit LoadedValuesCollector(const llvm::Loop &L) : L(L) {}
+
+  bool follow(const llvm::SCEV *S) {
+    if (auto *u = llvm::dyn_cast<llvm::SCEVUnknown>(S)) {
+      auto *ld = llvm::dyn_cast<llvm::LoadInst>(u->getValue());
+
+      if (ld && L.contains(ld)) {
+        Loads.push_back(ld);
+      }
+    }
+
+    return true;
+  }
+
+  bool isDone() const { return false; }
+};
+
+llvm::Value *CreatePrefetch(llvm::Value *Ptr, int64_t Offset, bool IsWrite,
+                            llvm::IRBuilder<> &Builder) {
+  auto &ctx = Builder.getContext();
+  auto *m = Builder.GetInsertBlock()->getModule();
+  auto *i8Ty = llvm::Type::getInt8Ty(ctx);
+  auto *i32Ty = llvm::Type::getInt32Ty(ctx);
+  auto addrSpace = Ptr->getType()->getPointerAddressSpace();
+
+  // the prefetched address might be past the end of the accessed object,
+  // which is harmless for a prefetch
+  auto *addr =
+      Builder.CreateBitCast(Ptr, llvm::PointerType::get(i8Ty, addrSpace));
+  if (Offset) {
+    addr = Builder.CreateGEP(i8Ty, addr, Builder.getInt64(Offset),
+                             "prefetch.addr");
+  }
+
+#if LLVM_VERSION_MAJOR >= 10
+  auto *prefetch = llvm::Intrinsic::getDeclaration(
+      m, llvm::Intrinsic::prefetch, {addr->getType()});
+#else
+  auto *prefetch =
+      llvm::Intrinsic::getDeclaration(m, llvm::Intrinsic::prefetch);
+#endif
+
+  return Builder.CreateCall(prefetch,
+                            {addr, llvm::ConstantInt::get(i32Ty, IsWrite),
+                             llvm::ConstantInt::get(i32Ty, 3),
+                             llvm::ConstantInt::get(i32Ty, 1)});
+}
+
+// materializes an expression of the original function in the extracted one
+llvm::Value *
+Materialize(const llvm::SCEV *S, llvm::IRBuilder<> &Builder,
+            llvm::ScalarEvolution &SE, const atrox::LoopBoundsAnalyzer &LBA,
+            llvm::function_ref<llvm::Value *(llvm::Value *)> GetClone) {
+  if (auto *c = llvm::dyn_cast<llvm::SCEVConstant>(S)) {
+    return c->getValue();
+  }
+
+  if (auto *u = llvm::dyn_cast<llvm::SCEVUnknown>(S)) {
+    auto *v = u->getValue();
+    return llvm::isa<llvm::Constant>(v) ? v : GetClone(v);
+  }
+
+  if (auto *ar = llvm::dyn_cast<llvm::SCEVAddRecExpr>(S)) {
+    auto info = LBA.getInfo(const_cast<llvm::Loop *>(ar->getLoop()));
+
+    if (info && info->InductionVariable &&
+        SE.getSCEV(info->InductionVariable) == ar) {
+      return GetClone(info->InductionVariable);
+    }
+
+    return nullptr;
+  }
+
+  if (auto *c = llvm::dyn_cast<llvm::SCEVCastExpr>(S)) {
+    auto *op = Materialize(c->getOperand(), Builder, SE, LBA, GetClone);
+    if (!op || !op->getType()->isIntegerTy()) {
+      return nullptr;
+    }
+
+    if (llvm::isa<llvm::SCEVSignExtendExpr>(S)) {
+      return Builder.CreateSExt(op, S->getType());
+    }
+
+    return Builder.CreateZExtOrTrunc(op, S->getType());
+  }
+
+  if (auto *d = llvm::dyn_cast<llvm::SCEVUDivExpr>(S)) {
+    auto *lhs = Materialize(d->getLHS(), Builder, SE, LBA, GetClone);
+    auto *rhs = Materialize(d->getRHS(), Builder, SE, LBA, GetClone);
+
+    return lhs && rhs ? Builder.CreateUDiv(lhs, rhs) : nullptr;
+  }
+
+  auto *n = llvm::dyn_cast<llvm::SCEVNAryExpr>(S);
+  if (!n || !S->getType()->isIntegerTy()) {
+    return nullptr;
+  }
+
+  llvm::Value *result = nullptr;
+
+  for (auto *e : n->operands()) {
+    auto *op = Materialize(e, Builder, SE, LBA, GetClone);
+    if (!op || op->getType() != S->getType()) {
+      return nullptr;
+    }
+
+    if (!result) {
+      result = op;
+    } else if (llvm::isa<llvm::SCEVAddExpr>(S)) {
+      result = Builder.CreateAdd(result, op);
+    } else if (llvm::isa<llvm::SCEVMulExpr>(S)) {
+      result = Builder.CreateMul(result, op);
+    } else if (llvm::isa<llvm::SCEVSMaxExpr>(S)) {
+      result = Builder.CreateSelect(Builder.CreateICmpSGT(result, op), result,
+                                    op);
+    } else if (llvm::isa<llvm::SCEVUMaxExpr>(S)) {
+      result = Builder.CreateSelect(Builder.CreateICmpUGT(result, op), result,
+                                    op);
+    } else {
+      return nullptr;
+    }
+  }
+
+  return result;
+}
+
+bool IsClonableAddressPart(llvm::Value *V) {
+  return llvm::isa<llvm::CastInst>(V) || llvm::isa<llvm::BinaryOperator>(V) ||
+         llvm::isa<llvm::GetElementPtrInst>(V);
+}
+
+bool IsComputedFromIndex(llvm::Value *V, llvm::Value *Index,
+                         unsigned Depth = 0) {
+  if (V == Index) {
+    return true;
+  }
+
+  auto *i = llvm::dyn_cast<llvm::Instruction>(V);
+  if (!i || Depth > MaxAddressDepth || !IsClonableAddressPart(i)) {
+    return false;
+  }
+
+  for (auto &op : i->operands()) {
+    if (IsComputedFromIndex(op.get(), Index, Depth + 1)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// clones the computation of an address from an index, using another index
+llvm::Value *CloneIndexedAddress(llvm::Value *V, llvm::Value *Index,
+                                 llvm::Value *NewIndex,
+                                 llvm::IRBuilder<> &Builder,
+                                 unsigned Depth = 0) {
+  if (V == Index) {
+    return NewIndex;
+  }
+
+  auto *i = llvm::dyn_cast<llvm::Instruction>(V);
+  if (!i || Depth > MaxAddressDepth || !IsClonableAddressPart(i)) {
+    return V;
+  }
+
+  llvm::SmallVector<llvm::Value *, 4> ops;
+  bool hasChanged = false;
+
+  for (auto &op : i->operands()) {
+    ops.push_back(
+        CloneIndexedAddress(op.get(), Index, NewIndex, Builder, Depth + 1));
+    hasChanged |= ops.back() != op.get();
+  }
+
+  if (!hasChanged) {
+    return V;
+  }
+
+  auto *clone = i->clone();
+  for (unsigned k = 0; k < ops.size(); ++k) {
+    clone->setOperand(k, ops[k]);
+  }
+
+  // the index used for prefetching might not have been checked by the program
+  if (auto *gep = llvm::dyn_cast<llvm::GetElementPtrInst>(clone)) {
+    gep->setIsInBounds(false);
+  } else if (llvm::isa<llvm::BinaryOperator>(clone)) {
+    clone->dropPoisonGeneratingFlags();
+  }
+
+  return Builder.Insert(clone, "prefetch.idx");
+}
+
+llvm::Value *GetPointerOperand(llvm::Instruction *I) {
+  if (auto *ld = llvm::dyn_cast<llvm::LoadInst>(I)) {
+    return ld->getPointerOperand();
+  }
+
+  return llvm::cast<llvm::StoreInst>(I)->getPointerOperand();
+}
+
+} // namespace
+
+namespace atrox {
+
+unsigned PayloadPrefetcher::getDistance(
+    llvm::Loop &L, llvm::ArrayRef<llvm::BasicBlock *> Blocks) const {
+  llvm::SmallVector<llvm::BasicBlock *, 32> blocks;
+
+  for (auto *e : Blocks) {
+    if (L.contains(e)) {
+      blocks.push_back(e);
+    }
+  }
+
+  PayloadWeightTy weight = 0;
+  for (const auto &e : CalculatePayloadWeight(blocks)) {
+    weight += e.second;
+  }
+
+  if (!weight) {
+    return 1;
+  }
+
+  return (Latency + weight - 1) / weight;
+}
+
+void PayloadPrefetcher::analyzeIndirect(llvm::Instruction &I,
+                                        llvm::Loop &CurL, unsigned Distance) {
+  auto *ptr = SE->getSCEV(GetPointerOperand(&I));
+
+  LoadedValuesCollector lvc{CurL};
+  llvm::visitAll(ptr, lvc);
+
+  if (lvc.Loads.size() != 1) {
+    return;
+  }
+
+  auto *index = lvc.Loads.front();
+  if (LI->getLoopFor(index->getParent()) != &CurL) {
+    return;
+  }
+
+  auto *indexPtr = SE->getSCEV(index->getPointerOperand());
+  auto indexStride = GetAffineStride(indexPtr, CurL, *SE);
+  if (!indexStride) {
+    return;
+  }
+
+  auto info = LBA->getInfo(&CurL);
+  if (!info || !info->InductionVariable || !info->End ||
+      !info->InductionVariable->getType()->isIntegerTy()) {
+    LLVM_DEBUG(llvm::dbgs() << "no bounds to guard indirect access: " << I
+                            << '\n';);
+    return;
+  }
+
+  auto indVarStep =
+      GetAffineStride(SE->getSCEV(info->InductionVariable), CurL, *SE);
+  if (!indVarStep) {
+    return;
+  }
+
+  for (const auto &e : IndirectCandidates) {
+    if (e.Index == index && SE->getSCEV(GetPointerOperand(e.Access)) == ptr) {
+      return;
+    }
+  }
+
+  // the bounds analyzer evaluates the induction variable at the backedge taken
+  // count; a loop that exits from its header never executes that value
+  bool isEndInclusive = CurL.getExitingBlock() &&
+                        CurL.getExitingBlock() == CurL.getLoopLatch();
+
+  LLVM_DEBUG(llvm::dbgs() << "indirect prefetch candidate with distance "
+                          << Distance << ": " << I << '\n';);
+
+  IndirectCandidates.push_back({&I, index, &CurL, *indexStride, Distance,
+                                info->InductionVariable, *indVarStep,
+                                info->End, isEndInclusive,
+                                GetBaseName(ptr, *SE),
+                                GetBaseName(indexPtr, *SE)});
+}
+
+void PayloadPrefetcher::analyze(llvm::Loop &L,
+                                llvm::ArrayRef<llvm::BasicBlock *> Blocks,
+                                llvm::ArrayRef<MemAccInst> Accesses,
+                                unsigned Distance, bool IncludeIndirect,
+                                llvm::ArrayRef<llvm::Loop *> Excluded) {
+  Candidates.clear();
+  Inserted.clear();
+  IndirectCandidates.clear();
+  InsertedIndirect.clear();
+
+  // the pointers of the accesses kept so far
+  llvm::SmallVector<const llvm::SCEV *, 8> kept;
+
+  for (auto e : Accesses) {
+    auto *i = e.get();
+
+    if (!llvm::isa<llvm::LoadInst>(i) && !llvm::isa<llvm::StoreInst>(i)) {
+      continue;
+    }
+
+    auto *curL = LI->getLoopFor(i->getParent());
+    if (!curL || !L.contains(curL) ||
+        llvm::any_of(Excluded,
+                     [curL](llvm::Loop *E) { return E->contains(curL); })) {
+      continue;
+    }
+
+    unsigned distance = Distance ? Distance : getDistance(*curL, Blocks);
+    auto *ptr = SE->getSCEV(e.getPointerOperand());
+    auto stride = GetAffineStride(ptr, *curL, *SE);
+
+    if (!stride) {
+      if (IncludeIndirect && LBA) {
+        analyzeIndirect(*i, *curL, distance);
+      }
+
+      continue;
+    }
+
+    bool isCovered = false;
+
+    for (size_t k = 0; k < Candidates.size(); ++k) {
+      if (Candidates[k].L != curL || Candidates[k].Stride != *stride) {
+        continue;
+      }
+
+      auto *diff =
+          llvm::dyn_cast<llvm::SCEVConstant>(SE->getMinusSCEV(ptr, kept[k]));
+
+      if (diff && std::llabs(diff->getAPInt().getSExtValue()) <
+                      static_cast<int64_t>(CacheLineSize)) {
+        isCovered = true;
+        break;
+      }
+    }
+
+    if (isCovered) {
+      LLVM_DEBUG(llvm::dbgs() << "access shares a prefetched cache line: "
+                              << *i << '\n';);
+      continue;
+    }
+
+    LLVM_DEBUG(llvm::dbgs() << "prefetch candidate with stride " << *stride
+                            << " and distance " << distance << ": " << *i
+                            << '\n';);
+
+    Candidates.push_back({i, curL, *stride, distance, GetBaseName(ptr, *SE)});
+    kept.push_back(ptr);
+  }
+}
+
+bool PayloadPrefetcher::insertIndirect(const IndirectCandidate &C,
+                                       GetCloneFuncTy GetClone) {
+  auto *access = llvm::dyn_cast_or_null<llvm::Instruction>(GetClone(C.Access));
+  auto *index = llvm::dyn_cast_or_null<llvm::LoadInst>(GetClone(C.Index));
+  auto *indVar = GetClone(C.IndVar);
+
+  if (!access || !index || !indVar ||
+      !IsComputedFromIndex(GetPointerOperand(access), index)) {
+    return false;
+  }
+
+  llvm::IRBuilder<> builder{access};
+
+  auto *end = Materialize(C.End, builder, *SE, *LBA, GetClone);
+  if (!end || end->getType() != indVar->getType()) {
+    LLVM_DEBUG(llvm::dbgs() << "cannot materialize loop end: " << *C.End
+                            << '\n';);
+    return false;
+  }
+
+  // first stage: bring in the index that will be used by the second stage
+  auto *indexPtr = index->getPointerOperand();
+  auto distance = static_cast<int64_t>(C.Distance);
+  CreatePrefetch(indexPtr, 2 * distance * C.IndexStride, false, builder);
+
+  // second stage: use the index that is a distance ahead, if it is within the
+  // iteration space
+  auto *next = builder.CreateAdd(
+      indVar, llvm::ConstantInt::get(indVar->getType(),
+                                     distance * C.IndVarStep, true));
+  auto pred = C.IndVarStep > 0
+                  ? (C.IsEndInclusive ? llvm::ICmpInst::ICMP_SLE
+                                      : llvm::ICmpInst::ICMP_SLT)
+                  : (C.IsEndInclusive ? llvm::ICmpInst::ICMP_SGE
+                                      : llvm::ICmpInst::ICMP_SGT);
+  auto *cond = builder.CreateICmp(pred, next, end);
+
+  auto *then = llvm::SplitBlockAndInsertIfThen(cond, access, false);
+  builder.SetInsertPoint(then);
+
+  auto *i8Ty = builder.getInt8Ty();
+  auto addrSpace = indexPtr->getType()->getPointerAddressSpace();
+  auto *nextIndexPtr = builder.CreateGEP(
+      i8Ty,
+      builder.CreateBitCast(indexPtr, llvm::PointerType::get(i8Ty, addrSpace)),
+      builder.getInt64(distance * C.IndexStride));
+  auto *nextIndex = builder.CreateLoad(
+      index->getType(),
+      builder.CreateBitCast(nextIndexPtr, indexPtr->getType()),
+      "prefetch.idx");
+
+  auto *nextPtr =
+      CloneIndexedAddress(GetPointerOperand(access), index, nextIndex, builder);
+  CreatePrefetch(nextPtr, 0, llvm::isa<llvm::StoreInst>(access), builder);
+
+  return true;
+}
+
+unsigned PayloadPrefetcher::insert(GetCloneFuncTy GetClone) {
+  Inserted.clear();
+  InsertedIndirect.clear();
+
+  for (const auto &e : Candidates) {
+    auto *clone = llvm::dyn_cast_or_null<llvm::Instruction>(GetClone(e.Access));
+
+    if (!clone) {
+      continue;
+    }
+
+    llvm::IRBuilder<> builder{clone};
+    CreatePrefetch(GetPointerOperand(clone), e.Stride * e.Distance,
+                   llvm::isa<llvm::StoreInst>(clone), builder);
+
+    Inserted.push_back(e);
+  }
+
+  for (const auto &e : IndirectCandidates) {
+    if (insertIndirect(e, GetClone)) {
+      InsertedIndirect.push_back(e);
+    }
+  }
+
+  return Inserted.size() + InsertedIndirect.size();
+}
+
+void PayloadPrefetcher::getSpecs(std::vector<PrefetchSpec> &Specs) const {
+  for (const auto &e : Inserted) {
+    Specs.push_back({PrefetchKind::Strided, e.Base, "",
+                     e.L->getHeader()->getName().str(), e.Stride, e.Distance,
+                     llvm::isa<llvm::StoreInst>(e.Access)});
+  }
+
+  for (const auto &e : InsertedIndirect) {
+    Specs.push_back({PrefetchKind::Indirect, e.Base, e.IndexBase,
+                     e.L->getHeader()->getName().str(), e.IndexStride,
+                     e.Distance, llvm::isa<llvm::StoreInst>(e.Access)});
+  }
+}
+
+} // namespace atrox
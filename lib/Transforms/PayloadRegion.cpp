@@ -0,0 +1,333 @@
+//
+//
+//
+
+#include "Atrox/Transforms/PayloadRegion.hpp"
+
+#include "Atrox/Support/IR/GeneralUtils.hpp"
+
+#include "llvm/Analysis/LoopInfo.h"
+// using llvm::Loop
+
+#include "llvm/Analysis/AliasAnalysis.h"
+// using llvm::AAResults
+
+#include "llvm/Analysis/MemoryLocation.h"
+// using llvm::MemoryLocation
+
+#include "llvm/IR/Function.h"
+// using llvm::Function
+
+#include "llvm/IR/Module.h"
+// using llvm::Module
+
+#include "llvm/IR/Instructions.h"
+// using llvm::LoadInst
+// using llvm::StoreInst
+// using llvm::CallInst
+// using llvm::BranchInst
+// using llvm::PHINode
+
+#include "llvm/IR/IntrinsicInst.h"
+// using llvm::DbgInfoIntrinsic
+
+#include "llvm/IR/CFG.h"
+// using llvm::predecessors
+// using llvm::successors
+
+#include "llvm/ADT/SmallPtrSet.h"
+// using llvm::SmallPtrSet
+
+#include "llvm/ADT/SmallVector.h"
+// using llvm::SmallVector
+
+#include "llvm/Support/Debug.h"
+// using LLVM_DEBUG macro
+// using llvm::dbgs
+
+#define DEBUG_TYPE "atrox-payload-region"
+
+namespace {
+
+using RegionTy = llvm::SmallPtrSet<llvm::BasicBlock *, 16>;
+
+// return the single block of the region that is entered from outside of it
+llvm::BasicBlock *GetRegionEntry(const RegionTy &Region) {
+  llvm::BasicBlock *entry = nullptr;
+
+  for (auto *bb : Region) {
+    for (auto *pred : llvm::predecessors(bb)) {
+      if (Region.count(pred)) {
+        continue;
+      }
+
+      if (entry && entry != bb) {
+        return nullptr;
+      }
+
+      entry = bb;
+    }
+  }
+
+  return entry;
+}
+
+// return the single block outside of the region that the region exits to
+llvm::BasicBlock *GetRegionExit(const RegionTy &Region) {
+  llvm::BasicBlock *exit = nullptr;
+
+  for (auto *bb : Region) {
+    for (auto *succ : llvm::successors(bb)) {
+      if (Region.count(succ)) {
+        continue;
+      }
+
+      if (exit && exit != succ) {
+        return nullptr;
+      }
+
+      exit = succ;
+    }
+  }
+
+  return exit;
+}
+
+// return the single value that each exit phi receives from the region
+bool GetExitValues(const RegionTy &Region, llvm::BasicBlock &Exit,
+                   llvm::SmallVectorImpl<llvm::Value *> &Values) {
+  for (auto &phi : Exit.phis()) {
+    llvm::Value *value = nullptr;
+
+    for (unsigned i = 0; i < phi.getNumIncomingValues(); ++i) {
+      if (!Region.count(phi.getIncomingBlock(i))) {
+        continue;
+      }
+
+      auto *v = phi.getIncomingValue(i);
+      auto *inst = llvm::dyn_cast<llvm::Instruction>(v);
+
+      if ((value && value != v) || (inst && Region.count(inst->getParent()))) {
+        return false;
+      }
+
+      value = v;
+    }
+
+    Values.push_back(value);
+  }
+
+  return true;
+}
+
+bool CollectMemoryAccesses(llvm::BasicBlock &BB,
+                           llvm::SmallVectorImpl<llvm::Instruction *> &Accs) {
+  for (auto &i : BB) {
+    if (!i.mayReadOrWriteMemory() || llvm::isa<llvm::DbgInfoIntrinsic>(i)) {
+      continue;
+    }
+
+    if (auto *call = llvm::dyn_cast<llvm::CallInst>(&i)) {
+      if (call->doesNotAccessMemory()) {
+        continue;
+      }
+
+      LLVM_DEBUG(llvm::dbgs() << "cannot reason about call: " << i << '\n';);
+      return false;
+    }
+
+    if (!llvm::isa<llvm::LoadInst>(i) && !llvm::isa<llvm::StoreInst>(i)) {
+      LLVM_DEBUG(llvm::dbgs() << "cannot reason about access: " << i << '\n';);
+      return false;
+    }
+
+    Accs.push_back(&i);
+  }
+
+  return true;
+}
+
+llvm::MemoryLocation GetLocation(llvm::Instruction *I) {
+  if (auto *ld = llvm::dyn_cast<llvm::LoadInst>(I)) {
+    return llvm::MemoryLocation::get(ld);
+  }
+
+  return llvm::MemoryLocation::get(llvm::cast<llvm::StoreInst>(I));
+}
+
+} // namespace
+
+namespace atrox {
+
+bool IsPayloadRegionReplaceable(
+    llvm::Loop &L, llvm::ArrayRef<llvm::BasicBlock *> PayloadBlocks) {
+  if (PayloadBlocks.empty()) {
+    return false;
+  }
+
+  RegionTy region{PayloadBlocks.begin(), PayloadBlocks.end()};
+
+  // the iterator needs to remain in the loop
+  if (region.count(L.getHeader())) {
+    LLVM_DEBUG(llvm::dbgs() << "payload contains the loop header\n";);
+    return false;
+  }
+
+  if (!GetRegionEntry(region)) {
+    LLVM_DEBUG(llvm::dbgs() << "payload does not have a single entry\n";);
+    return false;
+  }
+
+  auto *exit = GetRegionExit(region);
+  llvm::SmallVector<llvm::Value *, 4> exitValues;
+
+  if (!exit || !L.contains(exit) ||
+      !GetExitValues(region, *exit, exitValues)) {
+    LLVM_DEBUG(llvm::dbgs() << "payload does not have a single exit\n";);
+    return false;
+  }
+
+  for (auto *bb : PayloadBlocks) {
+    for (auto &i : *bb) {
+      for (auto *u : i.users()) {
+        auto *ui = llvm::dyn_cast<llvm::Instruction>(u);
+
+        if (!ui || !region.count(ui->getParent())) {
+          LLVM_DEBUG(llvm::dbgs() << "payload value is used outside: " << i
+                                  << '\n';);
+          return false;
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+bool IsPayloadRegionSeparable(llvm::Loop &L,
+                              llvm::ArrayRef<llvm::BasicBlock *> PayloadBlocks,
+                              llvm::AAResults &AA) {
+  if (!L.getLoopPreheader() || !L.getExitBlock() || !L.hasDedicatedExits()) {
+    LLVM_DEBUG(llvm::dbgs() << "loop is not in a suitable form\n";);
+    return false;
+  }
+
+  if (!IsPayloadRegionReplaceable(L, PayloadBlocks)) {
+    return false;
+  }
+
+  RegionTy region{PayloadBlocks.begin(), PayloadBlocks.end()};
+
+  llvm::SmallVector<llvm::Instruction *, 16> payloadAccesses;
+  llvm::SmallVector<llvm::Instruction *, 16> iteratorAccesses;
+
+  for (auto *bb : L.blocks()) {
+    auto &accesses = region.count(bb) ? payloadAccesses : iteratorAccesses;
+
+    if (!CollectMemoryAccesses(*bb, accesses)) {
+      return false;
+    }
+  }
+
+  for (auto *p : payloadAccesses) {
+    for (auto *i : iteratorAccesses) {
+      if (llvm::isa<llvm::LoadInst>(p) && llvm::isa<llvm::LoadInst>(i)) {
+        continue;
+      }
+
+      if (!AA.isNoAlias(GetLocation(p), GetLocation(i))) {
+        LLVM_DEBUG(llvm::dbgs() << "payload access: " << *p
+                                << "\nconflicts with iterator access: " << *i
+                                << '\n';);
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+llvm::BasicBlock *
+ReplacePayloadRegion(llvm::ArrayRef<llvm::BasicBlock *> PayloadBlocks,
+                     llvm::StringRef Name) {
+  RegionTy region{PayloadBlocks.begin(), PayloadBlocks.end()};
+  auto *entry = GetRegionEntry(region);
+  auto *exit = GetRegionExit(region);
+  llvm::SmallVector<llvm::Value *, 4> exitValues;
+
+  if (!entry || !exit || !GetExitValues(region, *exit, exitValues)) {
+    return nullptr;
+  }
+
+  auto *replacement = llvm::BasicBlock::Create(
+      entry->getContext(), Name, entry->getParent(), entry);
+  llvm::BranchInst::Create(exit, replacement);
+
+  llvm::SmallVector<llvm::BasicBlock *, 4> preds;
+  for (auto *pred : llvm::predecessors(entry)) {
+    if (!region.count(pred)) {
+      preds.push_back(pred);
+    }
+  }
+
+  for (auto *pred : preds) {
+    pred->getTerminator()->replaceUsesOfWith(entry, replacement);
+  }
+
+  unsigned k = 0;
+  for (auto &phi : exit->phis()) {
+    for (int i = phi.getNumIncomingValues() - 1; i >= 0; --i) {
+      if (region.count(phi.getIncomingBlock(i))) {
+        phi.removeIncomingValue(i, false);
+      }
+    }
+
+    phi.addIncoming(exitValues[k++], replacement);
+  }
+
+  for (auto *bb : PayloadBlocks) {
+    bb->dropAllReferences();
+  }
+
+  for (auto *bb : PayloadBlocks) {
+    bb->eraseFromParent();
+  }
+
+  return replacement;
+}
+
+llvm::CallInst *
+ReplacePayloadRegionWithCall(llvm::ArrayRef<llvm::BasicBlock *> PayloadBlocks,
+                             llvm::Function &Payload,
+                             llvm::ArrayRef<llvm::Value *> Inputs) {
+  if (!Payload.getReturnType()->isVoidTy() ||
+      Payload.arg_size() != Inputs.size()) {
+    LLVM_DEBUG(llvm::dbgs() << "cannot call payload: " << Payload.getName()
+                            << '\n';);
+    return nullptr;
+  }
+
+  auto *bb = ReplacePayloadRegion(PayloadBlocks, "payload.call");
+
+  if (!bb) {
+    return nullptr;
+  }
+
+  auto *call =
+      llvm::CallInst::Create(&Payload, Inputs, "", bb->getTerminator());
+  InternalizePayload(Payload, {call});
+
+  return call;
+}
+
+llvm::Function *GetRuntimeFunction(llvm::Module &M, llvm::StringRef Name,
+                                   llvm::FunctionType *Ty) {
+  if (auto *f = M.getFunction(Name)) {
+    return f;
+  }
+
+  return llvm::Function::Create(Ty, llvm::GlobalValue::ExternalLinkage, Name,
+                                &M);
+}
+
+} // namespace atrox
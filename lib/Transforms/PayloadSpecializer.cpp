@@ -0,0 +1,261 @@
+//
+//
+//
+
+#include "Atrox/Transforms/PayloadSpecializer.hpp"
+
+#include "Atrox/Analysis/LoopBoundsAnalyzer.hpp"
+
+#include "Atrox/Support/IR/GeneralUtils.hpp"
+
+#include "llvm/Analysis/ScalarEvolution.h"
+// using llvm::ScalarEvolution
+// using llvm::SCEV
+
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
+// using llvm::SCEVConstant
+// using llvm::SCEVUnknown
+// using llvm::SCEVAddExpr
+// using llvm::SCEVCastExpr
+
+#include "llvm/Analysis/LoopInfo.h"
+// using llvm::Loop
+
+#include "llvm/IR/Function.h"
+// using llvm::Function
+
+#include "llvm/IR/Module.h"
+// using llvm::Module
+
+#include "llvm/IR/Constants.h"
+// using llvm::ConstantInt
+
+#include "llvm/IR/IRBuilder.h"
+// using llvm::IRBuilder
+
+#include "llvm/Transforms/Utils/Cloning.h"
+// using llvm::CloneFunction
+
+#include "llvm/Transforms/Utils/ValueMapper.h"
+// using llvm::ValueToValueMapTy
+
+#include "llvm/Support/MathExtras.h"
+// using llvm::isUIntN
+
+#include "llvm/Support/Debug.h"
+// using LLVM_DEBUG macro
+// using llvm::dbgs
+
+#include <algorithm>
+// using std::find
+// using std::any_of
+
+#define DEBUG_TYPE "atrox-specialize"
+
+namespace atrox {
+
+void PayloadSpecializer::addCandidate(unsigned ArgNo, const llvm::APInt &Value,
+                                      SpecializationSource Source) {
+  if (std::any_of(Candidates.begin(), Candidates.end(),
+                  [ArgNo](const auto &e) { return e.ArgNo == ArgNo; })) {
+    return;
+  }
+
+  LLVM_DEBUG(llvm::dbgs() << "specialization candidate argument " << ArgNo
+                          << " with value " << Value << " from "
+                          << toString(Source) << '\n';);
+
+  Candidates.push_back({ArgNo, Value, Source});
+}
+
+void PayloadSpecializer::analyze(llvm::Loop &L,
+                                 llvm::ArrayRef<llvm::Value *> Inputs) {
+  Candidates.clear();
+
+  for (unsigned i = 0; i < Inputs.size(); ++i) {
+    auto *ty = Inputs[i]->getType();
+
+    if (!ty->isIntegerTy() || ty->getIntegerBitWidth() > 64) {
+      continue;
+    }
+
+    auto *s = SE->getSCEVAtScope(SE->getSCEV(Inputs[i]), &L);
+
+    if (auto *c = llvm::dyn_cast<llvm::SCEVConstant>(s)) {
+      addCandidate(i, c->getAPInt(), SpecializationSource::Constant);
+    } else if (auto *c = SE->getUnsignedRange(s).getSingleElement()) {
+      addCandidate(i, *c, SpecializationSource::Constant);
+    }
+  }
+
+  if (!LBA) {
+    return;
+  }
+
+  for (auto *curL : L.getLoopsInPreorder()) {
+    auto info = LBA->getInfo(curL);
+
+    if (curL == &L || !info || !info->BackedgeTakenCount ||
+        !info->TripCount || info->TripCount > MaxTripCount) {
+      continue;
+    }
+
+    // match an input with an optional constant offset, which is the most
+    // common form of a bound that is not constant
+    const llvm::SCEV *btc = info->BackedgeTakenCount;
+
+    while (auto *cast = llvm::dyn_cast<llvm::SCEVCastExpr>(btc)) {
+      btc = cast->getOperand();
+    }
+
+    const llvm::SCEVConstant *offset = nullptr;
+
+    if (auto *add = llvm::dyn_cast<llvm::SCEVAddExpr>(btc)) {
+      offset = llvm::dyn_cast<llvm::SCEVConstant>(add->getOperand(0));
+
+      if (!offset || add->getNumOperands() != 2) {
+        continue;
+      }
+
+      btc = add->getOperand(1);
+    }
+
+    auto *u = llvm::dyn_cast<llvm::SCEVUnknown>(btc);
+
+    if (!u) {
+      continue;
+    }
+
+    auto found = std::find(Inputs.begin(), Inputs.end(), u->getValue());
+    auto width = u->getType()->getIntegerBitWidth();
+
+    if (found == Inputs.end() || width > 64 ||
+        !llvm::isUIntN(width, info->TripCount - 1)) {
+      continue;
+    }
+
+    llvm::APInt value{width, info->TripCount - 1};
+
+    if (offset) {
+      value -= offset->getAPInt();
+    }
+
+    addCandidate(std::distance(Inputs.begin(), found), value,
+                 SpecializationSource::MaxTripCount);
+  }
+}
+
+bool PayloadSpecializer::specialize(llvm::Function &Payload,
+                                    SpecializationSpec *Spec) {
+  if (Candidates.empty() || Payload.isDeclaration()) {
+    return false;
+  }
+
+  for (const auto &e : Candidates) {
+    if (e.ArgNo >= Payload.arg_size() ||
+        (Payload.arg_begin() + e.ArgNo)->getType() !=
+            llvm::IntegerType::get(Payload.getContext(),
+                                   e.Value.getBitWidth())) {
+      LLVM_DEBUG(llvm::dbgs() << "candidates do not match the parameters of: "
+                              << Payload.getName() << '\n';);
+      return false;
+    }
+  }
+
+  auto &M = *Payload.getParent();
+  auto &ctx = Payload.getContext();
+
+  // move the body to the generic variant, which keeps its instructions
+  auto *generic = llvm::Function::Create(
+      Payload.getFunctionType(), llvm::GlobalValue::InternalLinkage,
+      Payload.getName() + ".generic", &M);
+  generic->copyAttributesFrom(&Payload);
+  generic->setSubprogram(Payload.getSubprogram());
+  Payload.setSubprogram(nullptr);
+  generic->getBasicBlockList().splice(generic->end(),
+                                      Payload.getBasicBlockList());
+
+  auto genericArg = generic->arg_begin();
+  for (auto &e : Payload.args()) {
+    genericArg->setName(e.getName());
+    e.replaceAllUsesWith(&*genericArg++);
+  }
+
+  // the arguments mapped to constants are dropped from the clone
+  llvm::ValueToValueMapTy vmap;
+  for (const auto &e : Candidates) {
+    vmap[generic->arg_begin() + e.ArgNo] = llvm::ConstantInt::get(ctx, e.Value);
+  }
+
+  auto *specialized = llvm::CloneFunction(generic, vmap);
+  specialized->setName(Payload.getName() + ".spec");
+
+  // dispatch stub
+
+  auto *entry = llvm::BasicBlock::Create(ctx, "entry", &Payload);
+  auto *specializedBB = llvm::BasicBlock::Create(ctx, "specialized", &Payload);
+  auto *genericBB = llvm::BasicBlock::Create(ctx, "generic", &Payload);
+
+  llvm::IRBuilder<> builder{entry};
+  llvm::Value *isMatch = nullptr;
+
+  for (const auto &e : Candidates) {
+    auto *cmp = builder.CreateICmpEQ(Payload.arg_begin() + e.ArgNo,
+                                     llvm::ConstantInt::get(ctx, e.Value));
+    isMatch = isMatch ? builder.CreateAnd(isMatch, cmp) : cmp;
+  }
+
+  builder.CreateCondBr(isMatch, specializedBB, genericBB);
+
+  auto createCall = [&builder, &Payload](llvm::Function *Callee,
+                                         llvm::ArrayRef<llvm::Value *> Args) {
+    auto *call = builder.CreateCall(Callee, Args);
+
+    if (Payload.getReturnType()->isVoidTy()) {
+      builder.CreateRetVoid();
+    } else {
+      builder.CreateRet(call);
+    }
+
+    return call;
+  };
+
+  llvm::SmallVector<llvm::Value *, 16> args;
+  for (auto &e : Payload.args()) {
+    if (!vmap.count(generic->arg_begin() + e.getArgNo())) {
+      args.push_back(&e);
+    }
+  }
+
+  builder.SetInsertPoint(specializedBB);
+  auto *specializedCall = createCall(specialized, args);
+
+  args.clear();
+  for (auto &e : Payload.args()) {
+    args.push_back(&e);
+  }
+
+  builder.SetInsertPoint(genericBB);
+  auto *genericCall = createCall(generic, args);
+
+  InternalizePayload(*specialized, {specializedCall});
+  InternalizePayload(*generic, {genericCall});
+
+  if (Spec) {
+    Spec->Specialized = specialized->getName().str();
+    Spec->Generic = generic->getName().str();
+    Spec->Args.clear();
+
+    for (const auto &e : Candidates) {
+      Spec->Args.push_back({(Payload.arg_begin() + e.ArgNo)->getName().str(),
+                            e.Value.getSExtValue(), e.Source});
+    }
+  }
+
+  LLVM_DEBUG(llvm::dbgs() << "specialized payload: " << Payload.getName()
+                          << '\n';);
+
+  return true;
+}
+
+} // namespace atrox
@@ -0,0 +1,303 @@
+//
+//
+//
+
+#include "Atrox/Transforms/PayloadTiler.hpp"
+
+#include "Atrox/Analysis/LoopBoundsAnalyzer.hpp"
+
+#include "Atrox/Analysis/LoopNestLegality.hpp"
+
+#include "llvm/Analysis/ScalarEvolution.h"
+// using llvm::ScalarEvolution
+// using llvm::SCEV
+
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
+// using llvm::SCEVAddRecExpr
+// using llvm::SCEVConstant
+
+#include "llvm/Analysis/LoopInfo.h"
+// using llvm::LoopInfo
+// using llvm::Loop
+
+#include "llvm/IR/Dominators.h"
+// using llvm::DominatorTree
+
+#include "llvm/IR/DataLayout.h"
+// using llvm::DataLayout
+
+#include "llvm/IR/Instructions.h"
+// using llvm::LoadInst
+// using llvm::StoreInst
+// using llvm::PHINode
+
+#include "llvm/IR/Constants.h"
+// using llvm::ConstantInt
+
+#include "llvm/IR/IRBuilder.h"
+// using llvm::IRBuilder
+
+#include "llvm/IR/Function.h"
+// using llvm::Function
+
+#include "llvm/ADT/Optional.h"
+// using llvm::Optional
+
+#include "llvm/ADT/STLExtras.h"
+// using llvm::is_contained
+
+#include "llvm/Support/MathExtras.h"
+// using llvm::PowerOf2Floor
+
+#include "llvm/Support/Debug.h"
+// using LLVM_DEBUG macro
+// using llvm::dbgs
+
+#include <cstdlib>
+// using std::llabs
+
+#define DEBUG_TYPE "atrox-tile"
+
+namespace {
+
+llvm::Optional<int64_t> GetConstantStep(const llvm::SCEVAddRecExpr *AR,
+                                        llvm::ScalarEvolution &SE) {
+  auto *step = llvm::dyn_cast<llvm::SCEVConstant>(AR->getStepRecurrence(SE));
+
+  if (!AR->isAffine() || !step) {
+    return llvm::None;
+  }
+
+  return step->getAPInt().getSExtValue();
+}
+
+} // namespace
+
+namespace atrox {
+
+void PayloadTiler::getTiled(
+    llvm::SmallVectorImpl<llvm::Loop *> &Loops) const {
+  for (const auto &e : Candidates) {
+    Loops.push_back(e.Outer);
+  }
+}
+
+void PayloadTiler::analyze(llvm::Loop &L, llvm::ArrayRef<MemAccInst> Accesses,
+                           llvm::ArrayRef<llvm::Loop *> Excluded) {
+  Candidates.clear();
+  Inserted.clear();
+
+  for (auto *outer : L.getLoopsInPreorder()) {
+    if (outer == &L || outer->getSubLoops().size() != 1 ||
+        llvm::is_contained(Excluded, outer)) {
+      continue;
+    }
+
+    auto *inner = outer->getSubLoops().front();
+
+    if (!inner->getSubLoops().empty() || !IsPerfectLoopNest(*outer, *inner)) {
+      continue;
+    }
+
+    unsigned numStrided = 0;
+    uint64_t unitBytes = 0;
+    bool isAffine = true;
+    bool hasReuse = false;
+
+    for (auto e : Accesses) {
+      auto *i = e.get();
+
+      if (!inner->contains(i)) {
+        continue;
+      }
+
+      if (!llvm::isa<llvm::LoadInst>(i) && !llvm::isa<llvm::StoreInst>(i)) {
+        isAffine = false;
+        break;
+      }
+
+      auto *ptr = SE->getSCEV(e.getPointerOperand());
+
+      if (SE->isLoopInvariant(ptr, inner)) {
+        continue;
+      }
+
+      auto *ar = llvm::dyn_cast<llvm::SCEVAddRecExpr>(ptr);
+      auto step = ar && ar->getLoop() == inner ? GetConstantStep(ar, *SE)
+                                               : llvm::None;
+
+      if (!step) {
+        isAffine = false;
+        break;
+      }
+
+      if (std::llabs(*step) < static_cast<int64_t>(CacheLineSize)) {
+        unitBytes += DL->getTypeStoreSize(e.getValueOperand()->getType());
+        continue;
+      }
+
+      ++numStrided;
+
+      // the lines brought in by the inner loop are used again by the next
+      // iteration of the outer loop
+      auto *start = llvm::dyn_cast<llvm::SCEVAddRecExpr>(ar->getStart());
+      auto outerStep = start && start->getLoop() == outer
+                           ? GetConstantStep(start, *SE)
+                           : llvm::None;
+
+      if (outerStep && std::llabs(*outerStep) <
+                           static_cast<int64_t>(CacheLineSize)) {
+        hasReuse = true;
+      }
+    }
+
+    if (!isAffine || !hasReuse) {
+      continue;
+    }
+
+    uint64_t footprint = numStrided * CacheLineSize + unitBytes;
+    uint64_t tileSize = llvm::PowerOf2Floor(CacheSize / 2 / footprint);
+
+    if (tileSize < 2) {
+      continue;
+    }
+
+    if (LBA) {
+      auto info = LBA->getInfo(inner);
+
+      if (info && info->TripCount && info->TripCount <= tileSize) {
+        LLVM_DEBUG(llvm::dbgs() << "inner loop fits in a tile: "
+                                << inner->getHeader()->getName() << '\n';);
+        continue;
+      }
+    }
+
+    if (!IsInterchangeLegal(DI, *outer, *inner, Accesses)) {
+      continue;
+    }
+
+    LLVM_DEBUG(llvm::dbgs() << "tiling candidate with size " << tileSize
+                            << " and footprint " << footprint << ": "
+                            << inner->getHeader()->getName() << '\n';);
+
+    Candidates.push_back(
+        {outer, inner, static_cast<unsigned>(tileSize), footprint});
+  }
+}
+
+bool PayloadTiler::insertTile(const Candidate &C, GetCloneFuncTy GetClone) {
+  auto *innerHeader =
+      llvm::dyn_cast_or_null<llvm::BasicBlock>(GetClone(C.Inner->getHeader()));
+  auto *outerHeader =
+      llvm::dyn_cast_or_null<llvm::BasicBlock>(GetClone(C.Outer->getHeader()));
+
+  if (!innerHeader || !outerHeader) {
+    return false;
+  }
+
+  auto &F = *innerHeader->getParent();
+  llvm::DominatorTree DT{F};
+  llvm::LoopInfo LI{DT};
+
+  auto *inner = LI.getLoopFor(innerHeader);
+  auto *outer = LI.getLoopFor(outerHeader);
+
+  if (!inner || !outer || inner->getHeader() != innerHeader ||
+      outer->getHeader() != outerHeader || inner->getParentLoop() != outer) {
+    return false;
+  }
+
+  auto shape = MatchCountedLoop(*inner, *outer);
+  auto *preheader = outer->getLoopPreheader();
+  auto *exiting = outer->getExitingBlock();
+  auto *exit = outer->getUniqueExitBlock();
+
+  if (!shape || !preheader || !exiting || !exit || !exit->phis().empty()) {
+    LLVM_DEBUG(llvm::dbgs() << "unsupported nest shape: "
+                            << outerHeader->getName() << '\n';);
+    return false;
+  }
+
+  for (auto *bb : outer->blocks()) {
+    for (auto &e : *bb) {
+      for (auto *u : e.users()) {
+        auto *user = llvm::dyn_cast<llvm::Instruction>(u);
+
+        if (user && !outer->contains(user)) {
+          return false;
+        }
+      }
+    }
+  }
+
+  auto &ctx = F.getContext();
+  auto *indVarTy = shape->IndVar->getType();
+  auto *start = shape->getStart();
+  auto *end = shape->getEnd();
+
+  // the tile loop steps over the inner iteration space and the outer loop is
+  // restarted for each tile; every tile of a non-empty range is non-empty and
+  // an empty range is a single tile with the original bounds, so a rotated
+  // inner loop still enters its body exactly as before
+  auto *tileHeader =
+      llvm::BasicBlock::Create(ctx, "tile.header", &F, outerHeader);
+  auto *tileLatch = llvm::BasicBlock::Create(ctx, "tile.latch", &F, exit);
+
+  preheader->getTerminator()->replaceUsesOfWith(outerHeader, tileHeader);
+  for (auto &e : outerHeader->phis()) {
+    e.setIncomingBlock(e.getBasicBlockIndex(preheader), tileHeader);
+  }
+  exiting->getTerminator()->replaceUsesOfWith(exit, tileLatch);
+
+  // the remaining iterations are counted instead of comparing against the
+  // start of the next tile, which might wrap around near the end of the range
+  // of the induction variable, and their count fits in its type as unsigned
+  llvm::IRBuilder<> builder{tileHeader};
+  auto *tileIndVar = builder.CreatePHI(indVarTy, 2, "tile.iv");
+  auto *tileSize = llvm::ConstantInt::get(indVarTy, C.TileSize);
+  auto *isDone = shape->IsSigned ? builder.CreateICmpSGE(tileIndVar, end)
+                                 : builder.CreateICmpUGE(tileIndVar, end);
+  auto *remaining = builder.CreateSub(end, tileIndVar, "tile.rem");
+  auto *isLast = builder.CreateOr(
+      isDone, builder.CreateICmpULE(remaining, tileSize), "tile.last");
+  auto *tileNext = builder.CreateAdd(tileIndVar, tileSize, "tile.next");
+  auto *tileEnd = builder.CreateSelect(isLast, end, tileNext, "tile.end");
+  builder.CreateBr(outerHeader);
+
+  builder.SetInsertPoint(tileLatch);
+  builder.CreateCondBr(isLast, exit, tileHeader);
+
+  tileIndVar->addIncoming(start, preheader);
+  tileIndVar->addIncoming(tileNext, tileLatch);
+
+  shape->IndVar->setIncomingValue(
+      shape->IndVar->getBasicBlockIndex(shape->Preheader), tileIndVar);
+  shape->Cmp->setOperand(shape->EndIndex, tileEnd);
+
+  LLVM_DEBUG(llvm::dbgs() << "tiled nest: " << outerHeader->getName()
+                          << " with size " << C.TileSize << '\n';);
+
+  return true;
+}
+
+unsigned PayloadTiler::insert(GetCloneFuncTy GetClone) {
+  Inserted.clear();
+
+  for (const auto &e : Candidates) {
+    if (insertTile(e, GetClone)) {
+      Inserted.push_back(e);
+    }
+  }
+
+  return Inserted.size();
+}
+
+void PayloadTiler::getSpecs(std::vector<TilingSpec> &Specs) const {
+  for (const auto &e : Inserted) {
+    Specs.push_back({e.Inner->getHeader()->getName().str(),
+                     e.Outer->getHeader()->getName().str(), e.TileSize,
+                     e.Footprint, CacheSize});
+  }
+}
+
+} // namespace atrox
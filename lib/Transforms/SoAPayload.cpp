@@ -0,0 +1,206 @@
+//
+//
+//
+
+#include "Atrox/Transforms/SoAPayload.hpp"
+
+#include "Atrox/Analysis/FieldDensityAnalyzer.hpp"
+
+#include "llvm/Config/llvm-config.h"
+// using LLVM_VERSION_MAJOR
+
+#include "llvm/IR/Function.h"
+// using llvm::Function
+
+#include "llvm/IR/Module.h"
+// using llvm::Module
+
+#include "llvm/IR/DataLayout.h"
+// using llvm::DataLayout
+
+#include "llvm/IR/DerivedTypes.h"
+// using llvm::StructType
+// using llvm::PointerType
+// using llvm::FunctionType
+
+#include "llvm/IR/Instructions.h"
+// using llvm::GetElementPtrInst
+// using llvm::ReturnInst
+
+#include "llvm/IR/Constants.h"
+// using llvm::ConstantInt
+// using llvm::UndefValue
+
+#include "llvm/Transforms/Utils/Cloning.h"
+// using llvm::CloneFunctionInto
+
+#include "llvm/Transforms/Utils/ValueMapper.h"
+// using llvm::ValueToValueMapTy
+
+#include "llvm/ADT/SmallVector.h"
+// using llvm::SmallVector
+
+#include "llvm/Support/Debug.h"
+// using LLVM_DEBUG macro
+// using llvm::dbgs
+
+#include <map>
+// using std::map
+
+#include <set>
+// using std::set
+
+#include <iterator>
+// using std::next
+
+#include <string>
+// using std::to_string
+
+#define DEBUG_TYPE "atrox-soa"
+
+namespace {
+
+unsigned GetField(llvm::GetElementPtrInst &GEP) {
+  return llvm::cast<llvm::ConstantInt>(*std::next(GEP.idx_begin()))
+      ->getZExtValue();
+}
+
+} // namespace
+
+namespace atrox {
+
+llvm::Function *CreateSoAPayload(llvm::Function &Payload,
+                                 SoALayoutSpec *Spec) {
+  if (Payload.isDeclaration() || Payload.isVarArg()) {
+    return nullptr;
+  }
+
+  auto &M = *Payload.getParent();
+  const auto &DL = M.getDataLayout();
+
+  // the used fields of the converted arguments, by argument number
+  std::map<unsigned, std::set<unsigned>> fields;
+  std::map<unsigned, StructArgAccesses> accesses;
+
+  for (auto &arg : Payload.args()) {
+    StructArgAccesses acc;
+
+    if (!GetStructArgAccesses(arg, acc) || !acc.IsConvertible ||
+        acc.Ty->isOpaque()) {
+      continue;
+    }
+
+    std::set<unsigned> used;
+    uint64_t usedBytes = 0;
+
+    for (auto *e : acc.GEPs) {
+      if (used.insert(GetField(*e)).second) {
+        usedBytes += DL.getTypeAllocSize(acc.Ty->getElementType(GetField(*e)));
+      }
+    }
+
+    if (used.empty() || usedBytes == DL.getTypeAllocSize(acc.Ty)) {
+      continue;
+    }
+
+    fields[arg.getArgNo()] = std::move(used);
+    accesses[arg.getArgNo()] = std::move(acc);
+  }
+
+  if (fields.empty()) {
+    return nullptr;
+  }
+
+  llvm::SmallVector<llvm::Type *, 16> paramTys;
+  llvm::SmallVector<SoAParamSpec, 16> params;
+
+  for (auto &arg : Payload.args()) {
+    auto found = fields.find(arg.getArgNo());
+
+    if (found == fields.end()) {
+      paramTys.push_back(arg.getType());
+      params.push_back({arg.getName().str(), arg.getName().str(), -1});
+      continue;
+    }
+
+    auto *ty = accesses[arg.getArgNo()].Ty;
+    auto addrSpace = arg.getType()->getPointerAddressSpace();
+
+    for (auto f : found->second) {
+      paramTys.push_back(
+          llvm::PointerType::get(ty->getElementType(f), addrSpace));
+      params.push_back({(arg.getName() + ".f" + std::to_string(f)).str(),
+                        arg.getName().str(), static_cast<int>(f)});
+    }
+  }
+
+  auto *soaTy =
+      llvm::FunctionType::get(Payload.getReturnType(), paramTys, false);
+  auto *soa = llvm::Function::Create(soaTy, Payload.getLinkage(),
+                                     Payload.getName() + ".soa", &M);
+
+  // the field pointers of each converted argument, by field
+  std::map<unsigned, std::map<unsigned, llvm::Argument *>> fieldArgs;
+  llvm::ValueToValueMapTy vmap;
+  auto argIt = soa->arg_begin();
+  auto paramIt = params.begin();
+
+  for (auto &arg : Payload.args()) {
+    auto found = fields.find(arg.getArgNo());
+
+    if (found == fields.end()) {
+      argIt->setName((paramIt++)->Name);
+      vmap[&arg] = &*argIt++;
+      continue;
+    }
+
+    // all uses are rewritten below
+    vmap[&arg] = llvm::UndefValue::get(arg.getType());
+
+    for (auto f : found->second) {
+      argIt->setName((paramIt++)->Name);
+      fieldArgs[arg.getArgNo()][f] = &*argIt++;
+    }
+  }
+
+  llvm::SmallVector<llvm::ReturnInst *, 4> returns;
+#if LLVM_VERSION_MAJOR >= 13
+  llvm::CloneFunctionInto(soa, &Payload, vmap,
+                          llvm::CloneFunctionChangeType::LocalChangesOnly,
+                          returns);
+#else
+  llvm::CloneFunctionInto(soa, &Payload, vmap, false, returns);
+#endif
+
+  // a field of an element becomes an element of the field array
+  for (auto &e : accesses) {
+    for (auto *gep : e.second.GEPs) {
+      auto *clone = llvm::cast<llvm::GetElementPtrInst>(vmap[gep]);
+      auto field = GetField(*gep);
+      auto *fieldArg = fieldArgs[e.first][field];
+
+      llvm::SmallVector<llvm::Value *, 4> indices{clone->getOperand(1)};
+      indices.append(clone->idx_begin() + 2, clone->idx_end());
+
+      auto *newGEP = llvm::GetElementPtrInst::Create(
+          e.second.Ty->getElementType(field), fieldArg, indices, "", clone);
+      newGEP->setIsInBounds(clone->isInBounds());
+      newGEP->takeName(clone);
+
+      clone->replaceAllUsesWith(newGEP);
+      clone->eraseFromParent();
+    }
+  }
+
+  if (Spec) {
+    Spec->Function = soa->getName().str();
+    Spec->Params.assign(params.begin(), params.end());
+  }
+
+  LLVM_DEBUG(llvm::dbgs() << "created struct of arrays variant: "
+                          << soa->getName() << '\n';);
+
+  return soa;
+}
+
+} // namespace atrox
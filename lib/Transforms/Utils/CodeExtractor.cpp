@@ -26,11 +26,15 @@
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Triple.h"
+#include "llvm/Analysis/AssumptionCache.h"
 #include "llvm/Analysis/BlockFrequencyInfo.h"
 #include "llvm/Analysis/BlockFrequencyInfoImpl.h"
 #include "llvm/Analysis/BranchProbabilityInfo.h"
 #include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ScalarEvolution.h"
 #include "llvm/Analysis/ScalarEvolutionExpressions.h"
+#include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/IR/Argument.h"
 #include "llvm/IR/Attributes.h"
 #include "llvm/IR/BasicBlock.h"
@@ -86,6 +90,30 @@ static cl::opt<bool> AggregateArgsOpt(
     "atrox-aggregate-extracted-args", cl::Hidden,
     cl::desc("Aggregate arguments to code-extracted functions"));
 
+static cl::opt<AggregateLayoutKind> AggregateLayoutOpt(
+    "atrox-aggregate-layout", cl::Hidden,
+    cl::init(AggregateLayoutKind::Discovery),
+    cl::desc("Layout of aggregated arguments to code-extracted functions"),
+    cl::values(clEnumValN(AggregateLayoutKind::Discovery, "discovery",
+                          "discovery order"),
+               clEnumValN(AggregateLayoutKind::CacheAware, "cache-aware",
+                          "separate read-only and writable fields, sort by "
+                          "size and pad writable fields to a cache line")));
+
+static cl::opt<bool> AggregatePrivateOutputsOpt(
+    "atrox-aggregate-private-outputs", cl::Hidden, cl::init(false),
+    cl::desc("Place writable aggregated arguments in a separate per-thread "
+             "block (requires cache-aware layout)"));
+
+static cl::opt<unsigned> AggregateCacheLineSizeOpt(
+    "atrox-aggregate-cache-line-size", cl::Hidden, cl::init(64),
+    cl::desc("Cache line size used by the cache-aware aggregate layout"));
+
+static cl::opt<unsigned> ReturnScalarOutputsOpt(
+    "atrox-return-scalar-outputs", cl::Hidden, cl::init(0),
+    cl::desc("Return up to this many scalar outputs of code-extracted "
+             "functions by value instead of through pointer arguments"));
+
 static cl::opt<bool>
     FlattenArrayAccesses("atrox-flatten-array-accesses", cl::Hidden,
                          cl::init(false),
@@ -438,7 +466,7 @@ void CodeExtractor::findStackAllocatable() {
                                                        Blocks.end()};
 
   auto evalLBA = *LBA;
-  evalLBA.evaluate(0, 5, &CurL);
+  evalLBA.evaluate(0, 0, &CurL);
 
   for (auto *v : Inputs) {
     auto isCondUse =
@@ -486,35 +514,30 @@ void CodeExtractor::findStackAllocatable() {
       auto lbInfo = *lbInfoOrErr;
 
       auto *start = llvm::dyn_cast_or_null<llvm::SCEVConstant>(lbInfo.Start);
-      llvm::ConstantInt *initVal = nullptr;
-      if (start) {
-        // FIXME maybe check that the induction var is an integer type before
-        // casting
-        initVal = llvm::dyn_cast<llvm::ConstantInt>(
-            llvm::ConstantInt::get(lbInfo.InductionVariable->getType(),
-                                   start->getValue()->getZExtValue()));
-      } else {
-        // TODO what happens here if the value is used in the loop in a
-        // division or a subtraction that results in a negative number?
-        uint64_t val = 354;
-        initVal = llvm::dyn_cast<llvm::ConstantInt>(
-            llvm::ConstantInt::get(lbInfo.InductionVariable->getType(), val));
-
+      if (!start) {
+        // keep it as an ordinary input instead of guessing an initial value
         LLVM_DEBUG(llvm::dbgs()
                        << "outer induction variable: "
                        << *lbInfo.InductionVariable
-                       << " does not have a constant start value: "
-                       << *lbInfo.Start << " set to: " << val << '\n';);
+                       << " does not have a constant start value\n";);
+        continue;
       }
 
+      // FIXME maybe check that the induction var is an integer type before
+      // casting
+      auto *initVal = llvm::dyn_cast<llvm::ConstantInt>(
+          llvm::ConstantInt::get(lbInfo.InductionVariable->getType(),
+                                 start->getValue()->getZExtValue()));
+
       StackAllocaInits.push_back(initVal);
       StackAllocas.insert(v);
     }
 
+    // values that are only used in loop conditions are loop bounds, so they
+    // are kept as ordinary inputs, while the resulting iteration space is
+    // reported by the loop bounds analyzer
     if (isCondUse) {
-      auto *initVal = llvm::ConstantInt::get(v->getType(), 5);
-      StackAllocaInits.push_back(initVal);
-      StackAllocas.insert(v);
+      LLVM_DEBUG(llvm::dbgs() << "loop bound input: " << *v << '\n';);
     }
   }
 }
@@ -845,19 +868,53 @@ Function *CodeExtractor::cloneFunction(const ValueSet &inputs,
   }
 
   // Add the types of the output values to the function's argument list.
+  // Scalar outputs up to the requested number are returned in a struct
+  // instead, while the bidirectional ones among them are passed by value.
+  SmallVector<Type *, 8> retElemTy;
+  SmallVector<int, 8> outputArgIdx;
+  OutputPassing.clear();
+  OutputReturnIndex.clear();
+
   for (Value *output : outputs) {
     LLVM_DEBUG(dbgs() << "value used in func: " << *output << "\n");
+    ArgPassing passing = ArgPassing::Pointer;
+    int retIdx = -1;
+
     if (AggregateArgs)
+      passing = ArgPassing::Aggregate;
+    else if (output->getType()->isPointerTy())
+      passing = ArgPassing::Value;
+    else if (retElemTy.size() < ReturnScalarOutputsOpt &&
+             output->getType()->isSingleValueType()) {
+      retIdx = retElemTy.size();
+      retElemTy.push_back(output->getType());
+      bool isPrivate = PrivateReductions.count(OutputToInputMap.lookup(output));
+      passing = isBidirectional(output) && !isPrivate
+                    ? ArgPassing::ValueAndReturn
+                    : ArgPassing::Return;
+    }
+
+    OutputPassing.push_back(passing);
+    OutputReturnIndex.push_back(retIdx);
+
+    switch (passing) {
+    case ArgPassing::Return:
+      outputArgIdx.push_back(-1);
+      break;
+    case ArgPassing::Pointer:
+      outputArgIdx.push_back(paramTy.size());
+      paramTy.push_back(PointerType::getUnqual(output->getType()));
+      break;
+    default:
+      outputArgIdx.push_back(paramTy.size());
       paramTy.push_back(output->getType());
-    else {
-      if (output->getType()->isPointerTy()) {
-        paramTy.push_back(output->getType());
-      } else {
-        paramTy.push_back(PointerType::getUnqual(output->getType()));
-      }
+      break;
     }
   }
 
+  if (!retElemTy.empty())
+    RetTy = StructType::get(header->getContext(), retElemTy);
+
   LLVM_DEBUG({
     dbgs() << "Function type: " << *RetTy << " f(";
     for (Type *i : paramTy)
@@ -865,11 +922,25 @@ Function *CodeExtractor::cloneFunction(const ValueSet &inputs,
     dbgs() << ")\n";
   });
 
-  StructType *StructTy;
+  SmallVector<StructType *, 2> AggregateBlocks;
   if (AggregateArgs && (usedInputs.size() + outputs.size() > 0)) {
-    StructTy = StructType::get(M->getContext(), paramTy);
+    SmallVector<AggregateField, 16> Fields;
+
+    for (Value *value : usedInputs)
+      Fields.push_back({value->getType(), value->getName(), false});
+
+    for (Value *output : outputs)
+      Fields.push_back(
+          {output->getType(), (output->getName() + ".out").str(), true});
+
+    ComputeAggregateLayout(Fields, AggregateLayoutOpt,
+                           AggregatePrivateOutputsOpt,
+                           AggregateCacheLineSizeOpt, M->getDataLayout(),
+                           M->getContext(), AggregateBlocks, ArgLayout);
+
     paramTy.clear();
-    paramTy.push_back(PointerType::getUnqual(StructTy));
+    for (StructType *BlockTy : AggregateBlocks)
+      paramTy.push_back(PointerType::getUnqual(BlockTy));
   }
   FunctionType *funcType = FunctionType::get(
       RetTy, paramTy, AllowVarArgs && oldFunction->isVarArg());
@@ -974,20 +1045,36 @@ Function *CodeExtractor::cloneFunction(const ValueSet &inputs,
   // Create an iterator to name all of the arguments we inserted.
   Function::arg_iterator AI = newFunction->arg_begin();
 
+  auto getOutputArg = [&](size_t OutputIdx) -> Argument * {
+    return &*(newFunction->arg_begin() + outputArgIdx[OutputIdx]);
+  };
+
+  // Address a field of the aggregated arguments; fields are numbered with the
+  // inputs first, followed by the outputs.
+  auto getAggregateFieldPtr = [&](size_t FieldIdx,
+                                  Instruction *InsertBefore) -> Value * {
+    const AggregateFieldSpec &Field = ArgLayout.Fields[FieldIdx];
+    Value *Idx[2];
+    Idx[0] = Constant::getNullValue(Type::getInt32Ty(header->getContext()));
+    Idx[1] =
+        ConstantInt::get(Type::getInt32Ty(header->getContext()), Field.Index);
+    return GetElementPtrInst::Create(AggregateBlocks[Field.Block],
+                                     newFunction->arg_begin() + Field.Block,
+                                     Idx, "gep_" + Field.Name, InsertBefore);
+  };
+
   // Rewrite all users of the inputs in the extracted region to use the
   // arguments (or appropriate addressing into struct) instead.
+  InputReplacements.clear();
   for (unsigned i = 0, e = usedInputs.size(); i != e; ++i) {
     Value *RewriteVal;
     if (AggregateArgs) {
-      Value *Idx[2];
-      Idx[0] = Constant::getNullValue(Type::getInt32Ty(header->getContext()));
-      Idx[1] = ConstantInt::get(Type::getInt32Ty(header->getContext()), i);
       TerminatorInst *TI = newFunction->begin()->getTerminator();
-      GetElementPtrInst *GEP = GetElementPtrInst::Create(
-          StructTy, &*AI, Idx, "gep_" + usedInputs[i]->getName(), TI);
-      RewriteVal = new LoadInst(GEP, "loadgep_" + usedInputs[i]->getName(), TI);
+      RewriteVal = new LoadInst(getAggregateFieldPtr(i, TI),
+                                "loadgep_" + usedInputs[i]->getName(), TI);
     } else
       RewriteVal = &*AI++;
+    InputReplacements[usedInputs[i]] = RewriteVal;
 
     std::vector<User *> Users(usedInputs[i]->user_begin(),
                               usedInputs[i]->user_end());
@@ -1000,25 +1087,27 @@ Function *CodeExtractor::cloneFunction(const ValueSet &inputs,
       }
   }
 
-  AI = newFunction->arg_begin() + usedInputs.size();
-
   for (auto *v : inputs) {
     if (!isBidirectional(v)) {
       continue;
     }
 
-    auto *outv = outputs[InputToOutputMap[v]];
-    auto argIt = AI + InputToOutputMap[v];
+    auto outIdx = InputToOutputMap[v];
     auto *ti = newFunction->begin()->getTerminator();
 
-    // auto *ld = new LoadInst(&*argIt, "", ti);
     llvm::Value *ld = nullptr;
 
-    if (!outv->getType()->isPointerTy()) {
-      ld = new LoadInst(&*argIt, "", ti);
+    if (auto *identity = PrivateReductions.lookup(v)) {
+      ld = identity;
+    } else if (AggregateArgs) {
+      ld = new LoadInst(getAggregateFieldPtr(usedInputs.size() + outIdx, ti),
+                        "", ti);
+    } else if (OutputPassing[outIdx] == ArgPassing::Pointer) {
+      ld = new LoadInst(getOutputArg(outIdx), "", ti);
     } else {
-      ld = &*argIt;
+      ld = getOutputArg(outIdx);
     }
+    InputReplacements[v] = ld;
 
     std::vector<User *> Users(v->user_begin(), v->user_end());
     for (User *use : Users)
@@ -1035,8 +1124,9 @@ Function *CodeExtractor::cloneFunction(const ValueSet &inputs,
     AI = newFunction->arg_begin();
     for (unsigned i = 0, e = usedInputs.size(); i != e; ++i, ++AI)
       AI->setName(usedInputs[i]->getName());
-    for (unsigned i = 0, e = outputs.size(); i != e; ++i, ++AI)
-      AI->setName(outputs[i]->getName() + ".out");
+    for (unsigned i = 0, e = outputs.size(); i != e; ++i)
+      if (outputArgIdx[i] >= 0)
+        getOutputArg(i)->setName(outputs[i]->getName() + ".out");
   }
 
   auto &DL = newFunction->getParent()->getDataLayout();
@@ -1073,6 +1163,19 @@ Function *CodeExtractor::cloneFunction(const ValueSet &inputs,
   newFunction->getBasicBlockList().push_back(newExitNode);
   auto *ret = ReturnInst::Create(newFunction->getContext(), newExitNode);
 
+  if (!RetTy->isVoidTy()) {
+    Value *retVal = UndefValue::get(RetTy);
+
+    for (unsigned i = 0, e = outputs.size(); i != e; ++i)
+      if (OutputReturnIndex[i] >= 0)
+        retVal = InsertValueInst::Create(retVal, outputs[i],
+                                         OutputReturnIndex[i],
+                                         outputs[i]->getName() + ".ret", ret);
+
+    ret->eraseFromParent();
+    ret = ReturnInst::Create(newFunction->getContext(), retVal, newExitNode);
+  }
+
   for (auto *e : CloneBlocks) {
     auto *term = e->getTerminator();
 
@@ -1083,19 +1186,22 @@ Function *CodeExtractor::cloneFunction(const ValueSet &inputs,
     }
   }
 
-  AI = newFunction->arg_begin() + usedInputs.size();
-
   for (auto *v : inputs) {
     if (!isBidirectional(v)) {
       continue;
     }
 
-    auto *outv = outputs[InputToOutputMap[v]];
-    auto argIt = AI + InputToOutputMap[v];
+    auto outIdx = InputToOutputMap[v];
+    auto *outv = outputs[outIdx];
     auto *ti = newExitNode->getTerminator();
 
-    if (!outv->getType()->isPointerTy()) {
-      auto *st = new StoreInst(outv, &*argIt, false, ti);
+    if (AggregateArgs) {
+      if (!outv->getType()->isPointerTy())
+        new StoreInst(
+            outv, getAggregateFieldPtr(usedInputs.size() + outIdx, ti), false,
+            ti);
+    } else if (OutputPassing[outIdx] == ArgPassing::Pointer) {
+      new StoreInst(outv, getOutputArg(outIdx), false, ti);
     }
   }
 
@@ -1195,22 +1301,6 @@ Function *CodeExtractor::cloneCodeRegion() {
 
   auto *newFuncExit = BasicBlock::Create(header->getContext(), "exit");
 
-  if (FlattenArrayAccesses) {
-    for (auto &e : Accesses->Accesses) {
-      auto *ptr = e.getPointerOperand();
-
-      llvm::SmallPtrSet<llvm::GetElementPtrInst *, 8> geps;
-      if (ptr && llvm::isa<llvm::GetElementPtrInst>(ptr)) {
-        auto &cgep = *VMap[ptr];
-        geps.insert(llvm::dyn_cast<llvm::GetElementPtrInst>(&cgep));
-      }
-
-      for (auto *gep : geps) {
-        FlattenMultiDimArrayIndices(gep);
-      }
-    }
-  }
-
   // Construct new function based on inputs/outputs & add allocas for all defs.
   Function *newFunction =
       cloneFunction(Inputs, Outputs, cloneHeader, newFuncRoot, newFuncExit,
@@ -1278,6 +1368,59 @@ Function *CodeExtractor::cloneCodeRegion() {
   ie.visit(newFunction);
   ie.process();
 
+  // the payload is called once per execution of the region header
+  if (BFI) {
+    if (auto count = BFI->getBlockProfileCount(header)) {
+      newFunction->setEntryCount(*count);
+    }
+  }
+
+  // the accesses are flattened once the payload is complete, so that their
+  // row computations can be placed with respect to its own loops
+  if (FlattenArrayAccesses) {
+    llvm::SetVector<llvm::GetElementPtrInst *> geps;
+    llvm::SmallVector<llvm::Instruction *, 32> accesses;
+
+    auto getClone = [this, newFunction](llvm::Value *V) -> llvm::Value * {
+      auto found = V ? VMap.find(V) : VMap.end();
+
+      if (found == VMap.end()) {
+        return nullptr;
+      }
+
+      llvm::Value *clone = found->second;
+      auto *inst = llvm::dyn_cast_or_null<llvm::Instruction>(clone);
+
+      return inst && inst->getFunction() == newFunction ? inst : nullptr;
+    };
+
+    for (auto &e : Accesses->Accesses) {
+      auto *clone = getClone(e.getPointerOperand());
+
+      if (auto *gep = llvm::dyn_cast_or_null<llvm::GetElementPtrInst>(clone)) {
+        geps.insert(gep);
+      }
+
+      if (auto *access = llvm::dyn_cast_or_null<llvm::Instruction>(
+              getClone(e.get()))) {
+        accesses.push_back(access);
+      }
+    }
+
+    llvm::DominatorTree dt{*newFunction};
+    llvm::LoopInfo li{dt};
+    FlattenMultiDimArrayIndices(geps.getArrayRef(), dt, li);
+
+    // accesses to dynamically sized arrays are recognized by delinearization
+    llvm::TargetLibraryInfoImpl tlii{
+        llvm::Triple{newFunction->getParent()->getTargetTriple()}};
+    llvm::TargetLibraryInfo tli{tlii};
+    llvm::AssumptionCache ac{*newFunction};
+    llvm::ScalarEvolution se{*newFunction, tli, ac, dt, li};
+
+    FlattenDelinearizedAccesses(accesses, se, dt, li);
+  }
+
   LLVM_DEBUG(if (VerifyOption && verifyFunction(*newFunction, &llvm::dbgs())) {
     newFunction->dump();
     report_fatal_error("verifyFunction failed!");
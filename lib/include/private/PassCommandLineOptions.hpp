@@ -6,6 +6,10 @@
 
 #include "Atrox/Config.hpp"
 
+#include "Atrox/Analysis/ExtractionCost.hpp"
+
+#include "Atrox/Analysis/PayloadWeights.hpp"
+
 #include "llvm/Support/CommandLine.h"
 // using llvm::cl::OptionCategory
 
@@ -25,3 +29,60 @@ extern llvm::cl::opt<std::string> AtroxReportsDir;
 
 extern llvm::cl::opt<std::string> AtroxFunctionWhiteListFile;
 
+extern llvm::cl::opt<bool> AtroxAnnotateParallelLoops;
+
+extern llvm::cl::opt<bool> AtroxPrivatizeReductions;
+
+extern llvm::cl::opt<double> AtroxPeakGOPS;
+
+extern llvm::cl::opt<double> AtroxPeakBandwidth;
+
+extern llvm::cl::opt<bool> AtroxPrefetch;
+
+extern llvm::cl::opt<bool> AtroxPrefetchIndirect;
+
+extern llvm::cl::opt<unsigned> AtroxPrefetchDistance;
+
+extern llvm::cl::opt<unsigned> AtroxPrefetchLatency;
+
+extern llvm::cl::opt<unsigned> AtroxCacheLineSize;
+
+extern llvm::cl::opt<bool> AtroxDSWP;
+
+extern llvm::cl::opt<unsigned> AtroxDSWPWorkers;
+
+extern llvm::cl::opt<unsigned> AtroxDSWPCapacity;
+
+extern llvm::cl::opt<bool> AtroxFission;
+
+extern llvm::cl::opt<unsigned> AtroxFissionCapacity;
+
+extern llvm::cl::opt<bool> AtroxInterleave;
+
+extern llvm::cl::opt<unsigned> AtroxInterleaveGroup;
+
+extern llvm::cl::opt<bool> AtroxSpecialize;
+
+extern llvm::cl::opt<unsigned> AtroxSpecializeMaxTripCount;
+
+extern llvm::cl::opt<atrox::ExtractionMode> AtroxExtractionMode;
+
+extern llvm::cl::opt<unsigned> AtroxReplaceMaxOverhead;
+
+extern llvm::cl::opt<unsigned> AtroxReplaceMinTripCount;
+
+extern llvm::cl::opt<atrox::PayloadCostModel> AtroxPayloadCostModel;
+
+extern llvm::cl::opt<std::string> AtroxPayloadWeightsFile;
+
+extern llvm::cl::opt<bool> AtroxProfileWeights;
+
+extern llvm::cl::opt<bool> AtroxInterchange;
+
+extern llvm::cl::opt<bool> AtroxSoA;
+
+extern llvm::cl::opt<bool> AtroxTile;
+
+extern llvm::cl::opt<unsigned> AtroxTileCacheSize;
+
+extern llvm::cl::opt<unsigned> AtroxTileCacheLevel;
@@ -0,0 +1,45 @@
+/*
+ *
+ *
+ */
+
+#ifndef ATROX_RUNTIME_BUFFER_H
+#define ATROX_RUNTIME_BUFFER_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Growable record buffer
+ *
+ * The iterator of a fissioned loop appends the iteration-dependent inputs of
+ * each payload invocation as a fixed-size record, so that the payload can
+ * later run over all of them in a counted loop. Records are contiguous and
+ * suitably aligned for any fundamental type.
+ */
+
+typedef struct atrox_buffer atrox_buffer_t;
+
+/* Create an empty buffer with room for the given number of records. */
+atrox_buffer_t *atrox_buffer_create(size_t record_size, size_t capacity);
+
+/* Return the storage of a new record at the end of the buffer, growing it
+ * when full. Previously returned pointers are invalidated by growing. */
+void *atrox_buffer_append(atrox_buffer_t *buffer);
+
+/* Return the number of appended records. */
+size_t atrox_buffer_size(const atrox_buffer_t *buffer);
+
+/* Return the storage of the first record. */
+void *atrox_buffer_data(atrox_buffer_t *buffer);
+
+/* Release the buffer. */
+void atrox_buffer_destroy(atrox_buffer_t *buffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ATROX_RUNTIME_BUFFER_H */
@@ -0,0 +1,46 @@
+/*
+ *
+ *
+ */
+
+#ifndef ATROX_RUNTIME_DSWP_H
+#define ATROX_RUNTIME_DSWP_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Decoupled software pipeline
+ *
+ * The thread that runs the iterator of a loop pushes the iteration-dependent
+ * inputs of each payload invocation as a fixed-size record. Each worker thread
+ * owns a bounded single-producer single-consumer ring, which is fed round-robin
+ * by the iterator, and calls the payload with the popped record and the
+ * context that holds the inputs that are invariant in the loop.
+ */
+
+typedef struct atrox_dswp atrox_dswp_t;
+
+typedef void (*atrox_dswp_payload_t)(void *record, void *context);
+
+/* Start the given number of workers with rings of the given capacity in
+ * records. The context must outlive the pipeline. */
+atrox_dswp_t *atrox_dswp_create(atrox_dswp_payload_t payload, void *context,
+                                size_t record_size, size_t capacity,
+                                unsigned workers);
+
+/* Copy the record into the ring of the next worker, waiting while it is
+ * full. */
+void atrox_dswp_push(atrox_dswp_t *pipeline, const void *record);
+
+/* Wait until all pushed records have been processed, stop the workers and
+ * release the pipeline. */
+void atrox_dswp_finish(atrox_dswp_t *pipeline);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ATROX_RUNTIME_DSWP_H */
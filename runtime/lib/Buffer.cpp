@@ -0,0 +1,69 @@
+//
+//
+//
+
+#include "AtroxRuntime/Buffer.h"
+
+#include <cstdlib>
+// using std::malloc
+// using std::realloc
+// using std::free
+// using std::abort
+
+struct atrox_buffer {
+  unsigned char *Storage;
+  size_t SlotSize;
+  size_t Size;
+  size_t Capacity;
+};
+
+namespace {
+
+void Reserve(atrox_buffer &Buffer, size_t Capacity) {
+  auto *storage = static_cast<unsigned char *>(
+      std::realloc(Buffer.Storage, Capacity * Buffer.SlotSize));
+
+  if (!storage) {
+    std::abort();
+  }
+
+  Buffer.Storage = storage;
+  Buffer.Capacity = Capacity;
+}
+
+} // namespace
+
+extern "C" {
+
+atrox_buffer_t *atrox_buffer_create(size_t record_size, size_t capacity) {
+  auto *buffer = new atrox_buffer;
+  buffer->Storage = nullptr;
+  buffer->SlotSize = record_size ? record_size : 1;
+  buffer->Size = 0;
+  buffer->Capacity = 0;
+
+  Reserve(*buffer, capacity ? capacity : 1);
+
+  return buffer;
+}
+
+void *atrox_buffer_append(atrox_buffer_t *buffer) {
+  if (buffer->Size == buffer->Capacity) {
+    Reserve(*buffer, buffer->Capacity * 2);
+  }
+
+  return buffer->Storage + buffer->SlotSize * buffer->Size++;
+}
+
+size_t atrox_buffer_size(const atrox_buffer_t *buffer) {
+  return buffer->Size;
+}
+
+void *atrox_buffer_data(atrox_buffer_t *buffer) { return buffer->Storage; }
+
+void atrox_buffer_destroy(atrox_buffer_t *buffer) {
+  std::free(buffer->Storage);
+  delete buffer;
+}
+
+} // extern "C"
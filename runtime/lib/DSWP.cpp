@@ -0,0 +1,175 @@
+//
+//
+//
+
+#include "AtroxRuntime/DSWP.h"
+
+#include <atomic>
+// using std::atomic
+
+#include <thread>
+// using std::thread
+// using std::this_thread::yield
+
+#include <memory>
+// using std::unique_ptr
+
+#include <vector>
+// using std::vector
+
+#include <cstring>
+// using std::memcpy
+
+#include <cstdint>
+// using uint8_t
+
+namespace {
+
+constexpr size_t CacheLineSize = 64;
+
+size_t RoundUpToPowerOf2(size_t N) {
+  size_t p = 1;
+
+  while (p < N) {
+    p <<= 1;
+  }
+
+  return p;
+}
+
+// a bounded ring with a single producer and a single consumer that copies
+// fixed-size records in and out
+class SPSCRing {
+  std::vector<uint8_t> Storage;
+  size_t RecordSize;
+  size_t SlotSize;
+  size_t Mask;
+
+  // keep the indices of the consumer and the producer in separate cache lines
+  std::atomic<size_t> Head{0};
+  uint8_t Padding[CacheLineSize - sizeof(std::atomic<size_t>)];
+  std::atomic<size_t> Tail{0};
+
+public:
+  SPSCRing(size_t RecordSize, size_t Capacity)
+      : RecordSize(RecordSize), SlotSize(RecordSize ? RecordSize : 1),
+        Mask(RoundUpToPowerOf2(Capacity) - 1) {
+    Storage.resize((Mask + 1) * SlotSize);
+  }
+
+  bool push(const void *Record) {
+    auto tail = Tail.load(std::memory_order_relaxed);
+
+    if (tail - Head.load(std::memory_order_acquire) > Mask) {
+      return false;
+    }
+
+    std::memcpy(&Storage[(tail & Mask) * SlotSize], Record, RecordSize);
+    Tail.store(tail + 1, std::memory_order_release);
+
+    return true;
+  }
+
+  bool pop(void *Record) {
+    auto head = Head.load(std::memory_order_relaxed);
+
+    if (head == Tail.load(std::memory_order_acquire)) {
+      return false;
+    }
+
+    std::memcpy(Record, &Storage[(head & Mask) * SlotSize], RecordSize);
+    Head.store(head + 1, std::memory_order_release);
+
+    return true;
+  }
+};
+
+} // namespace
+
+struct atrox_dswp {
+  atrox_dswp_payload_t Payload;
+  void *Context;
+  size_t RecordSize;
+  unsigned Next = 0;
+  std::atomic<bool> IsDone{false};
+  std::vector<std::unique_ptr<SPSCRing>> Rings;
+  std::vector<std::thread> Workers;
+
+  void work(SPSCRing &Ring) {
+    std::vector<uint8_t> record(RecordSize ? RecordSize : 1);
+
+    while (true) {
+      if (Ring.pop(record.data())) {
+        Payload(record.data(), Context);
+        continue;
+      }
+
+      // the producer stops pushing before it signals completion
+      if (IsDone.load(std::memory_order_acquire)) {
+        while (Ring.pop(record.data())) {
+          Payload(record.data(), Context);
+        }
+
+        break;
+      }
+
+      std::this_thread::yield();
+    }
+  }
+};
+
+extern "C" {
+
+atrox_dswp_t *atrox_dswp_create(atrox_dswp_payload_t payload, void *context,
+                                size_t record_size, size_t capacity,
+                                unsigned workers) {
+  auto *pipeline = new atrox_dswp;
+  pipeline->Payload = payload;
+  pipeline->Context = context;
+  pipeline->RecordSize = record_size;
+
+  if (!workers) {
+    workers = 1;
+  }
+
+  if (!capacity) {
+    capacity = 1;
+  }
+
+  for (unsigned i = 0; i < workers; ++i) {
+    pipeline->Rings.emplace_back(new SPSCRing(record_size, capacity));
+  }
+
+  for (unsigned i = 0; i < workers; ++i) {
+    auto &ring = *pipeline->Rings[i];
+    pipeline->Workers.emplace_back([pipeline, &ring]() {
+      pipeline->work(ring);
+    });
+  }
+
+  return pipeline;
+}
+
+void atrox_dswp_push(atrox_dswp_t *pipeline, const void *record) {
+  auto &ring = *pipeline->Rings[pipeline->Next];
+
+  while (!ring.push(record)) {
+    std::this_thread::yield();
+  }
+
+  if (++pipeline->Next == pipeline->Rings.size()) {
+    pipeline->Next = 0;
+  }
+}
+
+void atrox_dswp_finish(atrox_dswp_t *pipeline) {
+  pipeline->IsDone.store(true, std::memory_order_release);
+
+  for (auto &e : pipeline->Workers) {
+    e.join();
+  }
+
+  delete pipeline;
+}
+
+} // extern "C"
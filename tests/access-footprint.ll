@@ -0,0 +1,65 @@
+; RUN: rm -rf %t
+; RUN: env LOOPBODYCLONER_CMDLINE_OPTIONS="-atrox-export-results -atrox-reports-dir=%t" opt %loaddependees -load %bindir/%testeelib -basicaa -atrox-lbc-pass -disable-output < %s
+; RUN: FileCheck %s < %t/lpc.rows.extracted.0.json
+
+; a payload invocation reads one row of 16 elements, so its footprint spans
+; 64 bytes from the start of the row, and the offset strides by an element in
+; the inner loop and by a row in the payload loop
+
+; CHECK: "footprint": {
+; CHECK-NEXT: "base": "%a",
+; CHECK-NEXT: "element size": 4,
+; CHECK-NEXT: "max offset": "(60 + {0,+,64}<{{.*}}%header>)",
+; CHECK-NEXT: "min offset": "{0,+,64}<{{.*}}%header>",
+; CHECK-NEXT: "strides": [
+; CHECK-NEXT: {
+; CHECK-NEXT: "loop": "inner.header",
+; CHECK-NEXT: "stride": "4"
+; CHECK-NEXT: },
+; CHECK-NEXT: {
+; CHECK-NEXT: "loop": "header",
+; CHECK-NEXT: "stride": "64"
+; CHECK: "name": "a",
+
+define void @rows(i32* noalias %a, i32* noalias %out, i64 %n) {
+entry:
+  br label %header
+
+header:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %cmp = icmp slt i64 %i, %n
+  br i1 %cmp, label %body, label %exit
+
+body:
+  %row = mul nsw i64 %i, 16
+  br label %inner.header
+
+inner.header:
+  %j = phi i64 [ 0, %body ], [ %j.next, %inner.latch ]
+  %s = phi i32 [ 0, %body ], [ %s.next, %inner.latch ]
+  %inner.cmp = icmp slt i64 %j, 16
+  br i1 %inner.cmp, label %inner.body, label %body.exit
+
+inner.body:
+  %k = add nsw i64 %row, %j
+  %a.addr = getelementptr inbounds i32, i32* %a, i64 %k
+  %v = load i32, i32* %a.addr, align 4
+  %s.next = add nsw i32 %s, %v
+  br label %inner.latch
+
+inner.latch:
+  %j.next = add nsw i64 %j, 1
+  br label %inner.header
+
+body.exit:
+  %out.addr = getelementptr inbounds i32, i32* %out, i64 %i
+  store i32 %s, i32* %out.addr, align 4
+  br label %latch
+
+latch:
+  %i.next = add nsw i64 %i, 1
+  br label %header
+
+exit:
+  ret void
+}
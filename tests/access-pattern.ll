@@ -0,0 +1,51 @@
+; RUN: rm -rf %t
+; RUN: env LOOPBODYCLONER_CMDLINE_OPTIONS="-atrox-export-results -atrox-reports-dir=%t" opt %loaddependees -load %bindir/%testeelib -basicaa -atrox-lbc-pass -disable-output < %s
+; RUN: FileCheck %s < %t/lpc.gather.extracted.0.json
+
+; the index and output buffers are walked an element at a time, the gathered
+; buffer is addressed through loaded indices and every other element of the
+; last buffer is written
+
+; CHECK: "access pattern": "unit stride",
+; CHECK-NEXT: "access pattern confidence": "high",
+; CHECK: "name": "idx",
+; CHECK: "access pattern": "indirect",
+; CHECK-NEXT: "access pattern confidence": "high",
+; CHECK: "name": "a",
+; CHECK: "access pattern": "unit stride",
+; CHECK-NEXT: "access pattern confidence": "high",
+; CHECK: "name": "out",
+; CHECK: "access pattern": "strided",
+; CHECK-NEXT: "access pattern confidence": "high",
+; CHECK: "name": "st",
+
+define void @gather(i32* noalias %idx, i32* noalias %a, i32* noalias %out,
+                    i32* noalias %st, i64 %n) {
+entry:
+  br label %header
+
+header:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %cmp = icmp slt i64 %i, %n
+  br i1 %cmp, label %body, label %exit
+
+body:
+  %idx.addr = getelementptr inbounds i32, i32* %idx, i64 %i
+  %j = load i32, i32* %idx.addr, align 4
+  %j.ext = sext i32 %j to i64
+  %a.addr = getelementptr inbounds i32, i32* %a, i64 %j.ext
+  %v = load i32, i32* %a.addr, align 4
+  %out.addr = getelementptr inbounds i32, i32* %out, i64 %i
+  store i32 %v, i32* %out.addr, align 4
+  %i.twice = shl nsw i64 %i, 1
+  %st.addr = getelementptr inbounds i32, i32* %st, i64 %i.twice
+  store i32 %v, i32* %st.addr, align 4
+  br label %latch
+
+latch:
+  %i.next = add nsw i64 %i, 1
+  br label %header
+
+exit:
+  ret void
+}
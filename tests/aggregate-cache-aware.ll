@@ -0,0 +1,49 @@
+; RUN: rm -rf %t
+; RUN: env LOOPBODYCLONER_CMDLINE_OPTIONS="-atrox-aggregate-extracted-args -atrox-aggregate-layout=cache-aware -atrox-export-results -atrox-reports-dir=%t" opt %loaddependees -load %bindir/%testeelib -basicaa -atrox-lbc-pass -S < %s | FileCheck %s
+; RUN: FileCheck -check-prefix=JSON %s < %t/lpc.fill.extracted.0.json
+; RUN: env LOOPBODYCLONER_CMDLINE_OPTIONS="-atrox-aggregate-extracted-args -atrox-aggregate-layout=cache-aware -atrox-aggregate-private-outputs" opt %loaddependees -load %bindir/%testeelib -basicaa -atrox-lbc-pass -S < %s | FileCheck -check-prefix=PRIVATE %s
+
+; the read-only inputs are sorted by size and the writable output starts on a
+; cache line of its own, which it fills with padding
+
+; CHECK-LABEL: define {{.*}}@fill_body(
+; CHECK-SAME: { {{.*}}, i32, [36 x i8], i64, [56 x i8] }*
+
+; JSON: "aggregate layout": {
+; JSON-NEXT: "alignment": 64,
+; JSON-NEXT: "block sizes": [
+; JSON-NEXT: 128
+; JSON: "name": "step.out",
+; JSON-NEXT: "offset": 64,
+; JSON-NEXT: "size": 8,
+; JSON-NEXT: "writable": true
+; JSON: "kind": "cache-aware",
+; JSON-NEXT: "private outputs": false
+
+; private outputs are passed in a separate block
+
+; PRIVATE-LABEL: define {{.*}}@fill_body(
+; PRIVATE-SAME: { {{.*}}, i32 }* {{.*}}, { i64, [56 x i8] }*
+
+define void @fill(i32* noalias %a, i32 %k, i64 %s, i64 %n) {
+entry:
+  br label %header
+
+header:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %cmp = icmp slt i64 %i, %n
+  br i1 %cmp, label %body, label %exit
+
+body:
+  %a.addr = getelementptr inbounds i32, i32* %a, i64 %i
+  store i32 %k, i32* %a.addr, align 4
+  %step = add nsw i64 %s, 1
+  br label %latch
+
+latch:
+  %i.next = add nsw i64 %i, %step
+  br label %header
+
+exit:
+  ret void
+}
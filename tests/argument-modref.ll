@@ -0,0 +1,67 @@
+; RUN: rm -rf %t
+; RUN: env LOOPBODYCLONER_CMDLINE_OPTIONS="-atrox-export-results -atrox-reports-dir=%t" opt %loaddependees -load %bindir/%testeelib -basicaa -atrox-lbc-pass -disable-output < %s
+; RUN: FileCheck -check-prefix=COPY %s < %t/lpc.copy.extracted.0.json
+; RUN: FileCheck -check-prefix=INC %s < %t/lpc.inc.extracted.0.json
+
+; the directions of pointer arguments follow the accesses of the region to
+; their objects, so a buffer that is only read is inbound (1), one that is
+; only written is outbound (2) and one that is both read and written is
+; bidirectional (3)
+
+; COPY: "direction": 1,
+; COPY: "name": "a",
+; COPY: "direction": 1,
+; COPY: "name": "i",
+; COPY: "direction": 2,
+; COPY: "name": "out",
+
+; INC: "direction": 3,
+; INC: "name": "a",
+
+define void @copy(i32* noalias %out, i32* noalias %a, i64 %n) {
+entry:
+  br label %header
+
+header:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %cmp = icmp slt i64 %i, %n
+  br i1 %cmp, label %body, label %exit
+
+body:
+  %a.addr = getelementptr inbounds i32, i32* %a, i64 %i
+  %v = load i32, i32* %a.addr, align 4
+  %out.addr = getelementptr inbounds i32, i32* %out, i64 %i
+  store i32 %v, i32* %out.addr, align 4
+  br label %latch
+
+latch:
+  %i.next = add nsw i64 %i, 1
+  br label %header
+
+exit:
+  ret void
+}
+
+define void @inc(i32* %a, i64 %n) {
+entry:
+  br label %header
+
+header:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %cmp = icmp slt i64 %i, %n
+  br i1 %cmp, label %body, label %exit
+
+body:
+  %a.addr = getelementptr inbounds i32, i32* %a, i64 %i
+  %v = load i32, i32* %a.addr, align 4
+  %v.inc = add nsw i32 %v, 1
+  store i32 %v.inc, i32* %a.addr, align 4
+  br label %latch
+
+latch:
+  %i.next = add nsw i64 %i, 1
+  br label %header
+
+exit:
+  ret void
+}
@@ -0,0 +1,66 @@
+; RUN: opt -load %bindir/%testeelib -basicaa -atrox-decompose-array-refs-pass -S < %s | FileCheck %s
+
+; the row pointer loads are shared between accesses to the same row, but a row
+; that this function does not write can still be written by its callers, so
+; its loads are not marked as invariant
+
+; CHECK-LABEL: define i32 @shared(
+; CHECK: [[ROW:%ptrload[0-9]*]] = load i32*, i32**
+; CHECK-NOT: !invariant.load
+; CHECK-NOT: load i32*,
+; CHECK: getelementptr i32, i32* [[ROW]], i64 0
+; CHECK-NOT: load i32*,
+; CHECK: getelementptr i32, i32* [[ROW]], i64 1
+
+define i32 @shared([4 x [4 x i32]]* %a, i64 %i) {
+entry:
+  %x.addr = getelementptr [4 x [4 x i32]], [4 x [4 x i32]]* %a, i64 0, i64 %i, i64 0
+  %x = load i32, i32* %x.addr, align 4
+  %y.addr = getelementptr [4 x [4 x i32]], [4 x [4 x i32]]* %a, i64 0, i64 %i, i64 1
+  %y = load i32, i32* %y.addr, align 4
+  %sum = add nsw i32 %x, %y
+  ret i32 %sum
+}
+
+; a store that might write to the row table keeps the row pointer load of the
+; access after it from being shared
+
+; CHECK-LABEL: define i32 @clobbered(
+; CHECK: [[FIRST:%ptrload[0-9]*]] = load i32*, i32**
+; CHECK-NOT: !invariant.load
+; CHECK: getelementptr i32, i32* [[FIRST]], i64 0
+; CHECK: store i32* %q, i32** %p
+; CHECK: [[SECOND:%ptrload[0-9]*]] = load i32*, i32**
+; CHECK: getelementptr i32, i32* [[SECOND]], i64 1
+
+define i32 @clobbered([4 x [4 x i32]]* %a, i32** %p, i32* %q, i64 %i) {
+entry:
+  %x.addr = getelementptr [4 x [4 x i32]], [4 x [4 x i32]]* %a, i64 0, i64 %i, i64 0
+  %x = load i32, i32* %x.addr, align 4
+  store i32* %q, i32** %p, align 8
+  %y.addr = getelementptr [4 x [4 x i32]], [4 x [4 x i32]]* %a, i64 0, i64 %i, i64 1
+  %y = load i32, i32* %y.addr, align 4
+  %sum = add nsw i32 %x, %y
+  ret i32 %sum
+}
+
+; the rows of a constant global are invariant in the whole program
+
+@table = constant [4 x [4 x i32]] zeroinitializer
+
+; CHECK-LABEL: define i32 @constant(
+; CHECK: [[CROW:%ptrload[0-9]*]] = load i32*, i32** {{.*}}, !invariant.load
+; CHECK-NOT: load i32*,
+; CHECK: getelementptr i32, i32* [[CROW]], i64 0
+; CHECK-NOT: load i32*,
+; CHECK: getelementptr i32, i32* [[CROW]], i64 1
+
+define i32 @constant(i64 %i) {
+entry:
+  %x.addr = getelementptr [4 x [4 x i32]], [4 x [4 x i32]]* @table, i64 0, i64 %i, i64 0
+  %x = load i32, i32* %x.addr, align 4
+  %y.addr = getelementptr [4 x [4 x i32]], [4 x [4 x i32]]* @table, i64 0, i64 %i, i64 1
+  %y = load i32, i32* %y.addr, align 4
+  %sum = add nsw i32 %x, %y
+  ret i32 %sum
+}
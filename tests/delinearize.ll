@@ -0,0 +1,68 @@
+; RUN: rm -rf %t
+; RUN: opt -load %bindir/%testeelib -basicaa -atrox-decompose-array-refs-pass -S < %s | FileCheck %s
+; RUN: env LOOPBODYCLONER_CMDLINE_OPTIONS="-atrox-export-results -atrox-reports-dir=%t" opt %loaddependees -load %bindir/%testeelib -basicaa -atrox-lbc-pass -disable-output < %s
+; RUN: FileCheck -check-prefix=JSON %s < %t/lpc.vla.extracted.0.json
+
+; the linearized access is split into a row pointer, which is computed where
+; the row is invariant, and a pointer that is bumped along the row
+
+; CHECK-LABEL: define void @vla(
+; CHECK: outer.body:
+; CHECK: %row.ptr = getelementptr inbounds float, float* %a, i64 %{{.*}}
+; CHECK: %bumped.start = getelementptr float, float* %row.ptr, i64 0
+; CHECK: inner.header:
+; CHECK-NEXT: %bumped.ptr = phi float* [ %bumped.start, %outer.body ], [ %bumped.next, %inner.latch ]
+; CHECK: inner.body:
+; CHECK-NOT: getelementptr
+; CHECK: store float 0.000000e+00, float* %bumped.ptr
+; CHECK: inner.latch:
+; CHECK-NEXT: %bumped.next = getelementptr float, float* %bumped.ptr, i64 1
+
+; the row size is recovered from the accesses
+; JSON: "array shapes": [
+; JSON-NEXT: {
+; JSON-NEXT: "accesses": 1,
+; JSON-NEXT: "array": "%a",
+; JSON-NEXT: "element size": 4,
+; JSON-NEXT: "sizes": [
+; JSON-NEXT: "",
+; JSON-NEXT: "%m"
+; JSON-NEXT: ],
+; JSON-NEXT: "static": false
+; JSON-NEXT: }
+
+define void @vla(float* noalias %a, i64 %n, i64 %m) {
+entry:
+  br label %outer.header
+
+outer.header:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %outer.latch ]
+  %outer.cmp = icmp slt i64 %i, %n
+  br i1 %outer.cmp, label %outer.body, label %exit
+
+outer.body:
+  br label %inner.header
+
+inner.header:
+  %j = phi i64 [ 0, %outer.body ], [ %j.next, %inner.latch ]
+  %inner.cmp = icmp slt i64 %j, %m
+  br i1 %inner.cmp, label %inner.body, label %outer.latch
+
+inner.body:
+  %row = mul nsw i64 %i, %m
+  %idx = add nsw i64 %row, %j
+  %a.addr = getelementptr inbounds float, float* %a, i64 %idx
+  store float 0.0, float* %a.addr, align 4
+  br label %inner.latch
+
+inner.latch:
+  %j.next = add nsw i64 %j, 1
+  br label %inner.header
+
+outer.latch:
+  %i.next = add nsw i64 %i, 1
+  br label %outer.header
+
+exit:
+  ret void
+}
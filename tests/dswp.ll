@@ -0,0 +1,60 @@
+; RUN: rm -rf %t
+; RUN: env LOOPBODYCLONER_CMDLINE_OPTIONS="-atrox-dswp -atrox-export-results -atrox-reports-dir=%t" opt %loaddependees -load %bindir/%testeelib -basicaa -atrox-lbc-pass -S < %s | FileCheck %s
+; RUN: FileCheck -check-prefix=JSON %s < %t/lpc.scale.extracted.0.json
+
+; the loop pushes the varying iterator for each iteration, while the invariant
+; inputs are handed over once when the pipeline is created
+
+; CHECK-LABEL: define void @scale(
+; CHECK: %dswp.record = alloca %scale_body.dswp.record
+; CHECK: %dswp.context = alloca %scale_body.dswp.context
+; CHECK: store i32* %a,
+; CHECK: store i32 %k,
+; CHECK: %dswp = call i8* @atrox_dswp_create(void (i8*, i8*)* @scale_body.dswp, i8* %{{.*}}, i64 8, i64 1024, i32 1)
+; CHECK: dswp.push:
+; CHECK: store i64 %i,
+; CHECK: call void @atrox_dswp_push(i8* %dswp, i8* %{{.*}})
+; CHECK-NEXT: br label %latch
+; CHECK: exit:
+; CHECK-NEXT: call void @atrox_dswp_finish(i8* %dswp)
+
+; CHECK-LABEL: define internal fastcc void @scale_body(
+; CHECK-LABEL: define internal void @scale_body.dswp(i8*{{.*}}, i8*{{.*}})
+; CHECK: call fastcc void @scale_body(
+
+; JSON: "pipeline": {
+; JSON-NEXT: "capacity": 1024,
+; JSON-NEXT: "context": [
+; JSON-NEXT: "a",
+; JSON-NEXT: "k"
+; JSON-NEXT: ],
+; JSON-NEXT: "record": [
+; JSON-NEXT: "i"
+; JSON-NEXT: ],
+; JSON-NEXT: "record size": 8,
+; JSON-NEXT: "workers": 1
+; JSON-NEXT: }
+
+define void @scale(i32* noalias %a, i32 %k, i64 %n) {
+entry:
+  br label %header
+
+header:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %cmp = icmp slt i64 %i, %n
+  br i1 %cmp, label %body, label %exit
+
+body:
+  %a.addr = getelementptr inbounds i32, i32* %a, i64 %i
+  %v = load i32, i32* %a.addr, align 4
+  %w = mul nsw i32 %v, %k
+  store i32 %w, i32* %a.addr, align 4
+  br label %latch
+
+latch:
+  %i.next = add nsw i64 %i, 1
+  br label %header
+
+exit:
+  ret void
+}
@@ -0,0 +1,90 @@
+; RUN: rm -rf %t
+; RUN: env LOOPBODYCLONER_CMDLINE_OPTIONS="-atrox-fission -atrox-export-results -atrox-reports-dir=%t" opt %loaddependees -load %bindir/%testeelib -basicaa -atrox-lbc-pass -S < %s | FileCheck %s
+; RUN: FileCheck -check-prefix=JSON %s < %t/lpc.scale.extracted.0.json
+; RUN: FileCheck -check-prefix=BOUNDED %s < %t/lpc.fill.extracted.0.json
+
+; the iterator appends the varying inputs of each iteration to a buffer and
+; the payload runs over the gathered records once the iterator is done
+
+; CHECK-LABEL: define void @scale(
+; CHECK: %fission.buffer = call i8* @atrox_buffer_create(i64 8, i64 1024)
+; CHECK: fission.append:
+; CHECK-NEXT: %[[REC:.*]] = call i8* @atrox_buffer_append(i8* %fission.buffer)
+; CHECK: store i64 %i,
+; CHECK-NEXT: br label %latch
+; CHECK: exit:
+; CHECK-NEXT: %fission.size = call i64 @atrox_buffer_size(i8* %fission.buffer)
+; CHECK: icmp eq i64 %fission.size, 0
+; CHECK: fission.body:
+; CHECK-NEXT: %fission.idx = phi i64 [ 0, %exit ], [ %fission.next, %fission.body ]
+; CHECK: call fastcc void @scale_body(i32* %a, i64 %{{.*}}, i32 %k)
+; CHECK-NEXT: %fission.next = add nuw i64 %fission.idx, 1
+; CHECK: fission.end:
+; CHECK-NEXT: call void @atrox_buffer_destroy(i8* %fission.buffer)
+
+; CHECK-LABEL: define void @fill(
+; CHECK: call i8* @atrox_buffer_create(i64 8, i64 65)
+
+; JSON: "fission": {
+; JSON-NEXT: "bounded": false,
+; JSON-NEXT: "capacity": 1024,
+; JSON-NEXT: "invariant": [
+; JSON-NEXT: "a",
+; JSON-NEXT: "k"
+; JSON-NEXT: ],
+; JSON-NEXT: "record": [
+; JSON-NEXT: "i"
+; JSON-NEXT: ],
+; JSON-NEXT: "record size": 8
+; JSON-NEXT: }
+
+; the trip count of a constant loop bounds the buffer
+; BOUNDED: "fission": {
+; BOUNDED-NEXT: "bounded": true,
+; BOUNDED-NEXT: "capacity": 65,
+
+define void @scale(i32* noalias %a, i32 %k, i64 %n) {
+entry:
+  br label %header
+
+header:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %cmp = icmp slt i64 %i, %n
+  br i1 %cmp, label %body, label %exit
+
+body:
+  %a.addr = getelementptr inbounds i32, i32* %a, i64 %i
+  %v = load i32, i32* %a.addr, align 4
+  %w = mul nsw i32 %v, %k
+  store i32 %w, i32* %a.addr, align 4
+  br label %latch
+
+latch:
+  %i.next = add nsw i64 %i, 1
+  br label %header
+
+exit:
+  ret void
+}
+
+define void @fill(i32* noalias %a) {
+entry:
+  br label %header
+
+header:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %cmp = icmp slt i64 %i, 64
+  br i1 %cmp, label %body, label %exit
+
+body:
+  %a.addr = getelementptr inbounds i32, i32* %a, i64 %i
+  store i32 0, i32* %a.addr, align 4
+  br label %latch
+
+latch:
+  %i.next = add nsw i64 %i, 1
+  br label %header
+
+exit:
+  ret void
+}
@@ -0,0 +1,54 @@
+; RUN: env LOOPBODYCLONER_CMDLINE_OPTIONS="-atrox-flatten-array-accesses" opt %loaddependees -load %bindir/%testeelib -basicaa -atrox-lbc-pass -S < %s | FileCheck %s
+
+; the row offset is computed once at the payload entry, where its index is
+; available, and the innermost loop access bumps a pointer along the row
+
+; CHECK-LABEL: define {{.*}}@rows_outer.body(
+; CHECK: %ptrcast = bitcast [16 x i32]* %a to i32*
+; CHECK-NEXT: %scaled.idx = mul nsw i64 %i, 16
+; CHECK-NEXT: %row.ptr = getelementptr inbounds i32, i32* %ptrcast, i64 %scaled.idx
+; CHECK: %bumped.start = getelementptr i32, i32* %row.ptr, i64 0
+; CHECK: %bumped.ptr = phi i32* [ %bumped.start, %{{.*}} ], [ %bumped.next, %{{.*}} ]
+; CHECK-NOT: getelementptr inbounds [16 x i32]
+; CHECK: store i32 0, i32* %bumped.ptr
+; CHECK: %bumped.next = getelementptr i32, i32* %bumped.ptr, i64 1
+
+; the payload of the inner loop has no loop to bump the pointer in
+; CHECK-LABEL: define {{.*}}@rows_inner.body(
+; CHECK: %row.ptr = getelementptr inbounds i32, i32* %ptrcast, i64 %scaled.idx
+; CHECK: %flattened.ptr = getelementptr inbounds i32, i32* %row.ptr, i64 %j
+; CHECK-NEXT: store i32 0, i32* %flattened.ptr
+
+define void @rows([16 x i32]* noalias %a, i64 %n) {
+entry:
+  br label %outer.header
+
+outer.header:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %outer.latch ]
+  %outer.cmp = icmp slt i64 %i, %n
+  br i1 %outer.cmp, label %outer.body, label %exit
+
+outer.body:
+  br label %inner.header
+
+inner.header:
+  %j = phi i64 [ 0, %outer.body ], [ %j.next, %inner.latch ]
+  %inner.cmp = icmp slt i64 %j, 16
+  br i1 %inner.cmp, label %inner.body, label %outer.latch
+
+inner.body:
+  %a.addr = getelementptr inbounds [16 x i32], [16 x i32]* %a, i64 %i, i64 %j
+  store i32 0, i32* %a.addr, align 4
+  br label %inner.latch
+
+inner.latch:
+  %j.next = add nuw nsw i64 %j, 1
+  br label %inner.header
+
+outer.latch:
+  %i.next = add nsw i64 %i, 1
+  br label %outer.header
+
+exit:
+  ret void
+}
@@ -0,0 +1,183 @@
+; RUN: rm -rf %t
+; RUN: env LOOPBODYCLONER_CMDLINE_OPTIONS="-atrox-interchange -atrox-export-results -atrox-reports-dir=%t" opt %loaddependees -load %bindir/%testeelib -basicaa -atrox-lbc-pass -S < %s | FileCheck %s
+; RUN: FileCheck -check-prefix=JSON %s < %t/lpc.transpose.extracted.0.json
+; RUN: FileCheck -check-prefix=SHAPE %s < %t/lpc.triangle.extracted.0.json
+; RUN: FileCheck -check-prefix=MIXED %s < %t/lpc.mixed.extracted.0.json
+
+; the nest walks the array column by column, so the loops take over the
+; iteration spaces of each other and the body sees their induction variables
+; swapped
+
+; CHECK-LABEL: define {{.*}}@transpose_t.body(
+; CHECK: %[[OUTER:[^ ]+]] = phi i64 [ 0, %{{.*}} ], [ %{{.*}}, %{{.*}} ]
+; CHECK-NEXT: icmp slt i64 %[[OUTER]], %m
+; CHECK: %[[INNER:[^ ]+]] = phi i64 [ 0, %{{.*}} ], [ %{{.*}}, %{{.*}} ]
+; CHECK-NEXT: icmp slt i64 %[[INNER]], 1024
+; CHECK: getelementptr inbounds [1024 x float], [1024 x float]* %b, i64 %[[OUTER]], i64 %[[INNER]]
+
+; JSON: "interchange": [
+; JSON-NEXT: {
+; JSON-NEXT: "improved accesses": 1,
+; JSON-NEXT: "loop": "row.header",
+; JSON-NEXT: "outer loop": "col.header",
+; JSON-NEXT: "status": "applied",
+; JSON-NEXT: "worsened accesses": 0
+; JSON-NEXT: }
+
+; the bound of the inner loop depends on the outer loop
+; SHAPE: "interchange": [
+; SHAPE: "status": "unsupported shape",
+
+; the outer loop tests its bound at the latch and would take over the range of
+; the inner loop, which might be empty, without a guard
+; CHECK-LABEL: define {{.*}}@mixed_t.body(
+; CHECK: getelementptr inbounds [1024 x float], [1024 x float]* %b, i64 %j{{[^,]*}}, i64 %i
+; MIXED: "interchange": [
+; MIXED: "status": "unsupported shape",
+
+define void @transpose([1024 x float]* noalias %b, i64 %m, i64 %r) {
+entry:
+  br label %t.header
+
+t.header:
+  %t = phi i64 [ 0, %entry ], [ %t.next, %t.latch ]
+  %t.cmp = icmp slt i64 %t, %r
+  br i1 %t.cmp, label %t.body, label %exit
+
+t.body:
+  br label %col.header
+
+col.header:
+  %i = phi i64 [ 0, %t.body ], [ %i.next, %col.latch ]
+  %col.cmp = icmp slt i64 %i, 1024
+  br i1 %col.cmp, label %row.preheader, label %col.exit
+
+row.preheader:
+  br label %row.header
+
+row.header:
+  %j = phi i64 [ 0, %row.preheader ], [ %j.next, %row.latch ]
+  %row.cmp = icmp slt i64 %j, %m
+  br i1 %row.cmp, label %row.body, label %col.latch
+
+row.body:
+  %b.addr = getelementptr inbounds [1024 x float], [1024 x float]* %b, i64 %j, i64 %i
+  store float 0.0, float* %b.addr, align 4
+  br label %row.latch
+
+row.latch:
+  %j.next = add nsw i64 %j, 1
+  br label %row.header
+
+col.latch:
+  %i.next = add nsw i64 %i, 1
+  br label %col.header
+
+col.exit:
+  br label %t.latch
+
+t.latch:
+  %t.next = add nsw i64 %t, 1
+  br label %t.header
+
+exit:
+  ret void
+}
+
+define void @triangle([1024 x float]* noalias %b, i64 %r) {
+entry:
+  br label %t.header
+
+t.header:
+  %t = phi i64 [ 0, %entry ], [ %t.next, %t.latch ]
+  %t.cmp = icmp slt i64 %t, %r
+  br i1 %t.cmp, label %t.body, label %exit
+
+t.body:
+  br label %col.header
+
+col.header:
+  %i = phi i64 [ 0, %t.body ], [ %i.next, %col.latch ]
+  %col.cmp = icmp slt i64 %i, 1024
+  br i1 %col.cmp, label %row.preheader, label %col.exit
+
+row.preheader:
+  br label %row.header
+
+row.header:
+  %j = phi i64 [ 0, %row.preheader ], [ %j.next, %row.latch ]
+  %row.cmp = icmp slt i64 %j, %i
+  br i1 %row.cmp, label %row.body, label %col.latch
+
+row.body:
+  %b.addr = getelementptr inbounds [1024 x float], [1024 x float]* %b, i64 %j, i64 %i
+  store float 0.0, float* %b.addr, align 4
+  br label %row.latch
+
+row.latch:
+  %j.next = add nsw i64 %j, 1
+  br label %row.header
+
+col.latch:
+  %i.next = add nsw i64 %i, 1
+  br label %col.header
+
+col.exit:
+  br label %t.latch
+
+t.latch:
+  %t.next = add nsw i64 %t, 1
+  br label %t.header
+
+exit:
+  ret void
+}
+
+define void @mixed([1024 x float]* noalias %b, i64 %m, i64 %r) {
+entry:
+  br label %t.header
+
+t.header:
+  %t = phi i64 [ 0, %entry ], [ %t.next, %t.latch ]
+  %t.cmp = icmp slt i64 %t, %r
+  br i1 %t.cmp, label %t.body, label %exit
+
+t.body:
+  br label %col.header
+
+col.header:
+  %i = phi i64 [ 0, %t.body ], [ %i.next, %col.latch ]
+  br label %row.preheader
+
+row.preheader:
+  br label %row.header
+
+row.header:
+  %j = phi i64 [ 0, %row.preheader ], [ %j.next, %row.latch ]
+  %row.cmp = icmp slt i64 %j, %m
+  br i1 %row.cmp, label %row.body, label %col.latch
+
+row.body:
+  %b.addr = getelementptr inbounds [1024 x float], [1024 x float]* %b, i64 %j, i64 %i
+  store float 0.0, float* %b.addr, align 4
+  br label %row.latch
+
+row.latch:
+  %j.next = add nsw i64 %j, 1
+  br label %row.header
+
+col.latch:
+  %i.next = add nsw i64 %i, 1
+  %col.cmp = icmp slt i64 %i.next, 1024
+  br i1 %col.cmp, label %col.header, label %col.exit
+
+col.exit:
+  br label %t.latch
+
+t.latch:
+  %t.next = add nsw i64 %t, 1
+  br label %t.header
+
+exit:
+  ret void
+}
@@ -0,0 +1,45 @@
+; RUN: env LOOPBODYCLONER_CMDLINE_OPTIONS="-atrox-interleave" opt %loaddependees -load %bindir/%testeelib -basicaa -atrox-lbc-pass -S < %s | FileCheck %s
+; RUN: env LOOPBODYCLONER_CMDLINE_OPTIONS="-atrox-interleave" opt %loaddependees -load %bindir/%testeelib -basicaa -atrox-lbc-pass < %s | opt -coro-early -coro-split -coro-elide -coro-cleanup -S | FileCheck -check-prefix=LOWERED --implicit-check-not="call i8 @llvm.coro.suspend" --implicit-check-not="call void @llvm.coro.resume" %s
+
+; the indirect load of the payload is a suspend point of its coroutine
+
+; CHECK-LABEL: define void @gather(
+; CHECK-DAG: call void @llvm.coro.resume(i8*
+; CHECK-DAG: call i8* @gather_body.coro(
+; CHECK-LABEL: define internal i8* @gather_body.coro(
+; CHECK: call token @llvm.coro.id(
+; CHECK: call void @llvm.prefetch
+; CHECK-NEXT: call i8 @llvm.coro.suspend(token none, i1 false)
+
+; the coroutine passes lower all suspend points of the payload coroutine
+
+; LOWERED-DAG: define internal fastcc void @gather_body.coro.resume(
+; LOWERED-DAG: define internal fastcc void @gather_body.coro.destroy(
+
+define void @gather(i32* noalias %out, i32* noalias %idx, i32* noalias %a,
+                    i64 %n) {
+entry:
+  br label %header
+
+header:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %cmp = icmp slt i64 %i, %n
+  br i1 %cmp, label %body, label %exit
+
+body:
+  %idx.addr = getelementptr inbounds i32, i32* %idx, i64 %i
+  %j = load i32, i32* %idx.addr, align 4
+  %j.ext = sext i32 %j to i64
+  %a.addr = getelementptr inbounds i32, i32* %a, i64 %j.ext
+  %v = load i32, i32* %a.addr, align 4
+  %out.addr = getelementptr inbounds i32, i32* %out, i64 %i
+  store i32 %v, i32* %out.addr, align 4
+  br label %latch
+
+latch:
+  %i.next = add nsw i64 %i, 1
+  br label %header
+
+exit:
+  ret void
+}
@@ -0,0 +1,66 @@
+; RUN: rm -rf %t
+; RUN: env LOOPBODYCLONER_CMDLINE_OPTIONS="-atrox-export-results -atrox-reports-dir=%t" opt %loaddependees -load %bindir/%testeelib -basicaa -atrox-lbc-pass -disable-output < %s
+; RUN: FileCheck %s < %t/lpc.rows.extracted.0.json
+
+; the payload loop runs up to a symbolic end, while the loop nested in it has
+; a constant trip count
+
+; CHECK: "loop bounds": [
+; CHECK-NEXT: {
+; CHECK-NEXT: "backedge taken count": "{{.*}}%n{{.*}}",
+; CHECK-NEXT: "end": "{{.*}}%n{{.*}}",
+; CHECK-NEXT: "header": "header",
+; CHECK-NEXT: "induction variable": "%i",
+; CHECK-NEXT: "max trip count": 0,
+; CHECK-NEXT: "start": "0"
+; CHECK-NEXT: },
+; CHECK-NEXT: {
+; CHECK-NEXT: "backedge taken count": "16",
+; CHECK-NEXT: "end": "16",
+; CHECK-NEXT: "header": "inner.header",
+; CHECK-NEXT: "induction variable": "%j",
+; CHECK-NEXT: "max trip count": 17,
+; CHECK-NEXT: "start": "0"
+
+define void @rows(i32* noalias %a, i32* noalias %out, i64 %n) {
+entry:
+  br label %header
+
+header:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %cmp = icmp slt i64 %i, %n
+  br i1 %cmp, label %body, label %exit
+
+body:
+  %row = mul nsw i64 %i, 16
+  br label %inner.header
+
+inner.header:
+  %j = phi i64 [ 0, %body ], [ %j.next, %inner.latch ]
+  %s = phi i32 [ 0, %body ], [ %s.next, %inner.latch ]
+  %inner.cmp = icmp slt i64 %j, 16
+  br i1 %inner.cmp, label %inner.body, label %body.exit
+
+inner.body:
+  %k = add nsw i64 %row, %j
+  %a.addr = getelementptr inbounds i32, i32* %a, i64 %k
+  %v = load i32, i32* %a.addr, align 4
+  %s.next = add nsw i32 %s, %v
+  br label %inner.latch
+
+inner.latch:
+  %j.next = add nsw i64 %j, 1
+  br label %inner.header
+
+body.exit:
+  %out.addr = getelementptr inbounds i32, i32* %out, i64 %i
+  store i32 %s, i32* %out.addr, align 4
+  br label %latch
+
+latch:
+  %i.next = add nsw i64 %i, 1
+  br label %header
+
+exit:
+  ret void
+}
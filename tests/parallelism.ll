@@ -0,0 +1,88 @@
+; RUN: rm -rf %t
+; RUN: env LOOPBODYCLONER_CMDLINE_OPTIONS="-atrox-export-results -atrox-reports-dir=%t" opt %loaddependees -load %bindir/%testeelib -basicaa -atrox-lbc-pass -disable-output < %s
+; RUN: FileCheck -check-prefix=DOALL %s < %t/lpc.copy.extracted.0.json
+; RUN: FileCheck -check-prefix=SERIAL %s < %t/lpc.shift.extracted.0.json
+; RUN: FileCheck -check-prefix=REDUCTION %s < %t/lpc.sum.extracted.0.json
+
+; DOALL: "parallelism": "doall"
+; SERIAL: "parallelism": "serial"
+; REDUCTION: "parallelism": "reduction"
+
+; the iterations access disjoint elements
+
+define void @copy(i32* noalias %out, i32* noalias %a, i64 %n) {
+entry:
+  br label %header
+
+header:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %cmp = icmp slt i64 %i, %n
+  br i1 %cmp, label %body, label %exit
+
+body:
+  %a.addr = getelementptr inbounds i32, i32* %a, i64 %i
+  %v = load i32, i32* %a.addr, align 4
+  %out.addr = getelementptr inbounds i32, i32* %out, i64 %i
+  store i32 %v, i32* %out.addr, align 4
+  br label %latch
+
+latch:
+  %i.next = add nsw i64 %i, 1
+  br label %header
+
+exit:
+  ret void
+}
+
+; each iteration reads the element written by the previous one
+
+define void @shift(i32* noalias %a, i64 %n) {
+entry:
+  br label %header
+
+header:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %cmp = icmp slt i64 %i, %n
+  br i1 %cmp, label %body, label %exit
+
+body:
+  %a.addr = getelementptr inbounds i32, i32* %a, i64 %i
+  %v = load i32, i32* %a.addr, align 4
+  %i.succ = add nsw i64 %i, 1
+  %a.succ = getelementptr inbounds i32, i32* %a, i64 %i.succ
+  store i32 %v, i32* %a.succ, align 4
+  br label %latch
+
+latch:
+  %i.next = add nsw i64 %i, 1
+  br label %header
+
+exit:
+  ret void
+}
+
+; the only value carried across iterations is a sum
+
+define i32 @sum(i32* noalias %a, i64 %n) {
+entry:
+  br label %header
+
+header:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %latch ]
+  %cmp = icmp slt i64 %i, %n
+  br i1 %cmp, label %body, label %exit
+
+body:
+  %a.addr = getelementptr inbounds i32, i32* %a, i64 %i
+  %v = load i32, i32* %a.addr, align 4
+  %s.next = add nsw i32 %s, %v
+  br label %latch
+
+latch:
+  %i.next = add nsw i64 %i, 1
+  br label %header
+
+exit:
+  ret i32 %s
+}
@@ -0,0 +1,38 @@
+; RUN: rm -rf %t
+; RUN: env LOOPBODYCLONER_CMDLINE_OPTIONS="-atrox-payload-cost-model=tti -atrox-export-results -atrox-reports-dir=%t/tti" opt %loaddependees -load %bindir/%testeelib -basicaa -atrox-lbc-pass -disable-output < %s
+; RUN: FileCheck -check-prefix=TTI %s < %t/tti/lpc.scale.extracted.0.json
+; RUN: env LOOPBODYCLONER_CMDLINE_OPTIONS="-atrox-export-results -atrox-reports-dir=%t/table" opt %loaddependees -load %bindir/%testeelib -basicaa -atrox-lbc-pass -disable-output < %s
+; RUN: FileCheck -check-prefix=TABLE %s < %t/table/lpc.scale.extracted.0.json
+
+; the extraction cost tells which model weighted the payload and the call
+
+; TTI: "extraction": {
+; TTI: "cost model": "tti",
+
+; TABLE: "extraction": {
+; TABLE-NEXT: "call overhead": 41,
+; TABLE-NEXT: "cost model": "table",
+
+define void @scale(i32* noalias %a, i32 %k, i64 %n) {
+entry:
+  br label %header
+
+header:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %cmp = icmp slt i64 %i, %n
+  br i1 %cmp, label %body, label %exit
+
+body:
+  %a.addr = getelementptr inbounds i32, i32* %a, i64 %i
+  %v = load i32, i32* %a.addr, align 4
+  %w = mul nsw i32 %v, %k
+  store i32 %w, i32* %a.addr, align 4
+  br label %latch
+
+latch:
+  %i.next = add nsw i64 %i, 1
+  br label %header
+
+exit:
+  ret void
+}
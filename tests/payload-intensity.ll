@@ -0,0 +1,47 @@
+; RUN: rm -rf %t
+; RUN: env LOOPBODYCLONER_CMDLINE_OPTIONS="-atrox-export-results -atrox-reports-dir=%t/memory" opt %loaddependees -load %bindir/%testeelib -basicaa -atrox-lbc-pass -disable-output < %s
+; RUN: FileCheck -check-prefixes=CHECK,MEMORY %s < %t/memory/lpc.saxpy.extracted.0.json
+; RUN: env LOOPBODYCLONER_CMDLINE_OPTIONS="-atrox-peak-gops=0.5 -atrox-export-results -atrox-reports-dir=%t/compute" opt %loaddependees -load %bindir/%testeelib -basicaa -atrox-lbc-pass -disable-output < %s
+; RUN: FileCheck -check-prefixes=CHECK,COMPUTE %s < %t/compute/lpc.saxpy.extracted.0.json
+
+; two floating point operations per 8 bytes loaded and 4 bytes stored fall
+; below the ridge point of the default machine, which is 5 operations per
+; byte, and above the one of a machine that peaks at 0.5 Gop/s
+
+; CHECK: "intensity": {
+; CHECK-NEXT: "arithmetic intensity": 0.1666{{[0-9]*}},
+; CHECK-NEXT: "bytes loaded": 8,
+; CHECK-NEXT: "bytes stored": 4,
+; CHECK-NEXT: "exact": true,
+; CHECK-NEXT: "fp ops": 2,
+; CHECK-NEXT: "int ops": 0,
+; MEMORY-NEXT: "roofline bound": "memory",
+; COMPUTE-NEXT: "roofline bound": "compute",
+; CHECK-NEXT: "vector ops": 0
+
+define void @saxpy(float* noalias %x, float* noalias %y, float %f, i64 %n) {
+entry:
+  br label %header
+
+header:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %cmp = icmp slt i64 %i, %n
+  br i1 %cmp, label %body, label %exit
+
+body:
+  %x.addr = getelementptr inbounds float, float* %x, i64 %i
+  %xv = load float, float* %x.addr, align 4
+  %y.addr = getelementptr inbounds float, float* %y, i64 %i
+  %yv = load float, float* %y.addr, align 4
+  %m = fmul float %f, %xv
+  %r = fadd float %m, %yv
+  store float %r, float* %y.addr, align 4
+  br label %latch
+
+latch:
+  %i.next = add nsw i64 %i, 1
+  br label %header
+
+exit:
+  ret void
+}
@@ -0,0 +1,142 @@
+; RUN: rm -rf %t
+; RUN: env LOOPBODYCLONER_CMDLINE_OPTIONS="-atrox-prefetch -atrox-prefetch-indirect -atrox-prefetch-distance=4 -atrox-export-results -atrox-reports-dir=%t" opt %loaddependees -load %bindir/%testeelib -basicaa -atrox-lbc-pass -S < %s | FileCheck %s
+; RUN: FileCheck -check-prefix=JSON %s < %t/lpc.gather.extracted.0.json
+
+; the gathered buffer is prefetched in two stages: the index array is brought
+; in twice the distance ahead and, when the iteration a distance ahead is
+; within the loop bounds, its index is loaded to prefetch the gathered element
+;
+; a loop that tests its bound in the header never executes the exit value of
+; its induction variable, so the guard excludes it, while a loop that tests its
+; bound at the latch includes its last value
+
+; CHECK-LABEL: define {{.*}}@gather_body(
+; CHECK: call void @llvm.prefetch{{.*}}(i8* %prefetch.addr, i32 0, i32 3, i32 1)
+; CHECK-NEXT: load i32, i32* %{{.*}}
+; CHECK: getelementptr i8, i8* %{{.*}}, i64 32
+; CHECK-NEXT: call void @llvm.prefetch{{.*}}, i32 0, i32 3, i32 1)
+; CHECK-NEXT: %[[NEXT:.*]] = add i64 %{{.*}}, 4
+; CHECK-NEXT: %[[COND:.*]] = icmp slt i64 %[[NEXT]], %{{.*}}
+; CHECK-NEXT: br i1 %[[COND]], label %[[THEN:.*]], label %[[TAIL:.*]]
+; CHECK: [[THEN]]:
+; CHECK: %[[IDX:prefetch.idx[0-9]*]] = load i32, i32* %{{.*}}
+; CHECK-NEXT: %[[EXT:.*]] = sext i32 %[[IDX]] to i64
+; CHECK-NEXT: getelementptr i32, i32* %{{.*}}, i64 %[[EXT]]
+; CHECK: call void @llvm.prefetch{{.*}}, i32 0, i32 3, i32 1)
+; CHECK-NEXT: br label %[[TAIL]]
+; CHECK: [[TAIL]]:
+; CHECK-NEXT: load i32, i32* %{{.*}}
+
+; the iteration at 4 would load idx[8], one past the end of the index array
+; CHECK-LABEL: define {{.*}}@gather8_body(
+; CHECK: %[[NEXT8:.*]] = add i64 %{{.*}}, 4
+; CHECK-NEXT: %[[COND8:.*]] = icmp slt i64 %[[NEXT8]], 8
+; CHECK-NEXT: br i1 %[[COND8]]
+
+; CHECK-LABEL: define {{.*}}@gather_rotated_body(
+; CHECK: %[[NEXTR:.*]] = add i64 %{{.*}}, 4
+; CHECK-NEXT: %[[CONDR:.*]] = icmp sle i64 %[[NEXTR]], %{{.*}}
+; CHECK-NEXT: br i1 %[[CONDR]]
+
+; JSON: "prefetches": [
+; JSON: "base": "idx",
+; JSON: "kind": "strided",
+; JSON: "base": "out",
+; JSON: "kind": "strided",
+; JSON: "write": true
+; JSON-NEXT: },
+; JSON-NEXT: {
+; JSON-NEXT: "base": "a",
+; JSON-NEXT: "distance": 4,
+; JSON-NEXT: "index": "idx",
+; JSON-NEXT: "kind": "indirect",
+; JSON-NEXT: "loop": "header",
+; JSON-NEXT: "stride": 4,
+; JSON-NEXT: "write": false
+; JSON-NEXT: }
+; JSON-NEXT: ]
+
+define void @gather(i32* noalias %idx, i32* noalias %a, i32* noalias %out,
+                    i64 %n) {
+entry:
+  br label %header
+
+header:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %cmp = icmp slt i64 %i, %n
+  br i1 %cmp, label %body, label %exit
+
+body:
+  %idx.addr = getelementptr inbounds i32, i32* %idx, i64 %i
+  %j = load i32, i32* %idx.addr, align 4
+  %j.ext = sext i32 %j to i64
+  %a.addr = getelementptr inbounds i32, i32* %a, i64 %j.ext
+  %v = load i32, i32* %a.addr, align 4
+  %n.trunc = trunc i64 %n to i32
+  %w = add nsw i32 %v, %n.trunc
+  %out.addr = getelementptr inbounds i32, i32* %out, i64 %i
+  store i32 %w, i32* %out.addr, align 4
+  br label %latch
+
+latch:
+  %i.next = add nsw i64 %i, 1
+  br label %header
+
+exit:
+  ret void
+}
+
+define void @gather8(i32* noalias %idx, i32* noalias %a, i32* noalias %out) {
+entry:
+  br label %header
+
+header:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %cmp = icmp slt i64 %i, 8
+  br i1 %cmp, label %body, label %exit
+
+body:
+  %idx.addr = getelementptr inbounds i32, i32* %idx, i64 %i
+  %j = load i32, i32* %idx.addr, align 4
+  %j.ext = sext i32 %j to i64
+  %a.addr = getelementptr inbounds i32, i32* %a, i64 %j.ext
+  %v = load i32, i32* %a.addr, align 4
+  %out.addr = getelementptr inbounds i32, i32* %out, i64 %i
+  store i32 %v, i32* %out.addr, align 4
+  br label %latch
+
+latch:
+  %i.next = add nsw i64 %i, 1
+  br label %header
+
+exit:
+  ret void
+}
+
+define void @gather_rotated(i32* noalias %idx, i32* noalias %a,
+                            i32* noalias %out, i64 %n) {
+entry:
+  br label %header
+
+header:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  br label %body
+
+body:
+  %idx.addr = getelementptr inbounds i32, i32* %idx, i64 %i
+  %j = load i32, i32* %idx.addr, align 4
+  %j.ext = sext i32 %j to i64
+  %a.addr = getelementptr inbounds i32, i32* %a, i64 %j.ext
+  %v = load i32, i32* %a.addr, align 4
+  %out.addr = getelementptr inbounds i32, i32* %out, i64 %i
+  store i32 %v, i32* %out.addr, align 4
+  br label %latch
+
+latch:
+  %i.next = add nsw i64 %i, 1
+  %cmp = icmp slt i64 %i.next, %n
+  br i1 %cmp, label %header, label %exit
+
+exit:
+  ret void
+}
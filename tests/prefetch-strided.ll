@@ -0,0 +1,62 @@
+; RUN: rm -rf %t
+; RUN: env LOOPBODYCLONER_CMDLINE_OPTIONS="-atrox-prefetch -atrox-prefetch-distance=4 -atrox-export-results -atrox-reports-dir=%t" opt %loaddependees -load %bindir/%testeelib -basicaa -atrox-lbc-pass -S < %s | FileCheck %s
+; RUN: FileCheck -check-prefix=JSON %s < %t/lpc.copy.extracted.0.json
+
+; both buffers are prefetched four iterations ahead, while the second load
+; from the source buffer shares the cache line of the first one
+
+; CHECK-LABEL: define {{.*}}@copy_body(
+; CHECK: %prefetch.addr = getelementptr i8, i8* %{{.*}}, i64 16
+; CHECK-NEXT: call void @llvm.prefetch{{.*}}(i8* %prefetch.addr, i32 0, i32 3, i32 1)
+; CHECK-NEXT: load i32, i32* %{{.*}}
+; CHECK-NOT: call void @llvm.prefetch{{.*}}i32 0, i32 3, i32 1)
+; CHECK: %[[ADDR:prefetch.addr[0-9]+]] = getelementptr i8, i8* %{{.*}}, i64 16
+; CHECK-NEXT: call void @llvm.prefetch{{.*}}(i8* %[[ADDR]], i32 1, i32 3, i32 1)
+; CHECK-NEXT: store i32
+
+; JSON: "prefetches": [
+; JSON-NEXT: {
+; JSON-NEXT: "base": "b",
+; JSON-NEXT: "distance": 4,
+; JSON-NEXT: "kind": "strided",
+; JSON-NEXT: "loop": "header",
+; JSON-NEXT: "stride": 4,
+; JSON-NEXT: "write": false
+; JSON-NEXT: },
+; JSON-NEXT: {
+; JSON-NEXT: "base": "a",
+; JSON-NEXT: "distance": 4,
+; JSON-NEXT: "kind": "strided",
+; JSON-NEXT: "loop": "header",
+; JSON-NEXT: "stride": 4,
+; JSON-NEXT: "write": true
+; JSON-NEXT: }
+; JSON-NEXT: ]
+
+define void @copy(i32* noalias %a, i32* noalias %b, i64 %n) {
+entry:
+  br label %header
+
+header:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %cmp = icmp slt i64 %i, %n
+  br i1 %cmp, label %body, label %exit
+
+body:
+  %b.addr = getelementptr inbounds i32, i32* %b, i64 %i
+  %x = load i32, i32* %b.addr, align 4
+  %i.succ = add nsw i64 %i, 1
+  %b.succ.addr = getelementptr inbounds i32, i32* %b, i64 %i.succ
+  %y = load i32, i32* %b.succ.addr, align 4
+  %v = add nsw i32 %x, %y
+  %a.addr = getelementptr inbounds i32, i32* %a, i64 %i
+  store i32 %v, i32* %a.addr, align 4
+  br label %latch
+
+latch:
+  %i.next = add nsw i64 %i, 1
+  br label %header
+
+exit:
+  ret void
+}
@@ -0,0 +1,101 @@
+; RUN: env LOOPBODYCLONER_CMDLINE_OPTIONS="-atrox-selection-strategy=witr" opt %loaddependees -load %bindir/%testeelib -basicaa -atrox-lbc-pass -S < %s | FileCheck -check-prefix=STATIC %s
+; RUN: env LOOPBODYCLONER_CMDLINE_OPTIONS="-atrox-selection-strategy=witr -atrox-profile-weights" opt %loaddependees -load %bindir/%testeelib -basicaa -atrox-lbc-pass -S < %s | FileCheck -check-prefix=PROFILE %s
+
+; the payload tree that starts at the check is statically heavier, but its
+; heavy part rarely runs according to the branch weights, so with profile
+; weights the tree that runs on every iteration is selected
+
+; STATIC-LABEL: define {{.*}}@hot_check(
+; STATIC-NOT: define {{.*}}@hot_common(
+
+; PROFILE-NOT: define {{.*}}@hot_check(
+; PROFILE-LABEL: define {{.*}}@hot_common(
+; PROFILE-NOT: define {{.*}}@hot_check(
+
+; the payload of a function with an entry count is entered as often as its
+; first block runs
+
+; STATIC-LABEL: define {{.*}}@counted_body(
+; STATIC-NOT: i64 990
+
+; PROFILE-LABEL: define {{.*}}@counted_body({{.*}} !prof ![[COUNT:[0-9]+]]
+; PROFILE: ![[COUNT]] = !{!"function_entry_count", i64 990}
+
+define void @hot(i32* noalias %a, i32* noalias %b, i32* noalias %c, i64 %n) {
+entry:
+  br label %header
+
+header:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %cmp = icmp slt i64 %i, %n
+  br i1 %cmp, label %check, label %exit
+
+check:
+  %c.addr = getelementptr inbounds i32, i32* %c, i64 %i
+  %flag = load i32, i32* %c.addr, align 4
+  %is.rare = icmp eq i32 %flag, 0
+  br i1 %is.rare, label %rare, label %join, !prof !0
+
+rare:
+  %a.addr = getelementptr inbounds i32, i32* %a, i64 %i
+  %a0 = load i32, i32* %a.addr, align 4
+  %a1 = add nsw i32 %a0, 1
+  store i32 %a1, i32* %a.addr, align 4
+  %b.rare.addr = getelementptr inbounds i32, i32* %b, i64 %i
+  %b1 = load i32, i32* %b.rare.addr, align 4
+  %b2 = add nsw i32 %b1, %a1
+  store i32 %b2, i32* %b.rare.addr, align 4
+  %c1 = add nsw i32 %b2, %flag
+  store i32 %c1, i32* %c.addr, align 4
+  %c2 = load i32, i32* %c.addr, align 4
+  store i32 %c2, i32* %a.addr, align 4
+  br label %join
+
+join:
+  br label %mid
+
+mid:
+  %i.next = add nsw i64 %i, 1
+  br label %common
+
+common:
+  %b.addr = getelementptr inbounds i32, i32* %b, i64 %i
+  %b0 = load i32, i32* %b.addr, align 4
+  %b3 = mul nsw i32 %b0, 3
+  store i32 %b3, i32* %b.addr, align 4
+  %a.common.addr = getelementptr inbounds i32, i32* %a, i64 %i
+  store i32 %b0, i32* %a.common.addr, align 4
+  br label %latch
+
+latch:
+  br label %header
+
+exit:
+  ret void
+}
+
+define void @counted(i32* noalias %a, i64 %n) !prof !1 {
+entry:
+  br label %header
+
+header:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %cmp = icmp slt i64 %i, %n
+  br i1 %cmp, label %body, label %exit, !prof !2
+
+body:
+  %a.addr = getelementptr inbounds i32, i32* %a, i64 %i
+  store i32 0, i32* %a.addr, align 4
+  br label %latch
+
+latch:
+  %i.next = add nsw i64 %i, 1
+  br label %header
+
+exit:
+  ret void
+}
+
+!0 = !{!"branch_weights", i32 1, i32 999}
+!1 = !{!"function_entry_count", i64 10}
+!2 = !{!"branch_weights", i32 99, i32 1}
@@ -0,0 +1,47 @@
+; RUN: rm -rf %t
+; RUN: env LOOPBODYCLONER_CMDLINE_OPTIONS="-atrox-privatize-reductions -atrox-export-results -atrox-reports-dir=%t" opt %loaddependees -load %bindir/%testeelib -basicaa -atrox-lbc-pass -S < %s | FileCheck %s
+; RUN: FileCheck -check-prefix=JSON %s < %t/lpc.sum.extracted.0.json
+; RUN: env LOOPBODYCLONER_CMDLINE_OPTIONS="-atrox-export-results -atrox-reports-dir=%t/shared" opt %loaddependees -load %bindir/%testeelib -basicaa -atrox-lbc-pass -disable-output < %s
+; RUN: FileCheck -check-prefix=SHARED %s < %t/shared/lpc.sum.extracted.0.json
+
+; a privatized reduction starts from the identity of its operator instead of
+; reading the incoming partial result
+
+; CHECK-LABEL: define {{.*}}@sum_body(
+; CHECK-NOT: load i32, i32* %s.next.out
+; CHECK: add nsw i32 0, %{{.*}}
+; CHECK: store i32 %{{.*}}, i32* %s.next.out
+
+; JSON: "reductions": [
+; JSON-NEXT: {
+; JSON-NEXT: "identity": "0",
+; JSON-NEXT: "name": "s.next.out",
+; JSON-NEXT: "operator": "add",
+; JSON-NEXT: "private": true
+
+; SHARED: "reductions": [
+; SHARED: "private": false
+
+define i32 @sum(i32* noalias %a, i64 %n) {
+entry:
+  br label %header
+
+header:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %latch ]
+  %cmp = icmp slt i64 %i, %n
+  br i1 %cmp, label %body, label %exit
+
+body:
+  %a.addr = getelementptr inbounds i32, i32* %a, i64 %i
+  %v = load i32, i32* %a.addr, align 4
+  %s.next = add nsw i32 %s, %v
+  br label %latch
+
+latch:
+  %i.next = add nsw i64 %i, 1
+  br label %header
+
+exit:
+  ret i32 %s
+}
@@ -0,0 +1,82 @@
+; RUN: rm -rf %t
+; RUN: env LOOPBODYCLONER_CMDLINE_OPTIONS="-atrox-extraction-mode=replace -atrox-replace-max-overhead=100 -atrox-export-results -atrox-reports-dir=%t" opt %loaddependees -load %bindir/%testeelib -basicaa -atrox-lbc-pass -S < %s | FileCheck %s
+; RUN: FileCheck -check-prefix=JSON %s < %t/lpc.scale.extracted.0.json
+; RUN: env LOOPBODYCLONER_CMDLINE_OPTIONS="-atrox-extraction-mode=replace" opt %loaddependees -load %bindir/%testeelib -basicaa -atrox-lbc-pass -S < %s | FileCheck -check-prefix=COSTLY %s
+
+; the call overhead is within the payload weight, so the payload region of a
+; loop with an unknown trip count is replaced with a call
+
+; CHECK-LABEL: define void @scale(
+; CHECK: payload.call:
+; CHECK-NEXT: call fastcc void @scale_body(i32* %a, i64 %i, i32 %k)
+; CHECK-NEXT: br label %latch
+; CHECK-NOT: load i32
+; CHECK-LABEL: define void @short(
+; CHECK-NOT: call
+; CHECK: ret void
+
+; CHECK-LABEL: define internal fastcc void @scale_body(
+; CHECK-NOT: define {{.*}}@short_body(
+
+; JSON: "extraction": {
+; JSON-NEXT: "call overhead": 41,
+; JSON-NEXT: "cost model": "table",
+; JSON-NEXT: "exact": true,
+; JSON-NEXT: "live-ins": 3,
+; JSON-NEXT: "mode": "replace",
+; JSON-NEXT: "payload weight": 62,
+; JSON-NEXT: "trip count": 0
+; JSON-NEXT: }
+
+; by default the call overhead has to be a tenth of the payload weight
+; COSTLY-NOT: payload.call:
+; COSTLY-NOT: define {{.*}}@scale_body(
+
+define void @scale(i32* noalias %a, i32 %k, i64 %n) {
+entry:
+  br label %header
+
+header:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %cmp = icmp slt i64 %i, %n
+  br i1 %cmp, label %body, label %exit
+
+body:
+  %a.addr = getelementptr inbounds i32, i32* %a, i64 %i
+  %v = load i32, i32* %a.addr, align 4
+  %w = mul nsw i32 %v, %k
+  store i32 %w, i32* %a.addr, align 4
+  br label %latch
+
+latch:
+  %i.next = add nsw i64 %i, 1
+  br label %header
+
+exit:
+  ret void
+}
+
+; a loop with a few iterations is left to be unrolled in place
+define void @short(i32* noalias %a, i32 %k) {
+entry:
+  br label %header
+
+header:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %cmp = icmp slt i64 %i, 4
+  br i1 %cmp, label %body, label %exit
+
+body:
+  %a.addr = getelementptr inbounds i32, i32* %a, i64 %i
+  %v = load i32, i32* %a.addr, align 4
+  %w = mul nsw i32 %v, %k
+  store i32 %w, i32* %a.addr, align 4
+  br label %latch
+
+latch:
+  %i.next = add nsw i64 %i, 1
+  br label %header
+
+exit:
+  ret void
+}
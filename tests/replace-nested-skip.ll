@@ -0,0 +1,60 @@
+; RUN: rm -rf %t
+; RUN: env LOOPBODYCLONER_CMDLINE_OPTIONS="-atrox-extraction-mode=replace -atrox-replace-max-overhead=1000 -atrox-export-results -atrox-reports-dir=%t" opt %loaddependees -load %bindir/%testeelib -basicaa -atrox-lbc-pass -S < %s | FileCheck %s
+; RUN: FileCheck -check-prefix=OUTER %s < %t/lpc.fill.extracted.0.json
+; RUN: FileCheck -check-prefix=INNER %s < %t/lpc.fill.extracted.1.json
+
+; the payload of the outer loop replaces its region, which contains the inner
+; loop, so the pending rewrite of the inner loop is skipped and its payload is
+; left as a plain clone
+
+; CHECK-LABEL: define void @fill(
+; CHECK: call void @fill_outer.body(
+; CHECK-NOT: call void @fill_inner.body(
+; CHECK-LABEL: define {{.*}}@fill_outer.body(
+; CHECK-LABEL: define {{.*}}@fill_inner.body(
+
+; OUTER: "func": "fill_outer.body"
+; OUTER-DAG: "mode": "replace"
+; OUTER-NOT: "skipped rewrite"
+
+; INNER: "func": "fill_inner.body"
+; INNER-DAG: "mode": "clone"
+; INNER-DAG: "skipped rewrite": {
+; INNER-DAG: "kind": "call"
+; INNER-DAG: "reason": "nested in a rewritten loop"
+
+define void @fill(i32* noalias %a, i64 %n, i64 %m) {
+entry:
+  br label %outer.header
+
+outer.header:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %outer.latch ]
+  %outer.cmp = icmp slt i64 %i, %n
+  br i1 %outer.cmp, label %outer.body, label %exit
+
+outer.body:
+  %row = mul nsw i64 %i, %m
+  br label %inner.header
+
+inner.header:
+  %j = phi i64 [ 0, %outer.body ], [ %j.next, %inner.latch ]
+  %inner.cmp = icmp slt i64 %j, %m
+  br i1 %inner.cmp, label %inner.body, label %outer.latch
+
+inner.body:
+  %k = add nsw i64 %row, %j
+  %a.addr = getelementptr inbounds i32, i32* %a, i64 %k
+  store i32 0, i32* %a.addr, align 4
+  br label %inner.latch
+
+inner.latch:
+  %j.next = add nsw i64 %j, 1
+  br label %inner.header
+
+outer.latch:
+  %i.next = add nsw i64 %i, 1
+  br label %outer.header
+
+exit:
+  ret void
+}
@@ -0,0 +1,38 @@
+; RUN: rm -rf %t
+; RUN: env LOOPBODYCLONER_CMDLINE_OPTIONS="-atrox-return-scalar-outputs=1 -atrox-export-results -atrox-reports-dir=%t" opt %loaddependees -load %bindir/%testeelib -basicaa -atrox-lbc-pass -S < %s | FileCheck %s
+; RUN: FileCheck -check-prefix=JSON %s < %t/lpc.fill.extracted.0.json
+
+; the scalar output is returned by value instead of through a pointer argument
+
+; CHECK-LABEL: define {{.*}}{ i64 } @fill_body(
+; CHECK-NOT: i64*
+; CHECK-SAME: )
+; CHECK: %step.ret = insertvalue { i64 } undef, i64 %{{.*}}, 0
+; CHECK-NEXT: ret { i64 } %step.ret
+
+; JSON: "name": "step.out",
+; JSON-NEXT: "passing": "return",
+; JSON-NEXT: "return index": 0
+
+define void @fill(i32* noalias %a, i32 %k, i64 %s, i64 %n) {
+entry:
+  br label %header
+
+header:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %cmp = icmp slt i64 %i, %n
+  br i1 %cmp, label %body, label %exit
+
+body:
+  %a.addr = getelementptr inbounds i32, i32* %a, i64 %i
+  store i32 %k, i32* %a.addr, align 4
+  %step = add nsw i64 %s, 1
+  br label %latch
+
+latch:
+  %i.next = add nsw i64 %i, %step
+  br label %header
+
+exit:
+  ret void
+}
@@ -0,0 +1,91 @@
+; RUN: rm -rf %t
+; RUN: env LOOPBODYCLONER_CMDLINE_OPTIONS="-atrox-soa -atrox-export-results -atrox-reports-dir=%t" opt %loaddependees -load %bindir/%testeelib -basicaa -atrox-lbc-pass -S < %s | FileCheck %s
+; RUN: FileCheck -check-prefix=JSON %s < %t/lpc.move.extracted.0.json
+
+; only half of each particle is accessed, so the variant takes an array for
+; each of the accessed fields instead of the array of particles
+
+; CHECK-LABEL: define {{.*}}void @move_body(%struct.particle* %p, i64 %i)
+; CHECK: getelementptr inbounds %struct.particle, %struct.particle* %p
+
+; CHECK-LABEL: define {{.*}}void @move_body.soa(float* %p.f0, float* %p.f2, i64 %i)
+; CHECK-NOT: %struct.particle
+; CHECK: getelementptr inbounds float, float* %p.f0, i64 %i
+; CHECK: getelementptr inbounds float, float* %p.f2, i64 %i
+; CHECK-NOT: %struct.particle
+; CHECK: ret void
+
+; JSON: "field density": [
+; JSON-NEXT: {
+; JSON-NEXT: "accessed fields": [
+; JSON-NEXT: {
+; JSON-NEXT: "index": 0,
+; JSON-NEXT: "offset": 0,
+; JSON-NEXT: "reads": 1,
+; JSON-NEXT: "size": 4,
+; JSON-NEXT: "writes": 1
+; JSON-NEXT: },
+; JSON-NEXT: {
+; JSON-NEXT: "index": 2,
+; JSON-NEXT: "offset": 8,
+; JSON-NEXT: "reads": 1,
+; JSON-NEXT: "size": 4,
+; JSON-NEXT: "writes": 0
+; JSON-NEXT: }
+; JSON-NEXT: ],
+; JSON-NEXT: "arg": "p",
+; JSON-NEXT: "convertible": true,
+; JSON-NEXT: "density": 0.5,
+; JSON-NEXT: "fields": 4,
+; JSON-NEXT: "size": 16,
+; JSON-NEXT: "type": "%struct.particle",
+; JSON-NEXT: "used bytes": 8
+; JSON-NEXT: }
+
+; JSON: "soa layout": {
+; JSON-NEXT: "function": "move_body.soa",
+; JSON-NEXT: "params": [
+; JSON-NEXT: {
+; JSON-NEXT: "arg": "p",
+; JSON-NEXT: "field": 0,
+; JSON-NEXT: "name": "p.f0"
+; JSON-NEXT: },
+; JSON-NEXT: {
+; JSON-NEXT: "arg": "p",
+; JSON-NEXT: "field": 2,
+; JSON-NEXT: "name": "p.f2"
+; JSON-NEXT: },
+; JSON-NEXT: {
+; JSON-NEXT: "arg": "i",
+; JSON-NEXT: "field": -1,
+; JSON-NEXT: "name": "i"
+; JSON-NEXT: }
+; JSON-NEXT: ]
+
+%struct.particle = type { float, float, float, i32 }
+
+define void @move(%struct.particle* noalias %p, i64 %n) {
+entry:
+  br label %header
+
+header:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %cmp = icmp slt i64 %i, %n
+  br i1 %cmp, label %body, label %exit
+
+body:
+  %x.addr = getelementptr inbounds %struct.particle, %struct.particle* %p, i64 %i, i32 0
+  %z.addr = getelementptr inbounds %struct.particle, %struct.particle* %p, i64 %i, i32 2
+  %x = load float, float* %x.addr, align 4
+  %z = load float, float* %z.addr, align 4
+  %s = fadd float %x, %z
+  store float %s, float* %x.addr, align 4
+  br label %latch
+
+latch:
+  %i.next = add nsw i64 %i, 1
+  br label %header
+
+exit:
+  ret void
+}
@@ -0,0 +1,114 @@
+; RUN: rm -rf %t
+; RUN: env LOOPBODYCLONER_CMDLINE_OPTIONS="-atrox-specialize -atrox-export-results -atrox-reports-dir=%t" opt %loaddependees -load %bindir/%testeelib -basicaa -atrox-lbc-pass -S < %s | FileCheck %s
+; RUN: FileCheck -check-prefix=CONST %s < %t/lpc.scale.extracted.0.json
+; RUN: FileCheck -check-prefix=TRIP %s < %t/lpc.rows.extracted.0.json
+
+; the payload becomes a stub that dispatches to a variant with the candidate
+; inputs replaced by their values when they match, and to the generic variant
+; with the original body otherwise
+
+; CHECK-LABEL: define {{.*}}void @scale_body(
+; CHECK-NEXT: entry:
+; CHECK-NEXT: %[[CMP:.*]] = icmp eq i32 %k, 4
+; CHECK-NEXT: br i1 %[[CMP]], label %specialized, label %generic
+; CHECK: specialized:
+; CHECK-NEXT: call fastcc void @scale_body.spec(i32* %a, i64 %{{[^,]*}})
+; CHECK-NEXT: ret void
+; CHECK: generic:
+; CHECK-NEXT: call fastcc void @scale_body.generic(i32* %a, i64 %{{.*}}, i32 %k)
+; CHECK-NEXT: ret void
+
+; CHECK-LABEL: define internal fastcc void @scale_body.generic(
+; CHECK: mul nsw i32 %{{.*}}, %k
+; CHECK-LABEL: define internal fastcc void @scale_body.spec(
+; CHECK: mul nsw i32 %{{.*}}, 4
+
+; the bound of the inner loop is expected to be reached
+; CHECK-LABEL: define {{.*}}void @rows_outer.body(
+; CHECK: icmp eq i8 %x, 15
+
+; CONST: "specialization": {
+; CONST-NEXT: "args": [
+; CONST-NEXT: {
+; CONST-NEXT: "name": "k",
+; CONST-NEXT: "source": "constant",
+; CONST-NEXT: "value": 4
+; CONST-NEXT: }
+; CONST-NEXT: ],
+; CONST-NEXT: "generic": "scale_body.generic",
+; CONST-NEXT: "specialized": "scale_body.spec"
+; CONST-NEXT: }
+
+; TRIP: "specialization": {
+; TRIP-NEXT: "args": [
+; TRIP-NEXT: {
+; TRIP-NEXT: "name": "x",
+; TRIP-NEXT: "source": "max trip count",
+; TRIP-NEXT: "value": 15
+; TRIP-NEXT: }
+; TRIP-NEXT: ],
+; TRIP-NEXT: "generic": "rows_outer.body.generic",
+; TRIP-NEXT: "specialized": "rows_outer.body.spec"
+
+define void @scale(i32* noalias %a, i64 %n) {
+entry:
+  %k = shl i32 1, 2
+  br label %header
+
+header:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %cmp = icmp slt i64 %i, %n
+  br i1 %cmp, label %body, label %exit
+
+body:
+  %a.addr = getelementptr inbounds i32, i32* %a, i64 %i
+  %v = load i32, i32* %a.addr, align 4
+  %w = mul nsw i32 %v, %k
+  store i32 %w, i32* %a.addr, align 4
+  br label %latch
+
+latch:
+  %i.next = add nsw i64 %i, 1
+  br label %header
+
+exit:
+  ret void
+}
+
+define void @rows(i32* noalias %a, i8 %x, i64 %n) {
+entry:
+  br label %outer.header
+
+outer.header:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %outer.latch ]
+  %outer.cmp = icmp slt i64 %i, %n
+  br i1 %outer.cmp, label %outer.body, label %exit
+
+outer.body:
+  %x.low = and i8 %x, 15
+  %m = zext i8 %x.low to i64
+  %row = mul nsw i64 %i, 16
+  br label %inner.header
+
+inner.header:
+  %j = phi i64 [ 0, %outer.body ], [ %j.next, %inner.latch ]
+  %inner.cmp = icmp ult i64 %j, %m
+  br i1 %inner.cmp, label %inner.body, label %outer.latch
+
+inner.body:
+  %k = add nsw i64 %row, %j
+  %a.addr = getelementptr inbounds i32, i32* %a, i64 %k
+  store i32 0, i32* %a.addr, align 4
+  br label %inner.latch
+
+inner.latch:
+  %j.next = add nuw nsw i64 %j, 1
+  br label %inner.header
+
+outer.latch:
+  %i.next = add nsw i64 %i, 1
+  br label %outer.header
+
+exit:
+  ret void
+}
@@ -0,0 +1,75 @@
+; RUN: rm -rf %t
+; RUN: env LOOPBODYCLONER_CMDLINE_OPTIONS="-atrox-tile -atrox-tile-cache-size=32768 -atrox-export-results -atrox-reports-dir=%t" opt %loaddependees -load %bindir/%testeelib -basicaa -atrox-lbc-pass -S < %s | FileCheck %s
+; RUN: FileCheck -check-prefix=JSON %s < %t/lpc.transpose.extracted.0.json
+
+; the column walk of the inner loop reuses the lines of the previous outer
+; iteration, so the nest is tiled with a tile that fits in half of the cache,
+; and the tile bounds are computed from the remaining iterations so that they
+; do not wrap around
+
+; CHECK-LABEL: define {{.*}}@transpose_t.body(
+; CHECK: tile.header:
+; CHECK-NEXT: %tile.iv = phi i64
+; CHECK: %tile.rem = sub i64 [[END:%[a-z0-9.]+]], %tile.iv
+; CHECK: icmp ule i64 %tile.rem, 256
+; CHECK: %tile.last = or i1
+; CHECK: %tile.next = add i64 %tile.iv, 256
+; CHECK: %tile.end = select i1 %tile.last, i64 [[END]], i64 %tile.next
+; CHECK: tile.latch:
+; CHECK-NEXT: br i1 %tile.last,
+
+; JSON: "tiling": [
+; JSON-DAG: "loop": "inner.header"
+; JSON-DAG: "outer loop": "outer.header"
+; JSON-DAG: "tile size": 256
+; JSON-DAG: "footprint": 64
+; JSON-DAG: "cache size": 32768
+
+define void @transpose([1024 x float]* noalias %b, i64 %n, i64 %m, i64 %r) {
+entry:
+  br label %t.header
+
+t.header:
+  %t = phi i64 [ 0, %entry ], [ %t.next, %t.latch ]
+  %t.cmp = icmp slt i64 %t, %r
+  br i1 %t.cmp, label %t.body, label %exit
+
+t.body:
+  br label %outer.header
+
+outer.header:
+  %i = phi i64 [ 0, %t.body ], [ %i.next, %outer.latch ]
+  %outer.cmp = icmp slt i64 %i, %n
+  br i1 %outer.cmp, label %inner.preheader, label %outer.exit
+
+inner.preheader:
+  br label %inner.header
+
+inner.header:
+  %j = phi i64 [ 0, %inner.preheader ], [ %j.next, %inner.latch ]
+  %inner.cmp = icmp slt i64 %j, %m
+  br i1 %inner.cmp, label %inner.body, label %outer.latch
+
+inner.body:
+  %b.addr = getelementptr inbounds [1024 x float], [1024 x float]* %b, i64 %j, i64 %i
+  store float 0.0, float* %b.addr, align 4
+  br label %inner.latch
+
+inner.latch:
+  %j.next = add nsw i64 %j, 1
+  br label %inner.header
+
+outer.latch:
+  %i.next = add nsw i64 %i, 1
+  br label %outer.header
+
+outer.exit:
+  br label %t.latch
+
+t.latch:
+  %t.next = add nsw i64 %t, 1
+  br label %t.header
+
+exit:
+  ret void
+}
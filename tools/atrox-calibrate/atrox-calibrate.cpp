@@ -0,0 +1,392 @@
+//
+//
+//
+
+#include "Atrox/Config.hpp"
+
+#include "Atrox/Analysis/PayloadWeights.hpp"
+
+#include "llvm/Config/llvm-config.h"
+// using LLVM_VERSION_MAJOR
+
+#include "llvm/ExecutionEngine/Orc/LLJIT.h"
+// using llvm::orc::LLJIT
+// using llvm::orc::LLJITBuilder
+
+#include "llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
+// using llvm::orc::ThreadSafeModule
+
+#include "llvm/IR/LLVMContext.h"
+// using llvm::LLVMContext
+
+#include "llvm/IR/Module.h"
+// using llvm::Module
+
+#include "llvm/IR/Function.h"
+// using llvm::Function
+
+#include "llvm/IR/IRBuilder.h"
+// using llvm::IRBuilder
+
+#include "llvm/IR/Verifier.h"
+// using llvm::verifyModule
+
+#include "llvm/Support/CommandLine.h"
+// using llvm::cl::opt
+// using llvm::cl::desc
+// using llvm::cl::init
+// using llvm::cl::ParseCommandLineOptions
+
+#include "llvm/Support/Error.h"
+// using llvm::ExitOnError
+
+#include "llvm/Support/ErrorHandling.h"
+// using llvm_unreachable
+
+#include "llvm/Support/Format.h"
+// using llvm::format
+
+#include "llvm/Support/Host.h"
+// using llvm::sys::getHostCPUName
+// using llvm::sys::getProcessTriple
+
+#include "llvm/Support/InitLLVM.h"
+// using llvm::InitLLVM
+
+#include "llvm/Support/TargetSelect.h"
+// using llvm::InitializeNativeTarget
+// using llvm::InitializeNativeTargetAsmPrinter
+
+#include "llvm/Support/raw_ostream.h"
+// using llvm::outs
+// using llvm::errs
+
+#include <time.h>
+// using clock_gettime
+
+#include <algorithm>
+// using std::min
+// using std::max
+
+#include <cmath>
+// using std::lround
+
+#include <cstdint>
+// using uint64_t
+
+#include <iterator>
+// using std::next
+
+#include <limits>
+// using std::numeric_limits
+
+#include <memory>
+// using std::unique_ptr
+// using std::make_unique
+
+#include <string>
+// using std::string
+
+#include <vector>
+// using std::vector
+
+namespace {
+
+llvm::cl::opt<std::string>
+    OutputFilename("o", llvm::cl::init("atrox-weights.json"),
+                   llvm::cl::desc("weight table output file"),
+                   llvm::cl::value_desc("filename"));
+
+llvm::cl::opt<unsigned>
+    Iterations("iterations", llvm::cl::init(1u << 20),
+               llvm::cl::desc("loop iterations of each microkernel run"));
+
+llvm::cl::opt<unsigned>
+    Repetitions("repetitions", llvm::cl::init(7),
+                llvm::cl::desc("runs of each microkernel, of which the "
+                               "fastest is kept"));
+
+llvm::cl::opt<unsigned>
+    Unroll("unroll", llvm::cl::init(16),
+           llvm::cl::desc("measured operations in each loop iteration"));
+
+llvm::cl::opt<unsigned> CallArguments(
+    "call-arguments", llvm::cl::init(8),
+    llvm::cl::desc("arguments of the call used to measure argument "
+                   "marshalling, which should exceed the ones passed in "
+                   "registers"));
+
+llvm::ExitOnError ExitOnErr;
+
+// the volatile slots stay within the first level cache
+constexpr uint64_t BufferElements = 512;
+
+using KernelFnTy = void (*)(uint64_t, uint64_t *);
+
+// each kernel chains its operations through a value, so that they can be
+// neither removed nor overlapped by code generation
+enum class KernelKind {
+  Baseline,     // loop overhead
+  Instruction,  // add + xor
+  Cast,         // xor + trunc + sext
+  Memory,       // volatile load + add + volatile store
+  Call,         // call with 1 argument
+  CallArguments // call with CallArguments arguments
+};
+
+struct Kernel {
+  KernelKind Kind;
+  const char *Name;
+};
+
+const Kernel Kernels[] = {{KernelKind::Baseline, "atrox_kernel_baseline"},
+                          {KernelKind::Instruction, "atrox_kernel_inst"},
+                          {KernelKind::Cast, "atrox_kernel_cast"},
+                          {KernelKind::Memory, "atrox_kernel_memory"},
+                          {KernelKind::Call, "atrox_kernel_call"},
+                          {KernelKind::CallArguments, "atrox_kernel_args"}};
+
+llvm::Function *CreateCallee(llvm::Module &M, llvm::StringRef Name,
+                             unsigned NumArgs) {
+  auto *i64Ty = llvm::Type::getInt64Ty(M.getContext());
+  std::vector<llvm::Type *> params(NumArgs, i64Ty);
+
+  auto *callee = llvm::Function::Create(
+      llvm::FunctionType::get(i64Ty, params, false),
+      llvm::GlobalValue::ExternalLinkage, Name, &M);
+  callee->addFnAttr(llvm::Attribute::NoInline);
+
+  llvm::IRBuilder<> builder{
+      llvm::BasicBlock::Create(M.getContext(), "entry", callee)};
+  builder.CreateRet(&*callee->arg_begin());
+
+  return callee;
+}
+
+llvm::Value *EmitOperation(llvm::IRBuilder<> &Builder, KernelKind Kind,
+                           llvm::Value *X, llvm::Value *IV, llvm::Value *Slot,
+                           llvm::Function *Callee) {
+  auto *i64Ty = Builder.getInt64Ty();
+
+  switch (Kind) {
+  case KernelKind::Baseline:
+    return X;
+  case KernelKind::Instruction:
+    return Builder.CreateXor(Builder.CreateAdd(X, IV), IV);
+  case KernelKind::Cast:
+    return Builder.CreateSExt(
+        Builder.CreateTrunc(Builder.CreateXor(X, IV), Builder.getInt32Ty()),
+        i64Ty);
+  case KernelKind::Memory: {
+    auto *x = Builder.CreateAdd(X, Builder.CreateLoad(i64Ty, Slot, true));
+    Builder.CreateStore(x, Slot, true);
+
+    return x;
+  }
+  case KernelKind::Call:
+  case KernelKind::CallArguments: {
+    std::vector<llvm::Value *> args{X};
+    args.resize(Callee->arg_size(), IV);
+
+    return Builder.CreateCall(Callee, args);
+  }
+  }
+
+  llvm_unreachable("unknown kernel kind");
+}
+
+llvm::Function *CreateKernel(llvm::Module &M, const Kernel &K,
+                             llvm::Function *Callee) {
+  auto &ctx = M.getContext();
+  auto *i64Ty = llvm::Type::getInt64Ty(ctx);
+  auto *bufferTy = llvm::PointerType::getUnqual(i64Ty);
+
+  auto *kernel = llvm::Function::Create(
+      llvm::FunctionType::get(llvm::Type::getVoidTy(ctx), {i64Ty, bufferTy},
+                              false),
+      llvm::GlobalValue::ExternalLinkage, K.Name, &M);
+  auto *n = &*kernel->arg_begin();
+  auto *buffer = &*std::next(kernel->arg_begin());
+
+  auto *entry = llvm::BasicBlock::Create(ctx, "entry", kernel);
+  auto *loop = llvm::BasicBlock::Create(ctx, "loop", kernel);
+  auto *exit = llvm::BasicBlock::Create(ctx, "exit", kernel);
+
+  llvm::IRBuilder<> builder{entry};
+  builder.CreateBr(loop);
+
+  builder.SetInsertPoint(loop);
+  auto *iv = builder.CreatePHI(i64Ty, 2, "iv");
+  auto *x = builder.CreatePHI(i64Ty, 2, "x");
+  auto *slot = builder.CreateGEP(
+      i64Ty, buffer,
+      builder.CreateAnd(iv, llvm::ConstantInt::get(i64Ty, BufferElements - 1)));
+
+  llvm::Value *cur = x;
+  for (unsigned i = 0; i < Unroll; ++i) {
+    cur = EmitOperation(builder, K.Kind, cur, iv, slot, Callee);
+  }
+
+  auto *next = builder.CreateNUWAdd(iv, llvm::ConstantInt::get(i64Ty, 1));
+  builder.CreateCondBr(builder.CreateICmpULT(next, n), loop, exit);
+
+  iv->addIncoming(llvm::ConstantInt::get(i64Ty, 0), entry);
+  iv->addIncoming(next, loop);
+  x->addIncoming(n, entry);
+  x->addIncoming(cur, loop);
+
+  // keep the result of the chain alive
+  builder.SetInsertPoint(exit);
+  builder.CreateStore(cur, buffer, true);
+  builder.CreateRetVoid();
+
+  return kernel;
+}
+
+double GetTime() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// nanoseconds per loop iteration of the fastest run
+double TimeKernel(KernelFnTy Fn, uint64_t *Buffer) {
+  double best = std::numeric_limits<double>::max();
+
+  // warm up caches and branch predictors
+  Fn(Iterations, Buffer);
+
+  for (unsigned i = 0; i < Repetitions; ++i) {
+    auto start = GetTime();
+    Fn(Iterations, Buffer);
+    best = std::min(best, GetTime() - start);
+  }
+
+  return best / Iterations;
+}
+
+KernelFnTy LookupKernel(llvm::orc::LLJIT &JIT, llvm::StringRef Name) {
+  auto sym = ExitOnErr(JIT.lookup(Name));
+
+#if LLVM_VERSION_MAJOR >= 15
+  return sym.toPtr<KernelFnTy>();
+#else
+  return reinterpret_cast<KernelFnTy>(sym.getAddress());
+#endif
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  llvm::InitLLVM X(argc, argv);
+  llvm::cl::ParseCommandLineOptions(
+      argc, argv,
+      "measures the payload weight table of atrox on the host, which the "
+      "pass reads with -atrox-payload-weights-file\n");
+
+  ExitOnErr.setBanner(std::string(argv[0]) + ": ");
+
+  if (!Iterations || !Repetitions || !Unroll || CallArguments < 2) {
+    llvm::errs() << argv[0]
+                 << ": iterations, repetitions and unroll must be positive "
+                    "and call arguments at least 2\n";
+    return 1;
+  }
+
+  llvm::InitializeNativeTarget();
+  llvm::InitializeNativeTargetAsmPrinter();
+
+  auto jit = ExitOnErr(llvm::orc::LLJITBuilder().create());
+
+  auto ctx = std::make_unique<llvm::LLVMContext>();
+  auto module = std::make_unique<llvm::Module>("atrox-calibrate", *ctx);
+  module->setDataLayout(jit->getDataLayout());
+  module->setTargetTriple(llvm::sys::getProcessTriple());
+
+  auto *callee = CreateCallee(*module, "atrox_callee", 1);
+  auto *calleeArgs =
+      CreateCallee(*module, "atrox_callee_args", CallArguments);
+
+  for (const auto &e : Kernels) {
+    CreateKernel(*module, e,
+                 e.Kind == KernelKind::CallArguments ? calleeArgs : callee);
+  }
+
+  if (llvm::verifyModule(*module, &llvm::errs())) {
+    llvm::errs() << argv[0] << ": invalid microkernel module\n";
+    return 1;
+  }
+
+  ExitOnErr(jit->addIRModule(
+      llvm::orc::ThreadSafeModule(std::move(module), std::move(ctx))));
+
+  std::vector<uint64_t> buffer(BufferElements, 0);
+  double times[sizeof(Kernels) / sizeof(Kernels[0])];
+
+  for (unsigned i = 0; i < sizeof(Kernels) / sizeof(Kernels[0]); ++i) {
+    times[i] =
+        TimeKernel(LookupKernel(*jit, Kernels[i].Name), buffer.data()) / Unroll;
+  }
+
+  auto getTime = [&](KernelKind Kind) {
+    return std::max(times[static_cast<unsigned>(Kind)] -
+                        times[static_cast<unsigned>(KernelKind::Baseline)],
+                    0.0);
+  };
+
+  // nanoseconds per operation, subtracting the instructions that chain them
+  double inst = getTime(KernelKind::Instruction) / 2;
+  double cast = std::max(getTime(KernelKind::Cast) - inst, 0.0) / 2;
+  double memory = std::max(getTime(KernelKind::Memory) - inst, 0.0) / 2;
+  double arg = std::max(getTime(KernelKind::CallArguments) -
+                            getTime(KernelKind::Call),
+                        0.0) /
+               (CallArguments - 1);
+  double call = std::max(getTime(KernelKind::Call) - arg, 0.0);
+
+  if (inst <= 0) {
+    llvm::errs() << argv[0]
+                 << ": could not measure the instruction weight; try more "
+                    "iterations\n";
+    return 1;
+  }
+
+  // keep the instruction weight of the built-in table, so that the options
+  // expressed in weight units retain their meaning; debug intrinsics do not
+  // generate code and keep their weight too
+  atrox::PayloadWeightTable table;
+  double unit = inst / table.Instruction;
+
+  auto toWeight = [unit](double Time) {
+    return static_cast<atrox::PayloadWeightTy>(
+        std::max(std::lround(Time / unit), 1l));
+  };
+
+  table.Cast = toWeight(cast);
+  table.Memory = toWeight(memory);
+  table.Call = toWeight(call);
+  table.CallArgument = toWeight(arg);
+
+  llvm::outs() << "host: " << llvm::sys::getProcessTriple() << " ("
+               << llvm::sys::getHostCPUName() << ")\n";
+
+  auto print = [](const char *Name, double Time,
+                  atrox::PayloadWeightTy Weight) {
+    llvm::outs() << llvm::format("%-16s %8.3f ns %6u\n", Name, Time, Weight);
+  };
+
+  print("instruction", inst, table.Instruction);
+  print("cast", cast, table.Cast);
+  print("memory", memory, table.Memory);
+  print("call", call, table.Call);
+  print("call argument", arg, table.CallArgument);
+
+  if (!atrox::WritePayloadWeightTable(OutputFilename, table)) {
+    llvm::errs() << argv[0] << ": error writing file '" << OutputFilename
+                 << "'\n";
+    return 1;
+  }
+
+  return 0;
+}
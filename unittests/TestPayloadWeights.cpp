@@ -0,0 +1,133 @@
+//
+//
+//
+
+#include "Atrox/Analysis/PayloadWeights.hpp"
+
+#include "llvm/ADT/SmallString.h"
+// using llvm::SmallString
+
+#include "llvm/ADT/StringRef.h"
+// using llvm::StringRef
+
+#include "llvm/Support/FileSystem.h"
+// using llvm::sys::fs::createTemporaryFile
+// using llvm::sys::fs::remove
+
+#include "llvm/Support/raw_ostream.h"
+// using llvm::raw_fd_ostream
+
+#include "gtest/gtest.h"
+// using testing::Test
+
+namespace atrox {
+namespace testing {
+namespace {
+
+class PayloadWeightTableTest : public ::testing::Test {
+protected:
+  llvm::SmallString<128> Path;
+
+  void SetUp() override {
+    ASSERT_FALSE(
+        llvm::sys::fs::createTemporaryFile("atrox-weights", "json", Path));
+  }
+
+  void TearDown() override { llvm::sys::fs::remove(Path); }
+
+  void writeFile(llvm::StringRef Contents) {
+    std::error_code ec;
+    llvm::raw_fd_ostream os(Path, ec);
+
+    ASSERT_FALSE(ec);
+    os << Contents;
+  }
+};
+
+PayloadWeightTable GetCustomTable() {
+  PayloadWeightTable table;
+
+  table.Cast = 3;
+  table.DebugIntrinsic = 0;
+  table.Instruction = 5;
+  table.Memory = 70;
+  table.Call = 110;
+  table.CallArgument = 9;
+
+  return table;
+}
+
+void ExpectEqualTables(const PayloadWeightTable &Expected,
+                       const PayloadWeightTable &Actual) {
+  EXPECT_EQ(Expected.Cast, Actual.Cast);
+  EXPECT_EQ(Expected.DebugIntrinsic, Actual.DebugIntrinsic);
+  EXPECT_EQ(Expected.Instruction, Actual.Instruction);
+  EXPECT_EQ(Expected.Memory, Actual.Memory);
+  EXPECT_EQ(Expected.Call, Actual.Call);
+  EXPECT_EQ(Expected.CallArgument, Actual.CallArgument);
+}
+
+//
+
+TEST_F(PayloadWeightTableTest, WrittenTableIsReadBack) {
+  auto written = GetCustomTable();
+  PayloadWeightTable read;
+
+  ASSERT_TRUE(WritePayloadWeightTable(Path, written));
+  ASSERT_TRUE(ReadPayloadWeightTable(Path, read));
+
+  ExpectEqualTables(written, read);
+}
+
+TEST_F(PayloadWeightTableTest, MissingCategoriesKeepTheirWeights) {
+  writeFile(R"({ "memory": 42, "call argument": 4 })");
+
+  auto expected = GetCustomTable();
+  expected.Memory = 42;
+  expected.CallArgument = 4;
+
+  auto read = GetCustomTable();
+  ASSERT_TRUE(ReadPayloadWeightTable(Path, read));
+
+  ExpectEqualTables(expected, read);
+}
+
+TEST_F(PayloadWeightTableTest, OutOfRangeWeightLeavesTableUnchanged) {
+  writeFile(R"({ "memory": 42, "call": -1 })");
+
+  auto read = GetCustomTable();
+  EXPECT_FALSE(ReadPayloadWeightTable(Path, read));
+
+  ExpectEqualTables(GetCustomTable(), read);
+}
+
+TEST_F(PayloadWeightTableTest, MalformedTableIsRejected) {
+  writeFile(R"({ "memory": )");
+
+  auto read = GetCustomTable();
+  EXPECT_FALSE(ReadPayloadWeightTable(Path, read));
+
+  ExpectEqualTables(GetCustomTable(), read);
+}
+
+TEST_F(PayloadWeightTableTest, NonObjectTableIsRejected) {
+  writeFile(R"([ 1, 2, 3 ])");
+
+  auto read = GetCustomTable();
+  EXPECT_FALSE(ReadPayloadWeightTable(Path, read));
+
+  ExpectEqualTables(GetCustomTable(), read);
+}
+
+TEST_F(PayloadWeightTableTest, MissingFileIsRejected) {
+  llvm::sys::fs::remove(Path);
+
+  auto read = GetCustomTable();
+  EXPECT_FALSE(ReadPayloadWeightTable(Path, read));
+
+  ExpectEqualTables(GetCustomTable(), read);
+}
+
+} // unnamed namespace
+} // namespace testing
+} // namespace atrox